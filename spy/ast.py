@@ -11,6 +11,7 @@ from spy.util import extend
 
 AnyNode = typing.Union[py_ast.AST, 'Node']
 VarKind = typing.Literal['const', 'var']
+Schedule = typing.Literal['static', 'dynamic', 'guided']
 
 @extend(py_ast.AST)
 class AST:
@@ -55,9 +56,13 @@ del AST
 # put them in dictionaries inside the typechecker. So, we must use eq=False ON
 # ALL AST NODES.
 #
+# Moreover, we use slots=True to make nodes more compact: big modules have
+# millions of them. Non-dataclass subclasses (e.g. Decl) must declare
+# __slots__ = () explicitly, else they get a __dict__ again.
+#
 # Ideally, I would like to do the following:
 #     def astnode():
-#         return dataclass (eq=False)
+#         return dataclass(eq=False, slots=True)
 #
 #     @astnode
 #     class Node:
@@ -65,7 +70,7 @@ del AST
 #
 # But we can't because this pattern is not understood by mypy.
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Node:
 
     def pp(self, hl: Any=None) -> None:
@@ -121,7 +126,7 @@ class Node:
             for node in self.get_children():
                 node.visit(prefix, visitor, *args)
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Module(Node):
     filename: str
     decls: list['Decl']
@@ -137,16 +142,16 @@ class Module(Node):
 
 
 class Decl(Node):
-    pass
+    __slots__ = ()
 
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class GlobalFuncDef(Decl):
     loc: Loc = field(repr=False)
     funcdef: 'FuncDef'
 
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class GlobalVarDef(Decl):
     vardef: 'VarDef'
     assign: 'Assign'
@@ -156,7 +161,7 @@ class GlobalVarDef(Decl):
         return self.vardef.loc
 
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Import(Decl):
     loc: Loc = field(repr=False)
     loc_asname: Loc
@@ -165,7 +170,7 @@ class Import(Decl):
 
 # ====== Expr hierarchy ======
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Expr(Node):
     """
     Operator precedence table, see
@@ -199,38 +204,52 @@ class Expr(Node):
     def is_const(self) -> bool:
         return isinstance(self, Constant)
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Name(Expr):
     precedence = 100 # the highest
     id: str
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Auto(Expr):
     precedence = 100 # the highest
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Constant(Expr):
     precedence = 100 # the highest
     value: object
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class GetItem(Expr):
     precedence = 16
     value: Expr
     index: Expr
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
+class GetSlice(Expr):
+    """
+    value[start:stop]. The parser turns missing bounds into the constants
+    0 and END: since indexes are clamped to the length, value[start:END]
+    is the same as value[start:].
+    """
+    precedence = 16
+    value: Expr
+    start: Expr
+    stop: Expr
+
+    END = 2**31 - 1
+
+@dataclass(eq=False, slots=True)
 class List(Expr):
     precedence = 17
     items: list[Expr]
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Call(Expr):
     precedence = 16
     func: Expr
     args: list[Expr]
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class GetAttr(Expr):
     precedence = 16
     value: Expr
@@ -238,123 +257,123 @@ class GetAttr(Expr):
 
 # ====== BinOp sub-hierarchy ======
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class BinOp(Expr):
     op = ''
     left: Expr
     right: Expr
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Eq(BinOp):
     precedence = 6
     op = '=='
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class NotEq(BinOp):
     precedence = 6
     op = '!='
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Lt(BinOp):
     precedence = 6
     op = '<'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class LtE(BinOp):
     precedence = 6
     op = '<='
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Gt(BinOp):
     precedence = 6
     op = '>'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class GtE(BinOp):
     precedence = 6
     op = '>='
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Is(BinOp):
     precedence = 6
     op = 'is'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class IsNot(BinOp):
     precedence = 6
     op = 'is not'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class In(BinOp):
     precedence = 6
     op = 'in'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class NotIn(BinOp):
     precedence = 6
     op = 'not in'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Add(BinOp):
     precedence = 11
     op = '+'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Sub(BinOp):
     precedence = 11
     op = '-'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Mul(BinOp):
     precedence = 12
     op = '*'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Div(BinOp):
     precedence = 12
     op = '/'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class FloorDiv(BinOp):
     precedence = 12
     op = '//'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Mod(BinOp):
     precedence = 12
     op = '%'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Pow(BinOp):
     precedence = 14
     op = '**'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class LShift(BinOp):
     precedence = 10
     op = '<<'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class RShift(BinOp):
     precedence = 10
     op = '>>'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class BitXor(BinOp):
     precedence = 8
     op = '^'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class BitOr(BinOp):
     precedence = 7
     op = '|'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class BitAnd(BinOp):
     precedence = 9
     op = '&'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class MatMul(BinOp):
     precedence = 12
     op = '@'
@@ -362,27 +381,27 @@ class MatMul(BinOp):
 
 # ====== UnaryOp sub-hierarchy ======
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class UnaryOp(Expr):
     op = ''
     value: Expr
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class UnaryPos(UnaryOp):
     precedence = 13
     op = '+'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class UnaryNeg(UnaryOp):
     precedence = 13
     op = '-'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Invert(UnaryOp):
     precedence = 13
     op = '~'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Not(UnaryOp):
     precedence = 5
     op = 'not'
@@ -390,17 +409,17 @@ class Not(UnaryOp):
 
 # ====== Stmt hierarchy ======
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Stmt(Node):
     loc: Loc = field(repr=False)
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class FuncArg(Node):
     loc: Loc = field(repr=False)
     name: str
     type: 'Expr'
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class FuncDef(Stmt):
     loc: Loc = field(repr=False)
     color: Color
@@ -418,48 +437,48 @@ class FuncDef(Stmt):
         """
         return Loc.combine(self.loc, self.return_type.loc)
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Pass(Stmt):
     pass
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Return(Stmt):
     value: Expr
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class VarDef(Stmt):
     kind: VarKind
     name: str
     type: Expr
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class StmtExpr(Stmt):
     """
     An expr used as a statement
     """
     value: Expr
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class Assign(Stmt):
     target_loc: Loc = field(repr=False)
     target: str
     value: Expr
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class SetAttr(Stmt):
     target_loc: Loc = field(repr=False)
     target: Expr
     attr: str
     value: Expr
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class SetItem(Stmt):
     target_loc: Loc = field(repr=False)
     target: Expr
     index: Expr
     value: Expr
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class If(Stmt):
     test: Expr
     then_body: list[Stmt]
@@ -469,11 +488,34 @@ class If(Stmt):
     def has_else(self) -> bool:
         return len(self.else_body) > 0
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class While(Stmt):
     test: Expr
     body: list[Stmt]
 
+@dataclass(eq=False, slots=True)
+class ParallelFor(Stmt):
+    """
+    for TARGET in parallel_range(N, SCHEDULE):
+        BODY
+
+    The iterations can be executed in any order and concurrently. The
+    following fields are computed by ScopeAnalyzer.check_ParallelFor:
+
+      - privates: the local vars which are assigned inside the body and are
+        private to each iteration
+
+      - reductions: the local vars which are updated by `x = x + ...` or
+        `x = x * ...`, mapped to the operator
+    """
+    target_loc: Loc = field(repr=False)
+    target: str
+    n: Expr
+    schedule: Schedule
+    body: list[Stmt]
+    privates: list[str] = field(repr=False, default_factory=list)
+    reductions: dict[str, str] = field(repr=False, default_factory=dict)
+
 
 # ====== Doppler-specific nodes ======
 #
@@ -482,7 +524,7 @@ class While(Stmt):
 # the proper AST-which-represent-the-syntax-of-the-language, but they are part
 # of the AST-which-we-use-as-IR
 
-@dataclass(eq=False)
+@dataclass(eq=False, slots=True)
 class FQNConst(Expr):
     precedence = 100 # the highest
     fqn: FQN
@@ -65,7 +65,10 @@ class Dumper(TextBuilder):
         def is_complex(obj: Any) -> bool:
             return (isinstance(obj, (spy.ast.Node, py_ast.AST, list)) and
                     not isinstance(obj, py_ast.expr_context))
-        values = [getattr(node, field) for field in fields]
+        # is_var is set only on some ast.Name, see magic_py_parse
+        values = [getattr(node, field, False) if field == 'is_var'
+                  else getattr(node, field)
+                  for field in fields]
         is_complex_field = [is_complex(value) for value in values]
         multiline = any(is_complex_field)
         #
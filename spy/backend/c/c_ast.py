@@ -33,6 +33,7 @@ PREC  CATEGORY         OPERATOR            ASSOCIATIVITY
 """
 
 import re
+import string
 from dataclasses import dataclass
 from typing import ClassVar
 
@@ -96,7 +97,15 @@ class Literal(Expr):
                 return ch
             return rf'\x{val:02x}' # :x is "hex format"
 
-        lit = ''.join([char_repr(val) for val in b])
+        parts = []
+        for i, val in enumerate(b):
+            parts.append(char_repr(val))
+            # a \x escape consumes all the hex digits which follow: e.g.
+            # "\x01a" is a single char, so we need to split the literal
+            if (i + 1 < len(b) and parts[-1].startswith(r'\x') and
+                chr(b[i+1]) in string.hexdigits):
+                parts.append('" "')
+        lit = ''.join(parts)
         return Literal(f'"{lit}"')
 
 
@@ -179,6 +188,20 @@ class UnaryOp(Expr):
             v = f'({v})'
         return f'{self.op}{v}'
 
+@dataclass
+class Cast(Expr):
+    c_type: str
+    value: Expr
+
+    def precedence(self) -> int:
+        return 13
+
+    def __str__(self) -> str:
+        v = str(self.value)
+        if self.value.precedence() < self.precedence():
+            v = f'({v})'
+        return f'({self.c_type}){v}'
+
 @dataclass
 class Call(Expr):
     func: str
@@ -4,7 +4,10 @@ from spy.vm.b import B
 from spy.vm.object import W_Type
 from spy.vm.function import W_FuncType
 from spy.vm.modules.rawbuffer import RB
+from spy.vm.modules.atomic import ATOMIC
+from spy.vm.modules.io import IO
 from spy.vm.modules.types import W_TypeDef
+from spy.vm.task import W_BaseTask
 
 @dataclass
 class C_Type:
@@ -59,15 +62,35 @@ class Context:
         self._d[B.w_void] = C_Type('void')
         self._d[B.w_i32] = C_Type('int32_t')
         self._d[B.w_f64] = C_Type('double')
+        self._d[B.w_i8] = C_Type('int8_t')
+        self._d[B.w_u8] = C_Type('uint8_t')
+        self._d[B.w_i16] = C_Type('int16_t')
+        self._d[B.w_u16] = C_Type('uint16_t')
+        self._d[B.w_u32] = C_Type('uint32_t')
+        self._d[B.w_i64] = C_Type('int64_t')
+        self._d[B.w_u64] = C_Type('uint64_t')
+        self._d[B.w_f32] = C_Type('float')
         self._d[B.w_bool] = C_Type('bool')
         self._d[B.w_str] = C_Type('spy_Str *')
+        self._d[B.w_StrSplit] = C_Type('spy_StrSplit *')
+        self._d[B.w_f64x2] = C_Type('spy_f64x2')
+        self._d[B.w_f32x4] = C_Type('spy_f32x4')
+        self._d[B.w_i32x4] = C_Type('spy_i32x4')
         self._d[RB.w_RawBuffer] = C_Type('spy_RawBuffer *')
+        self._d[ATOMIC.w_AtomicI32] = C_Type('spy_AtomicI32 *')
+        self._d[ATOMIC.w_ChannelI32] = C_Type('spy_Channel *')
+        self._d[ATOMIC.w_ChannelF64] = C_Type('spy_Channel *')
+        self._d[IO.w_Reader] = C_Type('spy_Reader *')
+        self._d[IO.w_Writer] = C_Type('spy_Writer *')
+        self._d[IO.w_ReadBatch] = C_Type('spy_ReadBatch *')
 
     def w2c(self, w_type: W_Type) -> C_Type:
         if isinstance(w_type, W_TypeDef):
             w_type = w_type.w_origintype
         if w_type in self._d:
             return self._d[w_type]
+        if issubclass(w_type.pyclass, W_BaseTask):
+            return C_Type('spy_Task *')
         raise NotImplementedError(f'Cannot translate type {w_type} to C')
 
     def c_function(self, name: str, w_functype: W_FuncType) -> C_Function:
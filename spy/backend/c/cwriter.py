@@ -7,13 +7,17 @@ from spy.fqn import FQN
 from spy.location import Loc
 from spy.vm.object import W_Type, W_Object
 from spy.vm.module import W_Module
-from spy.vm.function import W_ASTFunc, W_BuiltinFunc, W_FuncType
+from spy.vm.function import W_ASTFunc, W_BuiltinFunc, W_FuncType, W_Func
 from spy.vm.vm import SPyVM
 from spy.vm.b import B
 from spy.vm.modules.types import TYPES
+from spy.vm.modules.rawbuffer import RB, W_RawBuffer
+from spy.vm.modules.operator.opimpl_numeric import (SIZED_INTS, ALL_NUMERIC,
+                                                    ARITH_OPS, TOKENS)
 from spy.textbuilder import TextBuilder
 from spy.backend.c.context import Context, C_Type, C_Function
 from spy.backend.c import c_ast as C
+from spy.irgen.scope import walk_stmts, names_in_stmts
 from spy.util import shortrepr, magic_dispatch
 
 class CModuleWriter:
@@ -21,9 +25,14 @@ class CModuleWriter:
     w_mod: W_Module
     spyfile: py.path.local
     cfile: py.path.local
-    out: TextBuilder          # main builder
-    out_globals: TextBuilder  # nested builder for global declarations
+    hfile: py.path.local      # global declarations, #included by cfile
+    out: TextBuilder          # main builder, streams to cfile
+    out_globals: TextBuilder  # global declarations, streams to hfile
     global_vars: set[str]
+    str_literals: dict[str, str]  # see CFuncWriter._fmt_str_literal
+    task_trampolines: set[FQN]   # see CFuncWriter.emit_task_trampolines
+    join_helpers: set[FQN]       # see CFuncWriter.fmt_join
+    readonly_rawbuffers: set[FQN]  # see find_readonly_rawbuffers
 
     def __init__(self, vm: SPyVM, w_mod: W_Module,
                  spyfile: py.path.local,
@@ -32,13 +41,32 @@ class CModuleWriter:
         self.w_mod = w_mod
         self.spyfile = spyfile
         self.cfile = cfile
-        self.out = TextBuilder(use_colors=False)
+        self.hfile = cfile.new(basename=f'{cfile.purebasename}_globals.h')
+        self.out = None          # type: ignore
         self.out_globals = None  # type: ignore
         self.global_vars = set()
+        self.str_literals = {}
+        self.task_trampolines = set()
+        self.join_helpers = set()
+        self.readonly_rawbuffers = set()
 
     def write_c_source(self) -> None:
-        c_src = self.emit_module()
-        self.cfile.write(c_src)
+        """
+        Write the module to cfile and hfile.
+
+        The C code is streamed to the files as it is generated, so we never
+        keep the whole source in memory. The global declarations (function
+        prototypes, string literals, etc.) are discovered while emitting the
+        functions, so they go to a separate header which cfile #includes at
+        the top: this way, the C line numbers of cfile are known while we
+        emit it, and #line directives are correct.
+        """
+        with self.cfile.open('w') as fc, self.hfile.open('w') as fh:
+            self.out = TextBuilder(stream=fc)
+            self.out_globals = TextBuilder(stream=fh)
+            self.emit_module()
+            self.out.flush()
+            self.out_globals.flush()
 
     def new_global_var(self, prefix: str) -> str:
         """
@@ -52,7 +80,7 @@ class CModuleWriter:
         self.global_vars.add(varname)
         return varname
 
-    def emit_module(self) -> str:
+    def emit_module(self) -> None:
         self.out.wb(f"""
         #include <spy.h>
 
@@ -63,12 +91,15 @@ class CModuleWriter:
         #endif
 
         // global declarations and definitions
+        #include "{self.hfile.basename}"
         """)
-        self.out_globals = self.out.make_nested_builder()
+        self.out_globals.wl(f'// global declarations and definitions of '
+                            f'{self.cfile.basename}')
         self.out.wl()
         self.out.wb("""
         // content of the module
         """)
+        self.readonly_rawbuffers = self.find_readonly_rawbuffers()
         for fqn, w_obj in self.w_mod.items_w():
             assert w_obj is not None, 'uninitialized global?'
             # XXX we should mangle the name somehow
@@ -88,7 +119,6 @@ class CModuleWriter:
                     return 0;
                 }}
             """)
-        return self.out.build()
 
     def declare_function(self, fqn: FQN, w_func: W_ASTFunc) -> None:
         c_func = self.ctx.c_function(fqn.c_name, w_func.w_functype)
@@ -104,14 +134,84 @@ class CModuleWriter:
             intval = self.ctx.vm.unwrap(w_obj)
             c_type = self.ctx.w2c(w_type)
             self.out_globals.wl(f'{c_type} {fqn.c_name} = {intval};')
-        elif w_type is TYPES.w_TypeDef:
-            # XXX: for now, we just ignore global TypeDefs, since they are not
-            # needed. But in general, we need a way to emit prebuilt
-            # constants.
+        elif w_type is B.w_str:
+            utf8 = self.ctx.vm.unwrap_str(w_obj).encode('utf-8')
+            lit = C.Literal.from_bytes(utf8)
+            init = '{%d, %s, NULL, SPY_STR_VALID_UTF8}' % (len(utf8), lit)
+            self.out_globals.wb(f"""
+            static spy_Str {fqn.c_name}$data = {init};
+            spy_Str *{fqn.c_name} = &{fqn.c_name}$data;
+            """)
+        elif w_type is RB.w_RawBuffer:
+            self.declare_rawbuffer(fqn, w_obj)
+        elif w_type in (TYPES.w_TypeDef, B.w_type):
+            # XXX: for now, we just ignore global types and TypeDefs, since
+            # they are not needed at runtime
             pass
         else:
             raise NotImplementedError('WIP')
 
+    def find_readonly_rawbuffers(self) -> set[FQN]:
+        """
+        Find the RawBuffers made by the doppler (e.g. `test::prebuilt#0`)
+        which red code never writes, i.e. which are used only as the first
+        argument of rb_get_*. They are private to the module, so it is
+        enough to look at its functions.
+        """
+        prebuilt: set[FQN] = set()
+        funcs: list[W_ASTFunc] = []
+        for fqn, w_obj in self.w_mod.items_w():
+            if isinstance(w_obj, W_RawBuffer) and fqn.suffix != '':
+                prebuilt.add(fqn)
+            elif isinstance(w_obj, W_ASTFunc) and w_obj.color == 'red':
+                funcs.append(w_obj)
+        reads: set[int] = set()  # the ids of the FQNConst which are read
+        escaped: set[FQN] = set()
+        for w_func in funcs:
+            # walk() is pre-order, so we see a Call before its arguments
+            for node in w_func.funcdef.walk():
+                if (isinstance(node, ast.Call) and
+                    isinstance(node.func, ast.FQNConst) and
+                    node.func.fqn.modname == 'rawbuffer' and
+                    node.func.fqn.attr.startswith('rb_get_') and
+                    isinstance(node.args[0], ast.FQNConst)):
+                    reads.add(id(node.args[0]))
+                elif isinstance(node, ast.FQNConst) and id(node) not in reads:
+                    escaped.add(node.fqn)
+        return prebuilt - escaped
+
+    def declare_rawbuffer(self, fqn: FQN, w_rb: W_RawBuffer) -> None:
+        """
+        Emit a prebuilt RawBuffer, e.g. a lookup table computed at blue time:
+
+            static const struct { size_t length; unsigned char buf[4]; }
+                spy_test$TABLE$data = {4, {1, 2, 3, 4}};
+            spy_RawBuffer *spy_test$TABLE = (spy_RawBuffer *)&...$data;
+
+        The struct has the same layout as spy_RawBuffer, but a sized array:
+        static initializers for flexible array members are a GNU extension.
+
+        The data is const only if red code never writes it (see
+        find_readonly_rawbuffers), so that lookup tables go to the read-only
+        section of the binary. The FQNs assigned by the doppler are never
+        reassigned, so their pointer is const too and the C compiler can see
+        through it.
+        """
+        data = bytes(w_rb.buf)
+        items = ', '.join(str(b) for b in data) or '0'
+        v = f'{fqn.c_name}$data'
+        const = 'const ' if fqn in self.readonly_rawbuffers else ''
+        size = max(len(data), 1)
+        if fqn.suffix == '':
+            ptr = f'spy_RawBuffer *{fqn.c_name}'
+        else:
+            ptr = f'static spy_RawBuffer *const {fqn.c_name}'
+        self.out_globals.wb(f"""
+        static {const}struct {{ size_t length; unsigned char buf[{size}]; }}
+            {v} = {{{len(data)}, {{{items}}}}};
+        {ptr} = (spy_RawBuffer *)&{v};
+        """)
+
 
 class CFuncWriter:
     ctx: Context
@@ -120,6 +220,7 @@ class CFuncWriter:
     fqn: FQN
     w_func: W_ASTFunc
     last_emitted_linenos: tuple[int, int]
+    parfor_names: dict[ast.ParallelFor, str]
 
     def __init__(self,
                  ctx: Context,
@@ -132,12 +233,15 @@ class CFuncWriter:
         self.fqn = fqn
         self.w_func = w_func
         self.last_emitted_linenos = (-1, -1) # see emit_lineno_maybe
+        self.parfor_names = {}
 
     def ppc(self) -> None:
         """
         Pretty print the C code generated so far
         """
-        print(self.out.build())
+        assert self.out.stream is not None
+        self.out.stream.flush()
+        print(self.cmod.cfile.read())
 
     def ppast(self) -> None:
         """
@@ -149,6 +253,8 @@ class CFuncWriter:
         """
         Emit the code for the whole function
         """
+        self.emit_parfor_functions()
+        self.emit_task_trampolines()
         self.emit_lineno(self.w_func.funcdef.loc.line_start)
         c_func = self.ctx.c_function(self.fqn.c_name,
                                      self.w_func.w_functype)
@@ -177,6 +283,10 @@ class CFuncWriter:
         """
         assert self.w_func.locals_types_w is not None
         param_names = [p.name for p in self.w_func.w_functype.params]
+        # the vars which are private to parallel loops are declared by the
+        # outlined functions
+        for parfor in self.parfor_names:
+            param_names += [parfor.target] + parfor.privates
         for varname, w_type in self.w_func.locals_types_w.items():
             c_type = self.ctx.w2c(w_type)
             if varname != '@return' and varname not in param_names:
@@ -184,6 +294,166 @@ class CFuncWriter:
 
     # ==============
 
+    def emit_parfor_functions(self) -> None:
+        """
+        Outline the body of each ParallelFor into its own function, which is
+        passed to spy_parallel_for. E.g.:
+
+            for i in parallel_range(n):
+                acc = acc + f(i, x)
+
+        becomes:
+
+            struct spy_test$foo$parfor0_env { int32_t x; int32_t acc; };
+            static void spy_test$foo$parfor0(void *SPY_env,
+                                             int32_t SPY_start,
+                                             int32_t SPY_end) {
+                struct spy_test$foo$parfor0_env *SPY_e = SPY_env;
+                int32_t x = SPY_e->x;  // captured vars, by value
+                int32_t acc = 0;       // partial result of the reduction
+                int32_t i;
+                for (i = SPY_start; i < SPY_end; i++) {
+                    acc = acc + spy_test$f(i, x);
+                }
+                spy_parallel_reduce_lock();
+                SPY_e->acc = SPY_e->acc + acc;
+                spy_parallel_reduce_unlock();
+            }
+
+        Nested loops are outlined before the loops which contain them.
+        """
+        parfors = list(walk_stmts(self.w_func.funcdef.body, ast.ParallelFor))
+        for i, parfor in enumerate(parfors):
+            self.parfor_names[parfor] = f'{self.fqn.c_name}$parfor{i}'
+        for parfor in reversed(parfors):
+            self.emit_parfor_function(parfor)
+
+    def parfor_captured(self, parfor: ast.ParallelFor) -> list[str]:
+        """
+        The local vars which are read by the body of the loop, and which are
+        copied into the outlined function
+        """
+        symtable = self.w_func.funcdef.symtable
+        res = []
+        for name in names_in_stmts(parfor.body):
+            sym = symtable.lookup_maybe(name)
+            if (sym is not None and sym.is_local and
+                name != parfor.target and
+                name not in parfor.privates and
+                name not in parfor.reductions):
+                res.append(name)
+        return res
+
+    def emit_parfor_function(self, parfor: ast.ParallelFor) -> None:
+        name = self.parfor_names[parfor]
+        captured = self.parfor_captured(parfor)
+        locals_types_w = self.w_func.locals_types_w
+        assert locals_types_w is not None
+        def c_type(varname: str) -> C_Type:
+            return self.ctx.w2c(locals_types_w[varname])
+        #
+        env_vars = captured + list(parfor.reductions)
+        self.out.wl(f'struct {name}_env {{')
+        with self.out.indent():
+            for varname in env_vars:
+                self.out.wl(f'{c_type(varname)} {varname};')
+            if not env_vars:
+                # empty structs are not allowed in C99
+                self.out.wl('char SPY_unused;')
+        self.out.wl('};')
+        self.emit_lineno(parfor.loc.line_start)
+        self.out.wl(f'static void {name}(void *SPY_env, int32_t SPY_start, '
+                    f'int32_t SPY_end) {{')
+        with self.out.indent():
+            self.out.wl(f'struct {name}_env *SPY_e = SPY_env;')
+            for varname in captured:
+                self.out.wl(f'{c_type(varname)} {varname} = SPY_e->{varname};')
+            for varname in parfor.privates:
+                self.out.wl(f'{c_type(varname)} {varname};')
+            for varname, op in parfor.reductions.items():
+                identity = '0' if op == '+' else '1'
+                self.out.wl(f'{c_type(varname)} {varname} = {identity};')
+            t = parfor.target
+            self.out.wl(f'int32_t {t};')
+            self.out.wl(f'for ({t} = SPY_start; {t} < SPY_end; {t}++) {{')
+            with self.out.indent():
+                for stmt in parfor.body:
+                    self.emit_stmt(stmt)
+            self.out.wl('}')
+            if parfor.reductions:
+                self.out.wl('spy_parallel_reduce_lock();')
+                for varname, op in parfor.reductions.items():
+                    self.out.wl(f'SPY_e->{varname} = '
+                                f'SPY_e->{varname} {op} {varname};')
+                self.out.wl('spy_parallel_reduce_unlock();')
+        self.out.wl('}')
+        self.out.wl()
+
+    def emit_task_trampolines(self) -> None:
+        """
+        Emit the trampolines for the functions which are spawn()ed by this
+        function, unless they have already been emitted. E.g., for
+        `spawn(fib, n - 1)`:
+
+            struct spy_test$fib$task_env { int32_t SPY_result; int32_t n; };
+            static void spy_test$fib$task(void *SPY_env) {
+                struct spy_test$fib$task_env *SPY_e = SPY_env;
+                SPY_e->SPY_result = spy_test$fib(SPY_e->n);
+            }
+
+        spy_task_spawn copies the env into the task, and spy_task_join
+        copies the result out of it: SPY_result must be the first field.
+        """
+        for call in self.w_func.funcdef.walk(ast.Call):
+            assert isinstance(call, ast.Call)
+            if not self.is_opimpl_call(call, 'builtins::spawn'):
+                continue
+            target = call.args[1]
+            assert isinstance(target, ast.FQNConst), \
+                'indirect calls are not supported yet'
+            if target.fqn in self.cmod.task_trampolines:
+                continue
+            self.cmod.task_trampolines.add(target.fqn)
+            self.emit_task_trampoline(target.fqn)
+
+    def emit_task_trampoline(self, fqn: FQN) -> None:
+        w_func = self.ctx.vm.lookup_global(fqn)
+        assert isinstance(w_func, W_Func)
+        w_functype = w_func.w_functype
+        name = f'{fqn.c_name}$task'
+        has_result = w_functype.w_restype is not B.w_void
+        self.out.wl(f'struct {name}_env {{')
+        with self.out.indent():
+            if has_result:
+                c_restype = self.ctx.w2c(w_functype.w_restype)
+                self.out.wl(f'{c_restype} SPY_result;')
+            for p in w_functype.params:
+                self.out.wl(f'{self.ctx.w2c(p.w_type)} {p.name};')
+            if not has_result and not w_functype.params:
+                # empty structs are not allowed in C99
+                self.out.wl('char SPY_unused;')
+        self.out.wl('};')
+        self.out.wl(f'static void {name}(void *SPY_env) {{')
+        with self.out.indent():
+            self.out.wl(f'struct {name}_env *SPY_e = SPY_env;')
+            args = ', '.join(f'SPY_e->{p.name}' for p in w_functype.params)
+            if has_result:
+                self.out.wl(f'SPY_e->SPY_result = {fqn.c_name}({args});')
+            else:
+                self.out.wl(f'{fqn.c_name}({args});')
+        self.out.wl('}')
+        self.out.wl()
+
+    def is_opimpl_call(self, call: ast.Call, target: str) -> bool:
+        """
+        Return True if call is the redshifted version of a generic call to
+        the given builtin, i.e. `OPIMPL(target, ...)`. See
+        FuncDoppler.shift_expr_Call.
+        """
+        return (len(call.args) > 0 and
+                isinstance(call.args[0], ast.FQNConst) and
+                call.args[0].fqn == FQN.parse(target))
+
     def emit_lineno_maybe(self, loc: Loc) -> None:
         """
         Emit a #line directive, but only if it's needed.
@@ -206,8 +476,10 @@ class CFuncWriter:
         """
         Emit a #line directive, unconditionally
         """
+        # the #line directive sets the line number of the line which
+        # follows it, i.e. cline+1
         cline = self.out.lineno
-        self.out.wl(f'#line SPY_LINE({spyline}, {cline})')
+        self.out.wl(f'#line SPY_LINE({spyline}, {cline+1})')
         self.last_emitted_linenos = (spyline, cline)
 
     def emit_stmt(self, stmt: ast.Stmt) -> None:
@@ -270,6 +542,24 @@ class CFuncWriter:
                 self.emit_stmt(stmt)
         self.out.wl('}')
 
+    def emit_stmt_ParallelFor(self, parfor: ast.ParallelFor) -> None:
+        # see emit_parfor_functions
+        name = self.parfor_names[parfor]
+        n = self.fmt_expr(parfor.n)
+        schedule = f'SPY_SCHEDULE_{parfor.schedule.upper()}'
+        env_vars = self.parfor_captured(parfor) + list(parfor.reductions)
+        init = ', '.join(f'.{varname} = {varname}' for varname in env_vars)
+        if not env_vars:
+            init = '0'
+        self.out.wl('{')
+        with self.out.indent():
+            self.out.wl(f'struct {name}_env SPY_loop_env = {{{init}}};')
+            self.out.wl(f'spy_parallel_for({n}, {schedule}, {name}, '
+                        '&SPY_loop_env);')
+            for varname in parfor.reductions:
+                self.out.wl(f'{varname} = SPY_loop_env.{varname};')
+        self.out.wl('}')
+
     # ===== expressions =====
 
     def fmt_expr_Constant(self, const: ast.Constant) -> C.Expr:
@@ -280,7 +570,17 @@ class CFuncWriter:
         if T is NoneType:
             return C.Void()
         elif T is int:
-            return C.Literal(str(const.value))
+            # literals which don't fit an i32 are i64 or u64, see
+            # TypeChecker.check_expr_Constant
+            v = const.value
+            assert isinstance(v, int)
+            if -2**31 <= v < 2**31:
+                return C.Literal(str(v))
+            elif v == -2**63:
+                return C.Literal('INT64_MIN')
+            elif v < 2**63:
+                return C.Literal(f'{v}LL')
+            return C.Literal(f'{v}ULL')
         elif T is float:
             return C.Literal(str(const.value))
         elif T is bool:
@@ -296,7 +596,7 @@ class CFuncWriter:
         # generate the following:
         #
         #     // global declarations
-        #     static spy_Str SPY_g_str0 = {5, "hello"};
+        #     static spy_Str SPY_g_str0 = {5, "hello", NULL, SPY_STR_VALID_UTF8};
         #     ...
         #     // literal expr
         #     &SPY_g_str0 /* "hello" */
@@ -305,19 +605,29 @@ class CFuncWriter:
         # the content of the literal: hopefully this will make the code more
         # readable for humans.
         #
+        # Equal literals share the same global: this is important for big
+        # strings computed at blue time, which might be used in many places.
+        #
         # Emit the global decl
         utf8 = s.encode('utf-8')
-        v = self.cmod.new_global_var('str')  # SPY_g_str0
-        n = len(utf8)
-        lit = C.Literal.from_bytes(utf8)
-        init = '{%d, %s}' % (n, lit)
-        self.cmod.out_globals.wl(f'static spy_Str {v} = {init};')
+        v = self.cmod.str_literals.get(s)
+        if v is None:
+            v = self.cmod.new_global_var('str')  # SPY_g_str0
+            self.cmod.str_literals[s] = v
+            n = len(utf8)
+            lit = C.Literal.from_bytes(utf8)
+            # the literals come from Python strs, so they are valid utf-8
+            init = '{%d, %s, NULL, SPY_STR_VALID_UTF8}' % (n, lit)
+            self.cmod.out_globals.wl(f'static spy_Str {v} = {init};')
         #
         # shortstr is what we show in the comment, with a length limit
         comment = shortrepr(utf8.decode('utf-8'), 15)
         v = f'{v} /* {comment} */'
         return C.UnaryOp('&', C.Literal(v))
 
+    def fmt_expr_FQNConst(self, const: ast.FQNConst) -> C.Expr:
+        return C.Literal(const.fqn.c_name)
+
     def fmt_expr_Name(self, name: ast.Name) -> C.Expr:
         sym = self.w_func.funcdef.symtable.lookup(name.id)
         if sym.is_local:
@@ -363,12 +673,75 @@ class CFuncWriter:
         FQN.parse('operator::f64_le') : '<=',
         FQN.parse('operator::f64_gt') : '>',
         FQN.parse('operator::f64_ge') : '>=',
+        #
+        # SIMD types map to vector extensions, which support the arithmetic
+        # operators lane-wise
+        FQN.parse('operator::f64x2_add'): '+',
+        FQN.parse('operator::f64x2_sub'): '-',
+        FQN.parse('operator::f64x2_mul'): '*',
+        FQN.parse('operator::f64x2_div'): '/',
+        FQN.parse('operator::f32x4_add'): '+',
+        FQN.parse('operator::f32x4_sub'): '-',
+        FQN.parse('operator::f32x4_mul'): '*',
+        FQN.parse('operator::f32x4_div'): '/',
+        FQN.parse('operator::i32x4_add'): '+',
+        FQN.parse('operator::i32x4_sub'): '-',
+        FQN.parse('operator::i32x4_mul'): '*',
+    }
+
+    # the other numeric types, see opimpl_numeric.py. The arithmetic of the
+    # types which are smaller than int and of the signed ones is done by
+    # functions in spy/numeric.h, so that it wraps around and the division
+    # rounds like in the interpreter
+    FQN2BinOp.update({
+        FQN.parse(f'operator::{t}_{name}'): token
+        for t in list(SIZED_INTS) + ['f32']
+        for name, token in TOKENS.items()
+        if not (name in ARITH_OPS and t in ('i8', 'u8', 'i16', 'u16', 'i64'))
+    })
+
+    # string comparisons become e.g. `spy_str_cmp(a, b) < 0`
+    FQN2StrCmp = {
+        FQN.parse('operator::str_lt'): '<',
+        FQN.parse('operator::str_le'): '<=',
+        FQN.parse('operator::str_gt'): '>',
+        FQN.parse('operator::str_ge'): '>=',
+    }
+
+    # conversions between numeric types, e.g. `u8(x)`, become C casts
+    NumericConvs = {
+        FQN.parse(f'operator::{_from}_to_{_to}'): _to
+        for _from in ALL_NUMERIC for _to in ALL_NUMERIC
+    }
+
+    # conversions from str, e.g. `i32(s)`, are implemented by libspy
+    StrConvs = {
+        FQN.parse(f'operator::str_to_{_to}'): f'spy_str_to_{_to}'
+        for _to in ('i32', 'i64', 'f64')
     }
 
     def fmt_expr_Call(self, call: ast.Call) -> C.Expr:
         assert isinstance(call.func, ast.FQNConst), \
             'indirect calls are not supported yet'
 
+        if self.is_opimpl_call(call, 'builtins::spawn'):
+            return self.fmt_spawn(call)
+        if self.is_opimpl_call(call, 'builtins::join'):
+            return self.fmt_join(call)
+
+        totype = self.NumericConvs.get(call.func.fqn)
+        if totype is not None:
+            # the first argument is the type
+            assert len(call.args) == 2
+            c_type = self.ctx.w2c(getattr(B, f'w_{totype}'))
+            return C.Cast(str(c_type), self.fmt_expr(call.args[1]))
+
+        c_func = self.StrConvs.get(call.func.fqn)
+        if c_func is not None:
+            # the first argument is the type
+            assert len(call.args) == 2
+            return C.Call(c_func, [self.fmt_expr(call.args[1])])
+
         # some calls are special-cased and transformed into a C binop
         op = self.FQN2BinOp.get(call.func.fqn)
         if op is not None:
@@ -376,7 +749,62 @@ class CFuncWriter:
             l, r = [self.fmt_expr(arg) for arg in call.args]
             return C.BinOp(op, l, r)
 
+        op = self.FQN2StrCmp.get(call.func.fqn)
+        if op is not None:
+            assert len(call.args) == 2
+            args = [self.fmt_expr(arg) for arg in call.args]
+            return C.BinOp(op, C.Call('spy_str_cmp', args), C.Literal('0'))
+
         # the default case is to call a function with the corresponding name
         c_name = call.func.fqn.c_name
         c_args = [self.fmt_expr(arg) for arg in call.args]
         return C.Call(c_name, c_args)
+
+    def fmt_spawn(self, call: ast.Call) -> C.Expr:
+        # see emit_task_trampolines
+        target = call.args[1]
+        assert isinstance(target, ast.FQNConst)
+        w_func = self.ctx.vm.lookup_global(target.fqn)
+        assert isinstance(w_func, W_Func)
+        name = f'{target.fqn.c_name}$task'
+        params = w_func.w_functype.params
+        args = [self.fmt_expr(arg) for arg in call.args[2:]]
+        init = ', '.join(f'.{p.name} = {arg}' for p, arg in zip(params, args))
+        if not init:
+            init = '0'
+        env = C.Literal(f'&(struct {name}_env){{{init}}}')
+        size = C.Literal(f'sizeof(struct {name}_env)')
+        return C.Call('spy_task_spawn', [C.Literal(name), env, size])
+
+    def fmt_join(self, call: ast.Call) -> C.Expr:
+        """
+        spy_task_join frees the task, so it copies the result to the caller.
+        For each type of task we emit a helper which returns it by value,
+        named after the opimpl, e.g. for Task[i32]:
+
+            static inline int32_t spy_builtins$join$0(spy_Task *SPY_task) {
+                int32_t SPY_result;
+                spy_task_join(SPY_task, &SPY_result, sizeof(SPY_result));
+                return SPY_result;
+            }
+        """
+        assert isinstance(call.func, ast.FQNConst)
+        fqn = call.func.fqn
+        w_opimpl = self.ctx.vm.lookup_global(fqn)
+        assert isinstance(w_opimpl, W_Func)
+        w_T = w_opimpl.w_functype.w_restype
+        task = self.fmt_expr(call.args[1])
+        if w_T is B.w_void:
+            return C.Call('spy_task_join', [task, C.Literal('NULL'),
+                                            C.Literal('0')])
+        if fqn not in self.cmod.join_helpers:
+            self.cmod.join_helpers.add(fqn)
+            c_T = self.ctx.w2c(w_T)
+            self.cmod.out_globals.wb(f"""
+            static inline {c_T} {fqn.c_name}(spy_Task *SPY_task) {{
+                {c_T} SPY_result;
+                spy_task_join(SPY_task, &SPY_result, sizeof(SPY_result));
+                return SPY_result;
+            }}
+            """)
+        return C.Call(fqn.c_name, [task])
@@ -5,8 +5,8 @@ import wasmtime
 from spy.fqn import FQN
 from spy.llwasm import LLWasmType
 from spy.libspy import LLSPyInstance
-from spy.vm.object import W_Type
-from spy.vm.str import ll_spy_Str_new
+from spy.vm.object import W_Type, W_SizedInt
+from spy.vm.str import ll_spy_Str_new, ll_spy_Str_utf8
 from spy.vm.module import W_Module
 from spy.vm.function import W_Func, W_FuncType
 from spy.vm.vm import SPyVM
@@ -71,6 +71,13 @@ class WasmFuncWrapper:
     def py2wasm(self, pyval: Any, w_type: W_Type) -> Any:
         if w_type in (B.w_i32, B.w_f64):
             return pyval
+        elif w_type is B.w_f32:
+            return pyval
+        elif issubclass(w_type.pyclass, W_SizedInt):
+            # WASM has only i32 and i64, which are signed from the point of
+            # view of wasmtime
+            bits = 32 if w_type.pyclass.BITS <= 32 else 64
+            return (pyval + 2**(bits-1)) % 2**bits - 2**(bits-1)
         elif w_type is B.w_str:
             # XXX: with the GC, we need to think how to keep this alive
             return ll_spy_Str_new(self.ll, pyval)
@@ -103,13 +110,17 @@ class WasmFuncWrapper:
             return res
         elif w_type is B.w_f64:
             return res
+        elif w_type is B.w_f32:
+            return res
+        elif issubclass(w_type.pyclass, W_SizedInt):
+            return w_type.pyclass.normalize(res)
         elif w_type is B.w_bool:
             return bool(res)
         elif w_type is B.w_str:
             # res is a  spy_Str*
             addr = res
             length = self.ll.mem.read_i32(addr)
-            utf8 = self.ll.mem.read(addr + 4, length)
+            utf8 = self.ll.mem.read(ll_spy_Str_utf8(self.ll, addr), length)
             return utf8.decode('utf-8')
         elif w_type is RB.w_RawBuffer:
             # res is a  spy_RawBuffer*
@@ -13,6 +13,7 @@ from typing import Any
 from spy.vm.vm import SPyVM
 from spy.vm.module import W_Module
 from spy.vm.function import W_Func, W_FuncType
+from spy.vm.object import W_Object, W_SizedInt, W_F32
 
 
 class InterpModuleWrapper:
@@ -49,9 +50,19 @@ class InterpFuncWrapper:
         self.w_func = w_func
         self.w_functype = w_func.w_functype
 
+    def py2spy(self, i: int, arg: Any) -> W_Object:
+        # vm.wrap() turns all ints into i32 and all floats into f64: for the
+        # other numeric types we look at the type of the param
+        params = self.w_functype.params
+        if i < len(params):
+            pyclass = params[i].w_type.pyclass
+            if issubclass(pyclass, (W_SizedInt, W_F32)):
+                return pyclass(arg)
+        return self.vm.wrap(arg)
+
     def __call__(self, *args: Any) -> Any:
         # *args contains python-level objs. We want to wrap them into args_w
         # *and to call the func, and unwrap the result
-        args_w = [self.vm.wrap(arg) for arg in args]
+        args_w = [self.py2spy(i, arg) for i, arg in enumerate(args)]
         w_res = self.vm.call_function(self.w_func, args_w)
         return self.vm.unwrap(w_res)
@@ -141,6 +141,17 @@ class SPyBackend:
             for stmt in while_node.body:
                 self.emit_stmt(stmt)
 
+    def emit_stmt_ParallelFor(self, parfor: ast.ParallelFor) -> None:
+        n = self.fmt_expr(parfor.n)
+        if parfor.schedule == 'static':
+            args = n
+        else:
+            args = f'{n}, {parfor.schedule!r}'
+        self.wl(f'for {parfor.target} in parallel_range({args}):')
+        with self.out.indent():
+            for stmt in parfor.body:
+                self.emit_stmt(stmt)
+
     def emit_stmt_If(self, if_node: ast.If) -> None:
         test = self.fmt_expr(if_node.test)
         self.wl(f'if {test}:')
@@ -183,6 +194,8 @@ class SPyBackend:
     fmt_expr_LtE = fmt_expr_BinOp
     fmt_expr_Gt = fmt_expr_BinOp
     fmt_expr_GtE = fmt_expr_BinOp
+    fmt_expr_In = fmt_expr_BinOp
+    fmt_expr_NotIn = fmt_expr_BinOp
 
     # special cases
     FQN2BinOp = {
@@ -235,6 +248,18 @@ class SPyBackend:
         i = self.fmt_expr(getitem.index)
         return f'{v}[{i}]'
 
+    def fmt_expr_GetSlice(self, node: ast.GetSlice) -> str:
+        v = self.fmt_expr(node.value)
+        start = stop = ''
+        if not self._is_const(node.start, 0):
+            start = self.fmt_expr(node.start)
+        if not self._is_const(node.stop, ast.GetSlice.END):
+            stop = self.fmt_expr(node.stop)
+        return f'{v}[{start}:{stop}]'
+
+    def _is_const(self, expr: ast.Expr, value: object) -> bool:
+        return isinstance(expr, ast.Constant) and expr.value == value
+
     def fmt_expr_GetAttr(self, node: ast.GetAttr) -> str:
         v = self.fmt_expr(node.value)
         return f'{v}.{node.attr}'
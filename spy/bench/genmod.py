@@ -0,0 +1,84 @@
+"""
+Generator of synthetic SPy modules, used to stress-test the compiler.
+
+The generated modules are valid SPy and exercise the features which are most
+likely to show non-linear behavior as the size of the program grows:
+
+  - N red functions cg0..cg{N-1} forming a deep call graph: each cg{i}
+    calls cg{i-1} and cg{i//2}
+
+  - N functions lit{i} containing many string literals
+
+  - N red functions spec{i}, each of which triggers two blue specializations:
+    make_adder(i) and make_wide(i, i+1, ...). Every specialization creates a
+    new closure which needs an FQN and ends up in the C output
+
+  - make_wide captures `closure_width` blue variables
+"""
+
+from dataclasses import dataclass
+from spy.textbuilder import TextBuilder
+
+@dataclass
+class GenConfig:
+    n_funcs: int
+    n_strings: int = 4      # number of string literals in each lit{i}
+    closure_width: int = 16 # number of variables captured by make_wide
+
+
+def generate(cfg: GenConfig) -> str:
+    out = TextBuilder()
+    gen_blue_helpers(out, cfg)
+    for i in range(cfg.n_funcs):
+        gen_call_graph_func(out, i)
+        gen_str_func(out, cfg, i)
+        gen_blue_spec_func(out, cfg, i)
+    return out.build()
+
+def gen_blue_helpers(out: TextBuilder, cfg: GenConfig) -> None:
+    out.wl('@blue')
+    out.wl('def make_adder(k):')
+    with out.indent():
+        out.wl('def adder(x: i32) -> i32:')
+        with out.indent():
+            out.wl('return x + k')
+        out.wl('return adder')
+    out.wl()
+    params = ', '.join(f'a{j}' for j in range(cfg.closure_width))
+    total = ' + '.join(['x'] + [f'a{j}' for j in range(cfg.closure_width)])
+    out.wl('@blue')
+    out.wl(f'def make_wide({params}):')
+    with out.indent():
+        out.wl('def wide(x: i32) -> i32:')
+        with out.indent():
+            out.wl(f'return {total}')
+        out.wl('return wide')
+    out.wl()
+
+def gen_call_graph_func(out: TextBuilder, i: int) -> None:
+    out.wl(f'def cg{i}(x: i32) -> i32:')
+    with out.indent():
+        if i == 0:
+            out.wl('return x')
+        else:
+            out.wl(f'return cg{i-1}(x) + cg{i//2}(x) + {i}')
+    out.wl()
+
+def gen_str_func(out: TextBuilder, cfg: GenConfig, i: int) -> None:
+    lits = ' + '.join(f'"lit_{i}_{j}"' for j in range(cfg.n_strings))
+    out.wl(f'def lit{i}() -> str:')
+    with out.indent():
+        out.wl(f'return {lits}')
+    out.wl()
+
+def gen_blue_spec_func(out: TextBuilder, cfg: GenConfig, i: int) -> None:
+    wide_args = ', '.join(str(i + j) for j in range(cfg.closure_width))
+    # the closures returned by blue functions are seen as `dynamic` by the
+    # typechecker: bind the results to i32 locals, so that the sum is a
+    # static i32 addition
+    out.wl(f'def spec{i}(x: i32) -> i32:')
+    with out.indent():
+        out.wl(f'a: i32 = make_adder({i})(x)')
+        out.wl(f'b: i32 = make_wide({wide_args})(x)')
+        out.wl('return a + b')
+    out.wl()
@@ -0,0 +1,197 @@
+"""
+Measure how the time and memory of each compiler phase scale with the size of
+the module, using the modules produced by spy.bench.genmod.
+
+For each phase we fit a line to log(time) vs log(n_funcs): a slope of ~1
+means linear behavior, ~2 quadratic, etc. Phases whose slope exceeds the
+threshold are flagged as superlinear. Usage:
+
+    python -m spy.bench.scaling [--sizes 100,200,400,800] [--threshold 1.3]
+"""
+
+import sys
+import math
+import time
+import argparse
+import tempfile
+import tracemalloc
+from dataclasses import dataclass
+from typing import Callable, Optional
+import py.path
+from spy import ast
+from spy.parser import Parser
+from spy.irgen.scope import ScopeAnalyzer
+from spy.irgen.modgen import ModuleGen
+from spy.backend.c.cwriter import CModuleWriter
+from spy.vm.vm import SPyVM
+from spy.vm.module import W_Module
+from spy.vm.function import W_ASTFunc
+from spy.vm.typechecker import TypeChecker
+from spy.bench.genmod import GenConfig, generate
+
+PHASES = ['parse', 'scope', 'modgen', 'typecheck', 'redshift', 'cwrite']
+
+@dataclass
+class PhaseResult:
+    seconds: float
+    peak_bytes: int
+
+
+class Pipeline:
+    """
+    Run the compiler phases one by one on the given source, measuring each of
+    them.
+
+    Note that the 'typecheck' phase is run on throw-away TypeCheckers: the
+    redshift performs its own typechecking, so 'redshift' includes that cost
+    again.
+    """
+    src: str
+    tmpdir: py.path.local
+    trace_memory: bool
+    results: dict[str, PhaseResult]
+
+    def __init__(self, src: str, tmpdir: py.path.local,
+                 trace_memory: bool) -> None:
+        self.src = src
+        self.tmpdir = tmpdir
+        self.trace_memory = trace_memory
+        self.results = {}
+
+    def measure(self, phase: str, fn: Callable[[], None]) -> None:
+        if self.trace_memory:
+            tracemalloc.start()
+        a = time.perf_counter()
+        fn()
+        b = time.perf_counter()
+        peak = 0
+        if self.trace_memory:
+            _, peak = tracemalloc.get_traced_memory()
+            tracemalloc.stop()
+        self.results[phase] = PhaseResult(b - a, peak)
+
+    def run(self) -> dict[str, PhaseResult]:
+        modname = 'genmod'
+        file_spy = self.tmpdir.join(f'{modname}.spy')
+        file_c = self.tmpdir.join(f'{modname}.c')
+        file_spy.write(self.src)
+        vm = SPyVM()
+        mod: Optional[ast.Module] = None
+        scopes: Optional[ScopeAnalyzer] = None
+        w_mod: Optional[W_Module] = None
+
+        def parse() -> None:
+            nonlocal mod
+            mod = Parser(self.src, str(file_spy)).parse()
+
+        def scope() -> None:
+            nonlocal scopes
+            assert mod is not None
+            scopes = ScopeAnalyzer(vm, modname, mod)
+            scopes.analyze()
+
+        def modgen() -> None:
+            nonlocal w_mod
+            assert mod is not None
+            assert scopes is not None
+            modgen = ModuleGen(vm, scopes.by_module(), modname, mod, file_spy)
+            w_mod = modgen.make_w_mod()
+
+        def typecheck() -> None:
+            assert w_mod is not None
+            for _, w_obj in w_mod.items_w():
+                if isinstance(w_obj, W_ASTFunc) and w_obj.color == 'red':
+                    t = TypeChecker(vm, w_obj)
+                    typecheck_body(t, w_obj.funcdef.body)
+
+        def cwrite() -> None:
+            assert w_mod is not None
+            CModuleWriter(vm, w_mod, file_spy, file_c).write_c_source()
+
+        self.measure('parse', parse)
+        self.measure('scope', scope)
+        self.measure('modgen', modgen)
+        self.measure('typecheck', typecheck)
+        self.measure('redshift', vm.redshift)
+        self.measure('cwrite', cwrite)
+        return self.results
+
+
+def typecheck_body(t: TypeChecker, body: list[ast.Stmt]) -> None:
+    for stmt in body:
+        t.check_stmt(stmt)
+        if isinstance(stmt, ast.If):
+            typecheck_body(t, stmt.then_body)
+            typecheck_body(t, stmt.else_body)
+        elif isinstance(stmt, (ast.While, ast.ParallelFor)):
+            typecheck_body(t, stmt.body)
+
+
+def run_one(n_funcs: int, reps: int,
+            tmpdir: py.path.local) -> dict[str, PhaseResult]:
+    """
+    Return the best time out of `reps` runs, and the peak memory measured by
+    an additional run under tracemalloc (which is too slow to be timed).
+    """
+    src = generate(GenConfig(n_funcs))
+    best: dict[str, float] = {phase: math.inf for phase in PHASES}
+    for _ in range(reps):
+        res = Pipeline(src, tmpdir, trace_memory=False).run()
+        for phase in PHASES:
+            best[phase] = min(best[phase], res[phase].seconds)
+    mem = Pipeline(src, tmpdir, trace_memory=True).run()
+    return {phase: PhaseResult(best[phase], mem[phase].peak_bytes)
+            for phase in PHASES}
+
+
+def loglog_slope(xs: list[float], ys: list[float]) -> float:
+    """
+    Least-squares slope of log(ys) as a function of log(xs)
+    """
+    assert len(xs) == len(ys) >= 2
+    lx = [math.log(x) for x in xs]
+    ly = [math.log(max(y, 1e-9)) for y in ys]
+    mx = sum(lx) / len(lx)
+    my = sum(ly) / len(ly)
+    num = sum((x - mx) * (y - my) for x, y in zip(lx, ly))
+    den = sum((x - mx) ** 2 for x in lx)
+    return num / den
+
+
+def main(argv: list[str]) -> int:
+    parser = argparse.ArgumentParser(prog='python -m spy.bench.scaling')
+    parser.add_argument('--sizes', default='100,200,400,800',
+                        help='comma-separated list of n_funcs')
+    parser.add_argument('--reps', type=int, default=3)
+    parser.add_argument('--threshold', type=float, default=1.3,
+                        help='log-log slope above which a phase is flagged')
+    args = parser.parse_args(argv)
+    sizes = [int(x) for x in args.sizes.split(',')]
+
+    all_results: dict[int, dict[str, PhaseResult]] = {}
+    with tempfile.TemporaryDirectory() as d:
+        tmpdir = py.path.local(d)
+        for n in sizes:
+            all_results[n] = res = run_one(n, args.reps, tmpdir)
+            row = ' '.join(f'{res[phase].seconds*1000:10.1f}'
+                           for phase in PHASES)
+            print(f'n={n:<6} [ms] {row}', flush=True)
+
+    print()
+    print(f'{"phase":<10} {"slope":>6} {"max ms":>10} {"max MB":>10}')
+    n_flagged = 0
+    for phase in PHASES:
+        times = [all_results[n][phase].seconds for n in sizes]
+        slope = loglog_slope([float(n) for n in sizes], times)
+        peak = all_results[sizes[-1]][phase].peak_bytes / (1024*1024)
+        flag = ''
+        if slope > args.threshold:
+            flag = '  <== SUPERLINEAR'
+            n_flagged += 1
+        print(f'{phase:<10} {slope:6.2f} {times[-1]*1000:10.1f} '
+              f'{peak:10.2f}{flag}')
+    return 1 if n_flagged else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
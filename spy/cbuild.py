@@ -41,7 +41,8 @@ class Toolchain:
         return [
             '-mmultivalue',
             '-Xclang', '-target-abi',
-            '-Xclang', 'experimental-mv'
+            '-Xclang', 'experimental-mv',
+            '-msimd128',  # for f64x2 & co., see spy/libspy/include/spy/simd.h
         ]
 
     @property
@@ -163,6 +164,12 @@ class NativeToolchain(Toolchain):
     def CC(self) -> list[str]:
         return ['cc']
 
+    @property
+    def LDFLAGS(self) -> list[str]:
+        # libspy uses pthreads for spy_parallel_for, and spy_math$* might
+        # call libm, see spy/libspy/include/spy/math.h
+        return super().LDFLAGS + ['-pthread', '-lm']
+
 
 class EmscriptenToolchain(Toolchain):
 
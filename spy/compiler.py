@@ -43,6 +43,8 @@ class Compiler:
         #
         if DUMP_C:
             print()
+            print(f'---- {self.cwriter.hfile} ----')
+            print(self.cwriter.hfile.read())
             print(f'---- {self.file_c} ----')
             print(self.file_c.read())
         #
@@ -3,11 +3,15 @@ from types import NoneType
 from fixedint import FixedInt
 from spy import ast
 from spy.location import Loc
-from spy.fqn import FQN
+from spy.fqn import QN, FQN
 from spy.vm.b import B
-from spy.vm.object import W_Object, W_Type
+from spy.vm.object import W_Object, W_Type, W_SizedInt, W_F32
 from spy.vm.function import W_ASTFunc, W_BuiltinFunc
 from spy.vm.astframe import ASTFrame
+from spy.vm.list import W_BaseList
+from spy.vm.modules.rawbuffer import W_RawBuffer
+from spy.vm.typeconverter import literal_int_type
+from spy.vm.modules.operator import OP
 from spy.util import magic_dispatch
 
 if TYPE_CHECKING:
@@ -18,9 +22,19 @@ def redshift(vm: 'SPyVM', w_func: W_ASTFunc) -> W_ASTFunc:
     dop = FuncDoppler(vm, w_func)
     return dop.redshift()
 
+def same_nodes(a: list[Any], b: list[Any]) -> bool:
+    """
+    Return True if the two lists contain exactly the same nodes
+    """
+    return len(a) == len(b) and all(x is y for x, y in zip(a, b))
+
 class FuncDoppler:
     """
-    Perform a redshift on a W_ASTFunc
+    Perform a redshift on a W_ASTFunc.
+
+    The shifted AST shares all the subtrees which don't change with the
+    original: the shift_* methods return the very same node if none of its
+    children has been shifted into something else.
     """
 
     def __init__(self, vm: 'SPyVM', w_func: W_ASTFunc) -> None:
@@ -32,10 +46,11 @@ class FuncDoppler:
 
     def redshift(self) -> W_ASTFunc:
         funcdef = self.w_func.funcdef
-        new_body = []
-        for stmt in funcdef.body:
-            new_body += self.shift_stmt(stmt)
-        new_funcdef = funcdef.replace(body=new_body)
+        new_body = self.shift_body(funcdef.body)
+        if same_nodes(new_body, funcdef.body):
+            new_funcdef = funcdef
+        else:
+            new_funcdef = funcdef.replace(body=new_body)
         #
         new_qn = self.w_func.qn
         # all the non-local lookups are redshifted into constants, so the
@@ -69,10 +84,22 @@ class FuncDoppler:
             if isinstance(value, FixedInt): # type: ignore
                 value = int(value)
             return ast.Constant(loc, value)
+        elif isinstance(w_val, (W_SizedInt, W_F32)):
+            # the other numeric types don't have literals: we emit an
+            # explicit conversion from a literal, e.g. `u8(42)`
+            v_lit = ast.Constant(loc, w_val.value)
+            if isinstance(w_val, W_F32):
+                w_littype = B.w_f64
+            else:
+                w_littype = literal_int_type(w_val.value)
+            w_opimpl = getattr(OP, f'w_{w_littype.name}_to_{w_type.name}')
+            func = self.make_const(loc, w_opimpl)
+            v_type = self.make_const(loc, w_type)
+            return ast.Call(loc, func, [v_type, v_lit])
 
         # this is a non-primitive prebuilt constant. If it doesn't have an FQN
         # yet, we need to assign it one. For now we know how to do it only for
-        # non-global functions
+        # non-global functions and for data computed at blue time
         fqn = self.vm.reverse_lookup_global(w_val)
         if fqn is None:
             if isinstance(w_val, W_ASTFunc):
@@ -83,6 +110,14 @@ class FuncDoppler:
                 # builtin functions MUST be unique
                 fqn = self.vm.get_FQN(w_val.qn, is_global=True)
                 self.vm.add_global(fqn, None, w_val)
+            elif isinstance(w_val, (W_RawBuffer, W_BaseList, W_Type)):
+                # e.g. a lookup table built by a @blue function, or a type
+                # such as list[i32]. It becomes a global of the module which
+                # uses it: the C backend emits it as static data, see
+                # CModuleWriter.declare_variable
+                qn = QN(modname=self.w_func.qn.modname, attr='prebuilt')
+                fqn = self.vm.get_FQN(qn, is_global=False)
+                self.vm.add_global(fqn, None, w_val)
             else:
                 assert False, 'implement me'
 
@@ -105,6 +140,8 @@ class FuncDoppler:
 
     def shift_stmt_Return(self, ret: ast.Return) -> list[ast.Stmt]:
         newvalue = self.shift_expr(ret.value)
+        if newvalue is ret.value:
+            return [ret]
         return [ret.replace(value=newvalue)]
 
     def shift_stmt_VarDef(self, vardef: ast.VarDef) -> list[ast.Stmt]:
@@ -113,12 +150,16 @@ class FuncDoppler:
         assert isinstance(w_ann_type, W_Type)
         self.blue_frame.exec_stmt_VarDef(vardef)
         newtype = self.shift_expr(vardef.type)
+        if newtype is vardef.type:
+            return [vardef]
         return [vardef.replace(type=newtype)]
 
     def shift_stmt_Assign(self, assign: ast.Assign) -> list[ast.Stmt]:
         sym = self.funcdef.symtable.lookup(assign.target)
         if sym.color == 'red':
             newvalue = self.shift_expr(assign.value)
+            if newvalue is assign.value:
+                return [assign]
             return [assign.replace(value=newvalue)]
         else:
             assert False, 'implement me'
@@ -134,6 +175,8 @@ class FuncDoppler:
 
     def shift_stmt_StmtExpr(self, stmt: ast.StmtExpr) -> list[ast.Stmt]:
         newvalue = self.shift_expr(stmt.value)
+        if newvalue is stmt.value:
+            return [stmt]
         return [stmt.replace(value=newvalue)]
 
     def shift_body(self, body: list[ast.Stmt]) -> list[ast.Stmt]:
@@ -146,6 +189,10 @@ class FuncDoppler:
         newtest = self.shift_expr(if_node.test)
         newthen = self.shift_body(if_node.then_body)
         newelse = self.shift_body(if_node.else_body)
+        if (newtest is if_node.test and
+            same_nodes(newthen, if_node.then_body) and
+            same_nodes(newelse, if_node.else_body)):
+            return [if_node]
         return [if_node.replace(
             test = newtest,
             then_body = newthen,
@@ -155,11 +202,22 @@ class FuncDoppler:
     def shift_stmt_While(self, while_node: ast.While) -> list[ast.While]:
         newtest = self.shift_expr(while_node.test)
         newbody = self.shift_body(while_node.body)
+        if (newtest is while_node.test and
+            same_nodes(newbody, while_node.body)):
+            return [while_node]
         return [while_node.replace(
             test = newtest,
             body = newbody
         )]
 
+    def shift_stmt_ParallelFor(self, parfor: ast.ParallelFor
+                               ) -> list[ast.ParallelFor]:
+        newn = self.shift_expr(parfor.n)
+        newbody = self.shift_body(parfor.body)
+        if newn is parfor.n and same_nodes(newbody, parfor.body):
+            return [parfor]
+        return [parfor.replace(n=newn, body=newbody)]
+
     # ==== expressions ====
 
     def shift_expr_Constant(self, const: ast.Constant) -> ast.Expr:
@@ -170,6 +228,8 @@ class FuncDoppler:
 
     def shift_expr_List(self, lst: ast.List) -> ast.Expr:
         items = [self.shift_expr(item) for item in lst.items]
+        if same_nodes(items, lst.items):
+            return lst
         return ast.List(lst.loc, items)
 
     def shift_expr_BinOp(self, binop: ast.BinOp) -> ast.Expr:
@@ -189,6 +249,8 @@ class FuncDoppler:
     shift_expr_LtE = shift_expr_BinOp
     shift_expr_Gt = shift_expr_BinOp
     shift_expr_GtE = shift_expr_BinOp
+    shift_expr_In = shift_expr_BinOp
+    shift_expr_NotIn = shift_expr_BinOp
 
     def shift_expr_GetItem(self, op: ast.GetItem) -> ast.Expr:
         v = self.shift_expr(op.value)
@@ -197,6 +259,14 @@ class FuncDoppler:
         func = self.make_const(op.loc, w_opimpl)
         return ast.Call(op.loc, func, [v, i])
 
+    def shift_expr_GetSlice(self, op: ast.GetSlice) -> ast.Expr:
+        v = self.shift_expr(op.value)
+        start = self.shift_expr(op.start)
+        stop = self.shift_expr(op.stop)
+        w_opimpl = self.t.opimpl[op]
+        func = self.make_const(op.loc, w_opimpl)
+        return ast.Call(op.loc, func, [v, start, stop])
+
     def shift_expr_GetAttr(self, op: ast.GetAttr) -> ast.Expr:
         v = self.shift_expr(op.value)
         v_attr = ast.Constant(op.loc, value=op.attr)
@@ -211,6 +281,23 @@ class FuncDoppler:
         def isprint(node: ast.Node) -> bool:
             return (isinstance(node, ast.FQNConst) and
                     node.fqn == FQN.parse('builtins::print'))
+        if call in self.t.method_calls:
+            # method call through op.CALL_METHOD: the opimpl receives the
+            # object as the first argument
+            assert isinstance(call.func, ast.GetAttr)
+            w_opimpl = self.t.opimpl[call]
+            func = self.make_const(call.loc, w_opimpl)
+            v_obj = self.shift_expr(call.func.value)
+            newargs = [self.shift_expr(arg) for arg in call.args]
+            return ast.Call(call.loc, func, [v_obj] + newargs)
+        if call in self.t.opimpl:
+            # generic call through op.CALL: turn it into a direct call to
+            # the opimpl, which receives the target as the first argument
+            w_opimpl = self.t.opimpl[call]
+            func = self.make_const(call.loc, w_opimpl)
+            v_target = self.shift_expr(call.func)
+            newargs = [self.shift_expr(arg) for arg in call.args]
+            return ast.Call(call.loc, func, [v_target] + newargs)
         newfunc = self.shift_expr(call.func)
         newargs = [self.shift_expr(arg) for arg in call.args]
         # hack hack
@@ -218,15 +305,18 @@ class FuncDoppler:
             assert isinstance(newfunc, ast.FQNConst)
             color, w_type = self.t.check_expr(newargs[0])
             if w_type is B.w_i32:
-                newfunc.fqn = FQN.parse('builtins::print_i32')
+                fqn = FQN.parse('builtins::print_i32')
             elif w_type is B.w_f64:
-                newfunc.fqn = FQN.parse('builtins::print_f64')
+                fqn = FQN.parse('builtins::print_f64')
             elif w_type is B.w_bool:
-                newfunc.fqn = FQN.parse('builtins::print_bool')
+                fqn = FQN.parse('builtins::print_bool')
             elif w_type is B.w_void:
-                newfunc.fqn = FQN.parse('builtins::print_void')
+                fqn = FQN.parse('builtins::print_void')
             elif w_type is B.w_str:
-                newfunc.fqn = FQN.parse('builtins::print_str')
+                fqn = FQN.parse('builtins::print_str')
             else:
                 assert False
+            newfunc = newfunc.replace(fqn=fqn)
+        if newfunc is call.func and same_nodes(newargs, call.args):
+            return call
         return call.replace(func=newfunc, args=newargs)
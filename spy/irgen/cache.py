@@ -0,0 +1,207 @@
+"""
+Cache of parsed modules, both in memory and on disk.
+
+Parsing and scope analysis depend only on:
+
+  - the source code and the filename (which ends up in all the Locs)
+
+  - the version of the front-end, i.e. the code of the parser and of the
+    ScopeAnalyzer
+
+  - the names of the builtins, and the FQNs of the imported names
+
+The first three are part of the cache key. The imports cannot be part of the
+key because they depend on the state of the VM: on a cache hit, we re-check
+that all the imported names exist and, if they don't, we redo the analysis
+from scratch, which reports the proper error.
+
+The on-disk cache lives in $SPY_CACHE_DIR (default: $XDG_CACHE_HOME/spy or
+~/.cache/spy). Set SPY_CACHE_DIR to the empty string to disable it.
+
+On top of it, there is a process-wide in-memory cache, so that all the
+SPyVMs of a process share the very same ParsedModule objects. This works
+because the AST and the symtables are never modified after scope analysis
+(symtables are explicitly frozen): everything which is per-VM (W_ objects,
+globals, typechecker results, redshifted functions) lives elsewhere.
+"""
+
+import os
+import pickle
+import hashlib
+import threading
+from collections import OrderedDict
+from dataclasses import dataclass
+from functools import lru_cache
+from typing import Optional
+import py.path
+import spy
+from spy import ast
+from spy.parser import Parser
+from spy.irgen.scope import ScopeAnalyzer
+from spy.irgen.symtable import SymTable
+from spy.vm.vm import SPyVM
+
+# the files which affect the result of parsing and scope analysis
+FRONTEND_FILES = [
+    'ast.py',
+    'fqn.py',
+    'location.py',
+    'magic_py_parse.py',
+    'parser.py',
+    'irgen/scope.py',
+    'irgen/symtable.py',
+]
+
+# max number of entries of the in-memory cache
+MEMORY_CACHE_SIZE = 1024
+
+@dataclass
+class ParsedModule:
+    """
+    The result of parsing + scope analysis. The symtables of the FuncDefs are
+    reachable from mod, through FuncDef.symtable.
+
+    It is shared between VMs, so it must be treated as immutable.
+    """
+    mod: ast.Module
+    mod_scope: SymTable
+
+
+@lru_cache(maxsize=None)
+def frontend_version() -> str:
+    h = hashlib.sha256()
+    for name in FRONTEND_FILES:
+        h.update(spy.ROOT.join(name).read_binary())
+    return h.hexdigest()
+
+def get_cache_dir() -> Optional[py.path.local]:
+    d = os.environ.get('SPY_CACHE_DIR')
+    if d is None:
+        base = os.environ.get('XDG_CACHE_HOME') or os.path.expanduser('~/.cache')
+        return py.path.local(base).join('spy', 'parse')
+    elif d == '':
+        return None
+    else:
+        return py.path.local(d)
+
+def cache_key(vm: SPyVM, filename: str, src: str) -> str:
+    h = hashlib.sha256()
+    h.update(frontend_version().encode('ascii'))
+    h.update(b'\0')
+    h.update(filename.encode('utf-8'))
+    h.update(b'\0')
+    for fqn in sorted(str(fqn) for fqn in vm.modules_w['builtins'].keys()):
+        h.update(fqn.encode('utf-8'))
+        h.update(b'\0')
+    h.update(src.encode('utf-8'))
+    return h.hexdigest()
+
+
+def parse_and_analyze(vm: SPyVM, src: str, filename: str,
+                      modname: str) -> ParsedModule:
+    parser = Parser(src, filename)
+    mod = parser.parse()
+    scopes = ScopeAnalyzer(vm, modname, mod)
+    scopes.analyze()
+    return ParsedModule(mod, scopes.by_module())
+
+def imports_are_valid(vm: SPyVM, mod: ast.Module) -> bool:
+    for decl in mod.decls:
+        if isinstance(decl, ast.Import):
+            if vm.lookup_global(decl.fqn) is None:
+                return False
+    return True
+
+
+class MemoryCache:
+    """
+    Process-wide LRU cache of ParsedModules.
+
+    It is shared by all the VMs, which might live in different threads.
+    """
+    size: int
+    entries: OrderedDict[str, ParsedModule]
+    lock: threading.Lock
+
+    def __init__(self, size: int) -> None:
+        self.size = size
+        self.entries = OrderedDict()
+        self.lock = threading.Lock()
+
+    def get(self, key: str) -> Optional[ParsedModule]:
+        with self.lock:
+            parsed = self.entries.get(key)
+            if parsed is not None:
+                self.entries.move_to_end(key)
+            return parsed
+
+    def put(self, key: str, parsed: ParsedModule) -> None:
+        with self.lock:
+            self.entries[key] = parsed
+            self.entries.move_to_end(key)
+            while len(self.entries) > self.size:
+                self.entries.popitem(last=False)
+
+    def clear(self) -> None:
+        with self.lock:
+            self.entries.clear()
+
+MEMORY_CACHE = MemoryCache(MEMORY_CACHE_SIZE)
+
+
+def load(cachedir: py.path.local, key: str) -> Optional[ParsedModule]:
+    f = cachedir.join(key)
+    try:
+        with open(f, 'rb') as fp:
+            parsed = pickle.load(fp)
+    except FileNotFoundError:
+        return None
+    except Exception:
+        # corrupted or incompatible entry: just ignore it, it will be
+        # overwritten
+        return None
+    if not isinstance(parsed, ParsedModule):
+        return None
+    return parsed
+
+def store(cachedir: py.path.local, key: str, parsed: ParsedModule) -> None:
+    try:
+        data = pickle.dumps(parsed, protocol=pickle.HIGHEST_PROTOCOL)
+    except RecursionError:
+        # very deeply nested ASTs cannot be pickled, don't cache them
+        return
+    try:
+        cachedir.ensure(dir=True)
+        # write to a temp file and rename, so that concurrent processes never
+        # see a partially written entry
+        tmp = cachedir.join(f'{key}.{os.getpid()}.tmp')
+        tmp.write_binary(data)
+        os.replace(tmp, cachedir.join(key))
+    except OSError:
+        # the cache is just an optimization
+        pass
+
+
+def parse_module(vm: SPyVM, f: py.path.local, modname: str) -> ParsedModule:
+    """
+    Parse and analyze the given file, using the cache if possible
+    """
+    src = f.read()
+    filename = str(f)
+    key = cache_key(vm, filename, src)
+    parsed = MEMORY_CACHE.get(key)
+    if parsed is not None and imports_are_valid(vm, parsed.mod):
+        return parsed
+    #
+    cachedir = get_cache_dir()
+    if cachedir is not None:
+        parsed = load(cachedir, key)
+        if parsed is not None and imports_are_valid(vm, parsed.mod):
+            MEMORY_CACHE.put(key, parsed)
+            return parsed
+    #
+    parsed = parse_and_analyze(vm, src, filename, modname)
+    if cachedir is not None:
+        store(cachedir, key, parsed)
+    MEMORY_CACHE.put(key, parsed)
+    return parsed
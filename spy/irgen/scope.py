@@ -1,4 +1,4 @@
-from typing import Optional
+from typing import Optional, Iterator, Any
 from spy import ast
 from spy.location import Loc
 from spy.irgen.symtable import Color
@@ -58,6 +58,10 @@ class ScopeAnalyzer:
             self.flatten(decl)
         assert len(self.stack) == 2
 
+        self.mod_scope.freeze()
+        for scope in self.funcdef_scopes.values():
+            scope.freeze()
+
     def by_module(self) -> SymTable:
         return self.mod_scope
 
@@ -191,6 +195,18 @@ class ScopeAnalyzer:
             type_loc = assign.value.loc
             self.add_name(name, 'red', assign.loc, type_loc)
 
+    def declare_ParallelFor(self, parfor: ast.ParallelFor) -> None:
+        # the loop variable must be a local, which is private to each
+        # iteration. Multiple loops can reuse the same name, but contrarily
+        # to declare_Assign a name of an outer scope (e.g. a global `i`)
+        # cannot be used: add_name reports the shadowing
+        level, sym = self.lookup(parfor.target)
+        if level != 0:
+            self.add_name(parfor.target, 'red', parfor.target_loc,
+                          parfor.n.loc)
+        for stmt in parfor.body:
+            self.declare(stmt)
+
     # ===
 
     def capture_maybe(self, varname: str) -> None:
@@ -228,6 +244,8 @@ class ScopeAnalyzer:
         self.pop_scope()
         #
         funcdef.symtable = inner_scope
+        for parfor in walk_stmts(funcdef.body, ast.ParallelFor):
+            self.check_ParallelFor(funcdef, parfor)
 
     def flatten_Name(self, name: ast.Name) -> None:
         self.capture_maybe(name.id)
@@ -235,3 +253,136 @@ class ScopeAnalyzer:
     def flatten_Assign(self, assign: ast.Assign) -> None:
         self.capture_maybe(assign.target)
         self.flatten(assign.value)
+
+    # ===
+
+    def check_ParallelFor(self, funcdef: ast.FuncDef,
+                          parfor: ast.ParallelFor) -> None:
+        """
+        Check that the iterations of the loop are independent, and compute
+        parfor.privates and parfor.reductions.
+
+        Every local var which is assigned inside the body must be either:
+
+          - private: used only inside the loop. Each iteration sees its own
+            copy, and its value is lost after the loop
+
+          - a reduction: the only mention of the var inside the body is
+            `x = x + ...` or `x = x * ...`
+
+        The loop var itself cannot be mentioned outside of the loop, because
+        it is private as well.
+        """
+        scope = self.by_funcdef(funcdef)
+        inside = names_in_stmts(parfor.body)
+        outside = names_in_stmts(funcdef.body, skip=parfor)
+        if parfor.target in outside:
+            err = SPyScopeError(
+                f'loop variable `{parfor.target}` is used outside the loop')
+            err.add('error', 'this is the loop variable', parfor.target_loc)
+            err.add('note', 'used here', outside[parfor.target][0])
+            raise err
+        #
+        privates = []
+        reductions = {}
+        for stmt in walk_stmts(parfor.body, (ast.Assign, ast.VarDef,
+                                             ast.ParallelFor)):
+            if isinstance(stmt, ast.VarDef):
+                name, loc = stmt.name, stmt.loc
+            elif isinstance(stmt, ast.Assign):
+                name, loc = stmt.target, stmt.target_loc
+            else:
+                name, loc = stmt.target, stmt.target_loc
+            sym = scope.lookup_maybe(name)
+            if sym is None or not sym.is_local:
+                err = SPyScopeError(
+                    f'cannot assign to `{name}` inside `parallel_range`')
+                err.add('error', 'this is not a local variable', loc)
+                raise err
+            if name == parfor.target:
+                err = SPyScopeError('cannot assign to the loop variable')
+                err.add('error', 'this is the loop variable', loc)
+                raise err
+            if name in privates or name in reductions:
+                continue
+            op = reduction_op(stmt, inside.get(name, []))
+            if op is not None:
+                reductions[name] = op
+            elif name not in outside:
+                privates.append(name)
+            else:
+                err = SPyScopeError(
+                    f'`{name}` is shared between the iterations of the loop')
+                err.add('error', 'assigned here', loc)
+                err.add('note', 'used outside the loop here', outside[name][0])
+                err.add('note', 'help: only `x = x + ...` and `x = x * ...` '
+                        'are allowed on shared variables', loc)
+                raise err
+        parfor.privates = privates
+        parfor.reductions = reductions
+
+
+def walk_stmts(body: list[ast.Stmt], cls: Any) -> Iterator[Any]:
+    """
+    Yield all the stmts of the given class in the body, recursively, but
+    without entering nested FuncDefs
+    """
+    for stmt in body:
+        if isinstance(stmt, cls):
+            yield stmt
+        if isinstance(stmt, ast.If):
+            yield from walk_stmts(stmt.then_body, cls)
+            yield from walk_stmts(stmt.else_body, cls)
+        elif isinstance(stmt, (ast.While, ast.ParallelFor)):
+            yield from walk_stmts(stmt.body, cls)
+
+def names_in_stmts(body: list[ast.Stmt],
+                   skip: Optional[ast.Node] = None) -> dict[str, list[Loc]]:
+    """
+    Return all the names which are read or written in the given body, with
+    the locations where they are mentioned. `skip` is excluded from the
+    search.
+
+    The loop var of a ParallelFor is private to it, so its mentions inside the
+    loop are not recorded.
+    """
+    res: dict[str, list[Loc]] = {}
+    def add(name: str, loc: Loc, hidden: frozenset[str]) -> None:
+        if name not in hidden:
+            res.setdefault(name, []).append(loc)
+
+    def visit(node: ast.Node, hidden: frozenset[str]) -> None:
+        if node is skip:
+            return
+        if isinstance(node, ast.Name):
+            add(node.id, node.loc, hidden)
+        elif isinstance(node, ast.Assign):
+            add(node.target, node.target_loc, hidden)
+        elif isinstance(node, ast.VarDef):
+            add(node.name, node.loc, hidden)
+        elif isinstance(node, ast.ParallelFor):
+            visit(node.n, hidden)
+            hidden = hidden | {node.target}
+            for stmt in node.body:
+                visit(stmt, hidden)
+            return
+        for child in node.get_children():
+            visit(child, hidden)
+
+    for stmt in body:
+        visit(stmt, frozenset())
+    return res
+
+def reduction_op(stmt: ast.Stmt, mentions: list[Loc]) -> Optional[str]:
+    """
+    If stmt is `x = x + ...` or `x = x * ...` and these are the only two
+    mentions of x, return the operator.
+    """
+    if not isinstance(stmt, ast.Assign) or len(mentions) != 2:
+        return None
+    value = stmt.value
+    if (isinstance(value, (ast.Add, ast.Mul)) and
+        isinstance(value.left, ast.Name) and
+        value.left.id == stmt.target):
+        return '+' if isinstance(value, ast.Add) else '*'
+    return None
@@ -44,10 +44,20 @@ class Symbol:
 class SymTable:
     name: str  # just for debugging
     _symbols: dict[str, Symbol]
+    frozen: bool
 
     def __init__(self, name: str) -> None:
         self.name = name
         self._symbols = {}
+        self.frozen = False
+
+    def freeze(self) -> None:
+        """
+        Make the symtable read-only. This is done at the end of scope
+        analysis: after that, symtables are shared by all the VMs of the
+        process (see irgen/cache.py), so they must never change.
+        """
+        self.frozen = True
 
     @classmethod
     def from_builtins(cls, vm: 'SPyVM') -> 'SymTable':
@@ -83,6 +93,7 @@ class SymTable:
             print(f'    [{sym.level}] {sym.color:4s} {sym_name} {fqn}')
 
     def add(self, sym: Symbol) -> None:
+        assert not self.frozen, f'cannot modify frozen {self}'
         self._symbols[sym.name] = sym
 
     def lookup(self, name: str) -> Symbol:
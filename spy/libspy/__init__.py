@@ -1,4 +1,5 @@
-from typing import Any, Optional
+from typing import Any, Optional, BinaryIO
+import sys
 import wasmtime as wt
 import spy
 from spy.llwasm import LLWasmModule, LLWasmInstance, HostModule
@@ -10,13 +11,46 @@ LIBSPY_WASM = spy.ROOT.join('libspy', 'build', 'wasm32', 'libspy.wasm')
 
 LLMOD = LLWasmModule(LIBSPY_WASM)
 
+def readinto_all(f: BinaryIO, buf: memoryview) -> int:
+    """
+    Read from f until buf is full or EOF, and return the number of bytes
+    which were read
+    """
+    n = 0
+    while n < len(buf):
+        k = f.readinto(buf[n:])  # type: ignore
+        if not k:
+            break
+        n += k
+    return n
+
+
 class LibSPyHost(HostModule):
+    """
+    The host side of libspy.
+
+    It also owns the streams which can be read by `io.read_stream`: they are
+    identified by small integers, like file descriptors. 0 is stdin, and
+    add_stream() assigns the others starting from 3.
+    """
     log: list[str]
     panic_message: Optional[str]
+    streams: dict[int, BinaryIO]
 
     def __init__(self) -> None:
         self.log = []
         self.panic_message = None
+        self.streams = {}
+
+    def add_stream(self, f: BinaryIO) -> int:
+        stream = max(self.streams, default=2) + 1
+        self.streams[stream] = f
+        return stream
+
+    def get_stream(self, stream: int) -> Optional[BinaryIO]:
+        if stream == 0 and stream not in self.streams:
+            return sys.stdin.buffer
+        return self.streams.get(stream)
 
     def _read_str(self, ptr: int) -> str:
         # ptr is const char*
@@ -36,6 +70,13 @@ class LibSPyHost(HostModule):
         self.log.append(msg)
         print('[log]', msg)
 
+    def env_spy_host_read(self, stream: int, ptr: int, size: int) -> int:
+        # read directly into the linear memory, without intermediate bytes
+        f = self.get_stream(stream)
+        if f is None:
+            return -1
+        return readinto_all(f, self.ll.mem.view(ptr, size))
+
     def env_spy_debug_set_panic_message(self, ptr: int) -> None:
         # ptr is const char*
         ba = self.ll.mem.read_cstr(ptr)
@@ -61,11 +102,14 @@ class LLSPyInstance(LLWasmInstance):
         super().__init__(llmod, hostmods)
 
     def call(self, name: str, *args: Any) -> Any:
-        func = self.get_export(name)
-        assert isinstance(func, wt.Func)
-        try:
-            return func(self.store, *args)
-        except wt.Trap:
-            if self.libspy.panic_message is not None:
-                raise SPyPanicError(self.libspy.panic_message)
-            raise
+        # panic_message is set by a host call made by func, so we must hold
+        # the lock until we have read it
+        with self.lock:
+            func = self.get_export(name)
+            assert isinstance(func, wt.Func)
+            try:
+                return func(self.store, *args)
+            except wt.Trap:
+                if self.libspy.panic_message is not None:
+                    raise SPyPanicError(self.libspy.panic_message)
+                raise
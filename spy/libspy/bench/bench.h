@@ -0,0 +1,46 @@
+#ifndef SPY_BENCH_H
+#define SPY_BENCH_H
+
+#include "spy.h"
+
+// Tiny microbenchmark harness for the libspy primitives.
+//
+// The same benchmark code runs natively and on wasm32: the only
+// platform-specific bits are the clock, the reporting and the CPU pinning,
+// which on wasm32 are provided by the host (see run_wasm.py).
+//
+// A benchmark is a function which runs the operation under test `iters`
+// times. The harness first calibrates `iters` so that a single sample lasts
+// at least `target_ns`, then runs `warmup` untimed samples followed by `reps`
+// timed ones, and reports the min/p50/p90/p99/max of the ns/op.
+
+typedef void (*spy_bench_fn)(void *ctx, int32_t iters);
+
+typedef struct {
+    int32_t reps;
+    int32_t warmup;
+    double target_ns;
+    const char *filter; // if not NULL, run only benchmarks containing it
+} spy_bench_config;
+
+extern spy_bench_config spy_bench_cfg;
+
+void spy_bench_run(const char *name, spy_bench_fn fn, void *ctx);
+
+// prevent the compiler from optimizing away the computation of p
+static inline void spy_bench_escape(const void *p) {
+    __asm__ volatile("" : : "r"(p) : "memory");
+}
+
+/***** WASM imports, must be provided by the host *****/
+/* (In native mode, these are implemented in harness.c) */
+double spy_bench_now_ns(void);
+void spy_bench_report(const char *name, int32_t iters, int32_t reps,
+                      double min, double p50, double p90, double p99,
+                      double max);
+/***** end of WASM imports *****/
+
+// defined in bench_libspy.c
+void spy_bench_all(void);
+
+#endif /* SPY_BENCH_H */
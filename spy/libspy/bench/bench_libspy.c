@@ -0,0 +1,397 @@
+#include "bench.h"
+
+// Benchmarks for the libspy primitives which are called by the generated
+// code. Results which are allocated by the primitives are freed immediately,
+// so that memory usage stays constant during a run (the GC is a fake anyway).
+
+static spy_Str *make_str(size_t length, char c) {
+    spy_Str *s = spy_str_alloc(length);
+    char *buf = (char *)s->utf8;
+    for (size_t i = 0; i < length; i++)
+        buf[i] = c + (char)(i % 16);
+    return s;
+}
+
+/* ========== spy_Str ========== */
+
+typedef struct {
+    spy_Str *a;
+    spy_Str *b;
+} str_pair;
+
+static void bench_str_add(void *ctx, int32_t iters) {
+    str_pair *p = ctx;
+    for (int32_t i = 0; i < iters; i++) {
+        spy_Str *res = spy_str_add(p->a, p->b);
+        spy_bench_escape(res);
+        free(res);
+    }
+}
+
+static void bench_str_eq(void *ctx, int32_t iters) {
+    str_pair *p = ctx;
+    int32_t n = 0;
+    for (int32_t i = 0; i < iters; i++) {
+        spy_bench_escape(p);
+        n += spy_str_eq(p->a, p->b);
+    }
+    spy_bench_escape(&n);
+}
+
+static void bench_str_cmp(void *ctx, int32_t iters) {
+    str_pair *p = ctx;
+    int32_t n = 0;
+    for (int32_t i = 0; i < iters; i++) {
+        spy_bench_escape(p);
+        n += spy_str_cmp(p->a, p->b) < 0;
+    }
+    spy_bench_escape(&n);
+}
+
+typedef struct {
+    spy_Str *s;
+    int32_t n;
+} str_int;
+
+static void bench_str_mul(void *ctx, int32_t iters) {
+    str_int *p = ctx;
+    for (int32_t i = 0; i < iters; i++) {
+        spy_Str *res = spy_str_mul(p->s, p->n);
+        spy_bench_escape(res);
+        free(res);
+    }
+}
+
+static void bench_str_getitem(void *ctx, int32_t iters) {
+    str_int *p = ctx;
+    int32_t length = (int32_t)p->s->length;
+    for (int32_t i = 0; i < iters; i++) {
+        spy_Str *res = spy_str_getitem(p->s, i % length);
+        spy_bench_escape(res);
+        free(res);
+    }
+}
+
+// slice s[1:1+n]: short slices are copies, long ones are views
+static void bench_str_slice(void *ctx, int32_t iters) {
+    str_int *p = ctx;
+    for (int32_t i = 0; i < iters; i++) {
+        spy_Str *res = spy_str_slice(p->s, 1, 1 + p->n);
+        spy_bench_escape(res);
+        free(res);
+    }
+}
+
+static void bench_str(void) {
+    spy_Str *s8 = make_str(8, 'a');
+    spy_Str *s256 = make_str(256, 'a');
+    spy_Str *s256b = make_str(256, 'a');
+    spy_Str *s256c = make_str(256, 'a');
+    ((char *)s256c->utf8)[255] = 'z';
+
+    str_pair add_small = {s8, s8};
+    str_pair add_large = {s256, s256};
+    spy_bench_run("str_add/8+8", bench_str_add, &add_small);
+    spy_bench_run("str_add/256+256", bench_str_add, &add_large);
+
+    str_int mul_small = {s8, 4};
+    str_int mul_large = {s8, 128};
+    spy_bench_run("str_mul/8*4", bench_str_mul, &mul_small);
+    spy_bench_run("str_mul/8*128", bench_str_mul, &mul_large);
+
+    str_pair eq_same = {s256, s256b};
+    str_pair eq_last = {s256, s256c};
+    str_pair eq_len = {s256, s8};
+    spy_bench_run("str_eq/256/equal", bench_str_eq, &eq_same);
+    spy_bench_run("str_eq/256/differ-last", bench_str_eq, &eq_last);
+    spy_bench_run("str_cmp/256/differ-last", bench_str_cmp, &eq_last);
+    spy_bench_run("str_eq/differ-length", bench_str_eq, &eq_len);
+
+    str_int getitem = {s256, 0};
+    spy_bench_run("str_getitem", bench_str_getitem, &getitem);
+
+    str_int slice_short = {s256, 8};
+    str_int slice_long = {s256, 200};
+    spy_bench_run("str_slice/8", bench_str_slice, &slice_short);
+    spy_bench_run("str_slice/200", bench_str_slice, &slice_long);
+}
+
+// the hash is cached in the header: we want to measure the computation
+static void bench_hash_bytes(void *ctx, int32_t iters) {
+    spy_Str *s = ctx;
+    uint64_t n = 0;
+    for (int32_t i = 0; i < iters; i++) {
+        spy_bench_escape(s);
+        n += spy_hash_bytes(s->utf8, s->length, 0);
+    }
+    spy_bench_escape(&n);
+}
+
+static void bench_str_hash(void) {
+    spy_bench_run("hash_bytes/8", bench_hash_bytes, make_str(8, 'a'));
+    spy_bench_run("hash_bytes/32", bench_hash_bytes, make_str(32, 'a'));
+    spy_bench_run("hash_bytes/4096", bench_hash_bytes, make_str(4096, 'a'));
+}
+
+/* ========== str -> number ========== */
+
+typedef struct {
+    spy_Str *items[4];
+} str_list;
+
+static void bench_str_to_i64(void *ctx, int32_t iters) {
+    str_list *p = ctx;
+    int64_t n = 0;
+    for (int32_t i = 0; i < iters; i++) {
+        spy_bench_escape(p);
+        n += spy_str_to_i64(p->items[i & 3]);
+    }
+    spy_bench_escape(&n);
+}
+
+static void bench_str_to_f64(void *ctx, int32_t iters) {
+    str_list *p = ctx;
+    double n = 0;
+    for (int32_t i = 0; i < iters; i++) {
+        spy_bench_escape(p);
+        n += spy_str_to_f64(p->items[i & 3]);
+    }
+    spy_bench_escape(&n);
+}
+
+static spy_Str *make_str_from(const char *s) {
+    size_t length = 0;
+    while (s[length])
+        length++;
+    spy_Str *res = spy_str_alloc(length);
+    char *buf = (char *)res->utf8;
+    for (size_t i = 0; i < length; i++)
+        buf[i] = s[i];
+    return res;
+}
+
+static void bench_strconv(void) {
+    str_list ints = {{
+        make_str_from("7"),
+        make_str_from("-12345"),
+        make_str_from("1234567890123"),
+        make_str_from("-9223372036854775807"),
+    }};
+    // the first two take Clinger's fast path, the others need Eisel-Lemire
+    str_list floats = {{
+        make_str_from("3.25"),
+        make_str_from("-0.000123"),
+        make_str_from("2.2250738585072014e-308"),
+        make_str_from("1.7976931348623157e308"),
+    }};
+    spy_bench_run("str_to_i64", bench_str_to_i64, &ints);
+    spy_bench_run("str_to_f64", bench_str_to_f64, &floats);
+}
+
+/* ========== utf-8 validation ========== */
+
+static void bench_utf8_validate(void *ctx, int32_t iters) {
+    spy_Str *s = ctx;
+    int32_t n = 0;
+    for (int32_t i = 0; i < iters; i++) {
+        spy_bench_escape(s);
+        n += spy_utf8_validate(s->utf8, s->length);
+    }
+    spy_bench_escape(&n);
+}
+
+static void bench_utf8(void) {
+    // 4000 bytes of ASCII, and of 1, 2, 3 and 4 bytes characters
+    static const char mixed[] = "a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80";
+    spy_Str *ascii = make_str(4000, 'a');
+    spy_Str *s = spy_str_alloc(4000);
+    for (size_t i = 0; i < 4000; i++)
+        ((char *)s->utf8)[i] = mixed[i % 10];
+    spy_bench_run("utf8_validate/4000/ascii", bench_utf8_validate, ascii);
+    spy_bench_run("utf8_validate/4000/mixed", bench_utf8_validate, s);
+}
+
+/* ========== io ========== */
+
+#ifndef SPY_TARGET_WASM32
+#include <stdio.h>
+#include <unistd.h>
+
+typedef struct {
+    spy_Str *path;
+    spy_Reader *r;
+} io_file;
+
+// read one line per iteration, starting again at EOF
+static void bench_io_readline(void *ctx, int32_t iters) {
+    io_file *f = ctx;
+    for (int32_t i = 0; i < iters; i++) {
+        spy_Str *line = spy_io$readline(f->r);
+        if (line->length == 0) {
+            spy_io$close_reader(f->r);
+            free(f->r);
+            f->r = spy_io$open_reader(f->path);
+            line = spy_io$readline(f->r);
+        }
+        spy_bench_escape(line);
+        free(line);
+    }
+}
+
+// reads of 4KB at random offsets, 64 at a time: one op per read
+static void bench_io_read_batch(void *ctx, int32_t iters) {
+    io_file *f = ctx;
+    spy_RawBuffer *rb = spy_rawbuffer$rb_alloc(64 * 4096);
+    spy_ReadBatch *b = spy_io$read_batch();
+    uint32_t x = 12345;
+    for (int32_t i = 0; i < iters; i++) {
+        x = x * 1103515245 + 12345;
+        int64_t offset = (x >> 8) % (80 * 65536 - 4096);
+        spy_io$submit_read(b, f->path, rb, (i % 64) * 4096, 4096, offset);
+        if (i % 64 == 63 || i == iters - 1)
+            spy_io$wait_all(b);
+    }
+    spy_io$close_batch(b);
+    spy_bench_escape(rb);
+    free(rb);
+}
+
+static void bench_io(void) {
+    char path[] = "/tmp/spybench_io_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return;
+    close(fd);
+    io_file f = {make_str_from(path), NULL};
+    // 64K lines of 80 bytes
+    spy_Writer *w = spy_io$open_writer(f.path);
+    spy_Str *line = make_str(80, 'a');
+    ((char *)line->utf8)[79] = '\n';
+    for (int32_t i = 0; i < 65536; i++)
+        spy_io$write(w, line);
+    spy_io$close_writer(w);
+    f.r = spy_io$open_reader(f.path);
+    spy_bench_run("io_readline/80", bench_io_readline, &f);
+    spy_io$close_reader(f.r);
+    spy_bench_run("io_read_batch/4096", bench_io_read_batch, &f);
+    setenv("SPY_IO_URING", "0", 1);
+    spy_bench_run("io_read_batch/4096/pool", bench_io_read_batch, &f);
+    unsetenv("SPY_IO_URING");
+    unlink(path);
+}
+#else
+static void bench_io(void) {}
+#endif
+
+/* ========== malloc/free ========== */
+
+static void bench_malloc_free(void *ctx, int32_t iters) {
+    size_t size = *(size_t *)ctx;
+    for (int32_t i = 0; i < iters; i++) {
+        void *p = malloc(size);
+        spy_bench_escape(p);
+        free(p);
+    }
+}
+
+#define BATCH 64
+
+// allocate BATCH objects before freeing them, so that the allocator cannot
+// just keep handing out the same block
+static void bench_malloc_free_batch(void *ctx, int32_t iters) {
+    size_t size = *(size_t *)ctx;
+    void *ptrs[BATCH];
+    for (int32_t i = 0; i < iters; i += BATCH) {
+        int32_t n = iters - i < BATCH ? iters - i : BATCH;
+        for (int32_t j = 0; j < n; j++) {
+            ptrs[j] = malloc(size);
+            spy_bench_escape(ptrs[j]);
+        }
+        for (int32_t j = 0; j < n; j++)
+            free(ptrs[j]);
+    }
+}
+
+static void bench_malloc(void) {
+    // 16..256 are served from walloc's small-object size classes, 1024 is
+    // a large object within a single page, 65536 spans multiple pages
+    static size_t sizes[] = {16, 64, 256, 1024, 65536};
+    static const char *names[] = {
+        "malloc_free/16", "malloc_free/64", "malloc_free/256",
+        "malloc_free/1024", "malloc_free/65536",
+    };
+    static const char *batch_names[] = {
+        "malloc_free_x64/16", "malloc_free_x64/64", "malloc_free_x64/256",
+        "malloc_free_x64/1024", "malloc_free_x64/65536",
+    };
+    for (int i = 0; i < 5; i++)
+        spy_bench_run(names[i], bench_malloc_free, &sizes[i]);
+    for (int i = 0; i < 5; i++)
+        spy_bench_run(batch_names[i], bench_malloc_free_batch, &sizes[i]);
+}
+
+/* ========== RawBuffer ========== */
+
+#define RB_SIZE 4096
+
+static void bench_rb_i32(void *ctx, int32_t iters) {
+    spy_RawBuffer *rb = ctx;
+    for (int32_t i = 0; i < iters; i++) {
+        int32_t offset = (i * 4) % RB_SIZE;
+        int32_t x = spy_rawbuffer$rb_get_i32(rb, offset);
+        spy_rawbuffer$rb_set_i32(rb, offset, x + 1);
+        spy_bench_escape(rb);
+    }
+}
+
+static void bench_rb_f64(void *ctx, int32_t iters) {
+    spy_RawBuffer *rb = ctx;
+    for (int32_t i = 0; i < iters; i++) {
+        int32_t offset = (i * 8) % RB_SIZE;
+        double x = spy_rawbuffer$rb_get_f64(rb, offset);
+        spy_rawbuffer$rb_set_f64(rb, offset, x + 1.0);
+        spy_bench_escape(rb);
+    }
+}
+
+static void bench_rawbuffer(void) {
+    spy_RawBuffer *rb = spy_rawbuffer$rb_alloc(RB_SIZE);
+    for (int32_t i = 0; i < RB_SIZE; i += 8)
+        spy_rawbuffer$rb_set_f64(rb, i, 0.0);
+    spy_bench_run("rawbuffer/get_set_i32", bench_rb_i32, rb);
+    spy_bench_run("rawbuffer/get_set_f64", bench_rb_f64, rb);
+}
+
+/* ========== memcmp ========== */
+
+static void bench_memcmp(void *ctx, int32_t iters) {
+    str_pair *p = ctx;
+    int32_t n = 0;
+    for (int32_t i = 0; i < iters; i++) {
+        spy_bench_escape(p);
+        n += memcmp(p->a->utf8, p->b->utf8, p->a->length);
+    }
+    spy_bench_escape(&n);
+}
+
+static void bench_libc(void) {
+    static size_t sizes[] = {16, 256, 4096};
+    static const char *names[] = {
+        "memcmp/16", "memcmp/256", "memcmp/4096",
+    };
+    for (int i = 0; i < 3; i++) {
+        str_pair p = {make_str(sizes[i], 'a'), make_str(sizes[i], 'a')};
+        spy_bench_run(names[i], bench_memcmp, &p);
+    }
+}
+
+void spy_bench_all(void) {
+    bench_str();
+    bench_str_hash();
+    bench_strconv();
+    bench_utf8();
+    bench_io();
+    bench_malloc();
+    bench_rawbuffer();
+    bench_libc();
+}
@@ -0,0 +1,165 @@
+#define _GNU_SOURCE
+#include "bench.h"
+
+#define MAX_REPS 1024
+#define MAX_ITERS (1 << 24)
+
+spy_bench_config spy_bench_cfg = {
+    .reps = 31,
+    .warmup = 3,
+    .target_ns = 200000.0, // 200 us per sample
+    .filter = NULL,
+};
+
+static double samples[MAX_REPS];
+
+static bool contains(const char *s, const char *sub) {
+    for (; *s; s++) {
+        const char *a = s;
+        const char *b = sub;
+        while (*a && *b && *a == *b) {
+            a++;
+            b++;
+        }
+        if (!*b)
+            return true;
+    }
+    return !*sub;
+}
+
+// we cannot use qsort on wasm32-freestanding, and the arrays are small
+static void sort(double *xs, int32_t n) {
+    for (int32_t i = 1; i < n; i++) {
+        double x = xs[i];
+        int32_t j = i - 1;
+        while (j >= 0 && xs[j] > x) {
+            xs[j+1] = xs[j];
+            j--;
+        }
+        xs[j+1] = x;
+    }
+}
+
+static double percentile(double *sorted, int32_t n, int32_t p) {
+    int32_t i = (p * (n - 1) + 50) / 100;
+    return sorted[i];
+}
+
+static double time_sample(spy_bench_fn fn, void *ctx, int32_t iters) {
+    double start = spy_bench_now_ns();
+    fn(ctx, iters);
+    return spy_bench_now_ns() - start;
+}
+
+void spy_bench_run(const char *name, spy_bench_fn fn, void *ctx) {
+    if (spy_bench_cfg.filter && !contains(name, spy_bench_cfg.filter))
+        return;
+
+    int32_t reps = spy_bench_cfg.reps;
+    if (reps < 1)
+        reps = 1;
+    if (reps > MAX_REPS)
+        reps = MAX_REPS;
+
+    // calibration: double iters until a sample is long enough
+    int32_t iters = 1;
+    while (iters < MAX_ITERS &&
+           time_sample(fn, ctx, iters) < spy_bench_cfg.target_ns)
+        iters *= 2;
+
+    for (int32_t i = 0; i < spy_bench_cfg.warmup; i++)
+        fn(ctx, iters);
+
+    for (int32_t i = 0; i < reps; i++)
+        samples[i] = time_sample(fn, ctx, iters) / iters;
+
+    sort(samples, reps);
+    spy_bench_report(name, iters, reps,
+                     samples[0],
+                     percentile(samples, reps, 50),
+                     percentile(samples, reps, 90),
+                     percentile(samples, reps, 99),
+                     samples[reps-1]);
+}
+
+#if defined(SPY_TARGET_WASM32)
+
+void WASM_EXPORT(spy_bench_main)(int32_t reps, int32_t warmup) {
+    spy_bench_cfg.reps = reps;
+    spy_bench_cfg.warmup = warmup;
+    spy_bench_all();
+}
+
+#else
+
+#include <stdio.h>
+#include <time.h>
+#if defined(__linux__)
+#  include <sched.h>
+#endif
+
+double spy_bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+void spy_bench_report(const char *name, int32_t iters, int32_t reps,
+                      double min, double p50, double p90, double p99,
+                      double max) {
+    printf("%-28s %9d %5d %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+           name, iters, reps, min, p50, p90, p99, max);
+    fflush(stdout);
+}
+
+static void pin_cpu(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0)
+        perror("sched_setaffinity");
+#else
+    (void)cpu;
+    fprintf(stderr, "warning: CPU pinning not supported on this platform\n");
+#endif
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [-c CPU] [-r REPS] [-w WARMUP] [-t TARGET_NS] [FILTER]\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (arg[0] == '-' && i+1 < argc) {
+            const char *val = argv[++i];
+            switch (arg[1]) {
+            case 'c': pin_cpu(atoi(val)); break;
+            case 'r': spy_bench_cfg.reps = atoi(val); break;
+            case 'w': spy_bench_cfg.warmup = atoi(val); break;
+            case 't': spy_bench_cfg.target_ns = atof(val); break;
+            default:
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg[0] == '-') {
+            usage(argv[0]);
+            return 1;
+        }
+        else {
+            spy_bench_cfg.filter = arg;
+        }
+    }
+
+    printf("%-28s %9s %5s %10s %10s %10s %10s %10s\n",
+           "benchmark (ns/op)", "iters", "reps",
+           "min", "p50", "p90", "p99", "max");
+    spy_bench_all();
+    return 0;
+}
+
+#endif /* defined(SPY_TARGET_WASM32) */
@@ -0,0 +1,55 @@
+"""
+Run the libspy microbenchmarks compiled for wasm32.
+
+The benchmarks are the same as the native ones, but the clock and the
+reporting are provided by this host. Usage:
+
+    python bench/run_wasm.py build/wasm32/spybench.wasm [-c CPU] [-r REPS] [-w WARMUP]
+"""
+
+import sys
+import os
+import time
+import argparse
+import pathlib
+sys.path.insert(0, str(pathlib.Path(__file__).resolve().parents[3]))
+
+import py.path
+from spy.llwasm import LLWasmModule, HostModule
+from spy.libspy import LLSPyInstance
+
+
+class BenchHost(HostModule):
+
+    def _read_str(self, ptr: int) -> str:
+        return self.ll.mem.read_cstr(ptr).decode('utf-8')
+
+    def env_spy_bench_now_ns(self) -> float:
+        return float(time.perf_counter_ns())
+
+    def env_spy_bench_report(self, name: int, iters: int, reps: int,
+                             min: float, p50: float, p90: float, p99: float,
+                             max: float) -> None:
+        print(f'{self._read_str(name):<28} {iters:9d} {reps:5d} '
+              f'{min:10.2f} {p50:10.2f} {p90:10.2f} {p99:10.2f} {max:10.2f}',
+              flush=True)
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser()
+    parser.add_argument('wasm')
+    parser.add_argument('-c', '--cpu', type=int, default=None)
+    parser.add_argument('-r', '--reps', type=int, default=31)
+    parser.add_argument('-w', '--warmup', type=int, default=3)
+    args = parser.parse_args()
+    if args.cpu is not None:
+        os.sched_setaffinity(0, {args.cpu})
+    llmod = LLWasmModule(py.path.local(args.wasm))
+    ll = LLSPyInstance(llmod, [BenchHost()])
+    print(f'{"benchmark (ns/op)":<28} {"iters":>9} {"reps":>5} '
+          f'{"min":>10} {"p50":>10} {"p90":>10} {"p99":>10} {"max":>10}')
+    ll.call('spy_bench_main', args.reps, args.warmup)
+
+
+if __name__ == '__main__':
+    main()
@@ -43,9 +43,19 @@ void *malloc(size_t size);
 void free(void *p);
 
 #include "spy/builtins.h"
+#include "spy/numeric.h"
 #include "spy/str.h"
+#include "spy/strconv.h"
+#include "spy/utf8.h"
+#include "spy/hash.h"
 #include "spy/gc.h"
+#include "spy/simd.h"
+#include "spy/math.h"
 #include "spy/rawbuffer.h"
 #include "spy/debug.h"
+#include "spy/parallel.h"
+#include "spy/task.h"
+#include "spy/atomic.h"
+#include "spy/io.h"
 
 #endif /* SPY_H */
@@ -0,0 +1,41 @@
+#ifndef SPY_AIO_H
+#define SPY_AIO_H
+
+#include "spy.h"
+
+// Batched file reads, used by the ReadBatch of the `io` module.
+//
+// The reads are identified by their index in the batch. They are queued by
+// spy_aio_submit and handed to the kernel in groups: on Linux, a batch owns
+// an io_uring, so that a single io_uring_enter() submits all the queued
+// reads and reaps the completed ones. If io_uring is not available (old
+// kernels, seccomp filters, or SPY_IO_URING=0 in the environment), each read
+// is a pread() which runs as a task of the spawn() thread pool.
+//
+// A read fills its buffer and is shorter only at EOF. spy_aio_submit opens
+// the file, and the batch closes it as soon as the read is complete. A batch
+// keeps a bounded number of files open, so submitting more reads than the
+// file descriptor limit waits for the older ones instead of failing.
+
+#ifndef SPY_TARGET_WASM32
+
+typedef struct spy_ReadBatch spy_ReadBatch;
+
+spy_ReadBatch *spy_aio_batch_new(void);
+int32_t spy_aio_submit(spy_ReadBatch *b, const char *path, char *buf,
+                       size_t size, int64_t offset);
+
+// Return the index of a completed read which has not been returned yet, in
+// order of completion, or -1 if all the reads have been returned
+int32_t spy_aio_wait_any(spy_ReadBatch *b);
+void spy_aio_wait_all(spy_ReadBatch *b);
+
+// Wait for the given read and return the number of bytes which were read
+int32_t spy_aio_result(spy_ReadBatch *b, int32_t id);
+
+// Wait for all the reads and release the resources of the batch
+void spy_aio_batch_close(spy_ReadBatch *b);
+
+#endif /* SPY_TARGET_WASM32 */
+
+#endif /* SPY_AIO_H */
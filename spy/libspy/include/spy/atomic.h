@@ -0,0 +1,129 @@
+#ifndef SPY_ATOMIC_H
+#define SPY_ATOMIC_H
+
+#include "spy.h"
+
+// Support for the `atomic` module.
+//
+// All the operations are sequentially consistent. They use the __atomic
+// builtins, which become C11-style atomics on the native target, and wasm
+// atomic instructions when compiling for wasm with -matomics (without it,
+// wasm is single-threaded and they become plain loads and stores).
+
+typedef struct {
+    int32_t value;
+} spy_AtomicI32;
+
+static inline spy_AtomicI32 *
+spy_atomic$atomic_i32(int32_t value) {
+    spy_AtomicI32 *a = (spy_AtomicI32 *)spy_GcAlloc(sizeof(spy_AtomicI32)).p;
+    a->value = value;
+    return a;
+}
+
+static inline int32_t
+spy_atomic$atomic_load_i32(spy_AtomicI32 *a) {
+    return __atomic_load_n(&a->value, __ATOMIC_SEQ_CST);
+}
+
+static inline void
+spy_atomic$atomic_store_i32(spy_AtomicI32 *a, int32_t value) {
+    __atomic_store_n(&a->value, value, __ATOMIC_SEQ_CST);
+}
+
+static inline bool
+spy_atomic$atomic_cas_i32(spy_AtomicI32 *a, int32_t expected,
+                          int32_t desired) {
+    return __atomic_compare_exchange_n(&a->value, &expected, desired, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static inline int32_t
+spy_atomic$atomic_fetch_add_i32(spy_AtomicI32 *a, int32_t delta) {
+    return __atomic_fetch_add(&a->value, delta, __ATOMIC_SEQ_CST);
+}
+
+// Bounded channels. The items are stored in 8-byte slots, so the same ring
+// buffer works for all the item types. There are two kinds:
+//
+//   - SPSC (one sender, one receiver): a Lamport ring buffer. Each side
+//     caches the index of the other, so that it touches the shared cache
+//     line only when the ring looks full (resp. empty).
+//
+//   - MPMC: Dmitry Vyukov's bounded queue. Each slot has a sequence number
+//     which tells whether it is ready to be written or read, so senders and
+//     receivers only contend on their own index.
+//
+// The capacity is rounded up to the next power of two. spy_channel_send and
+// spy_channel_recv spin, then yield, until they succeed. On the targets
+// without threads nobody else could ever make progress, so they panic
+// instead.
+
+typedef union {
+    int32_t i32;
+    double f64;
+} spy_ChannelItem;
+
+typedef struct spy_Channel spy_Channel;
+
+spy_Channel *spy_channel_new(int32_t capacity, bool mpmc);
+bool spy_channel_try_send(spy_Channel *ch, spy_ChannelItem item);
+bool spy_channel_try_recv(spy_Channel *ch, spy_ChannelItem *item);
+void spy_channel_send(spy_Channel *ch, spy_ChannelItem item);
+spy_ChannelItem spy_channel_recv(spy_Channel *ch);
+
+static inline spy_Channel *
+spy_atomic$spsc_i32(int32_t capacity) {
+    return spy_channel_new(capacity, false);
+}
+
+static inline spy_Channel *
+spy_atomic$mpmc_i32(int32_t capacity) {
+    return spy_channel_new(capacity, true);
+}
+
+static inline void
+spy_atomic$ch_send_i32(spy_Channel *ch, int32_t x) {
+    spy_ChannelItem item = {.i32 = x};
+    spy_channel_send(ch, item);
+}
+
+static inline bool
+spy_atomic$ch_try_send_i32(spy_Channel *ch, int32_t x) {
+    spy_ChannelItem item = {.i32 = x};
+    return spy_channel_try_send(ch, item);
+}
+
+static inline int32_t
+spy_atomic$ch_recv_i32(spy_Channel *ch) {
+    return spy_channel_recv(ch).i32;
+}
+
+static inline spy_Channel *
+spy_atomic$spsc_f64(int32_t capacity) {
+    return spy_channel_new(capacity, false);
+}
+
+static inline spy_Channel *
+spy_atomic$mpmc_f64(int32_t capacity) {
+    return spy_channel_new(capacity, true);
+}
+
+static inline void
+spy_atomic$ch_send_f64(spy_Channel *ch, double x) {
+    spy_ChannelItem item = {.f64 = x};
+    spy_channel_send(ch, item);
+}
+
+static inline bool
+spy_atomic$ch_try_send_f64(spy_Channel *ch, double x) {
+    spy_ChannelItem item = {.f64 = x};
+    return spy_channel_try_send(ch, item);
+}
+
+static inline double
+spy_atomic$ch_recv_f64(spy_Channel *ch) {
+    return spy_channel_recv(ch).f64;
+}
+
+#endif /* SPY_ATOMIC_H */
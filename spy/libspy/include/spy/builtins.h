@@ -10,6 +10,11 @@ WASM_EXPORT(spy_builtins$abs)(int32_t x);
 int32_t
 WASM_EXPORT(spy_builtins$abs)(int32_t x);
 
+static inline int64_t
+spy_builtins$hash(spy_Str *s) {
+    return spy_str_hash(s);
+}
+
 #ifndef SPY_TARGET_WASM32
 void spy_builtins$print_i32(int32_t x);
 void spy_builtins$print_f64(double x);
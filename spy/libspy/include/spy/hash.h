@@ -0,0 +1,11 @@
+#ifndef SPY_HASH_H
+#define SPY_HASH_H
+
+#include "spy.h"
+
+// Fast non-cryptographic hash of buf[0:n], see src/hash.c. The result is
+// the same on all targets.
+uint64_t
+spy_hash_bytes(const char *buf, size_t n, uint64_t seed);
+
+#endif /* SPY_HASH_H */
@@ -0,0 +1,78 @@
+#ifndef SPY_IO_H
+#define SPY_IO_H
+
+#include "spy.h"
+#include "spy/str.h"
+#include "spy/rawbuffer.h"
+#include "spy/aio.h"
+
+// Support for the `io` module, see spy/vm/modules/io.py.
+//
+// Readers and writers own a buffer of SPY_IO_BUFSIZE bytes, so that the
+// kernel sees few large read() and write() calls. readline looks for the
+// newline with memchr over the buffered data; reads and writes which are at
+// least as large as the buffer bypass it.
+//
+// A ReadBatch reads many files, or many regions of a file, concurrently:
+// see spy/aio.h.
+//
+// The module needs a filesystem, so it is available only on the native
+// target. The exception is read_stream, which reads from the streams of the
+// host: file descriptors on the native target, and streams provided by the
+// embedder through the spy_host_read import on wasm32.
+
+int32_t spy_io$read_stream(int32_t stream, spy_RawBuffer *rb, int32_t offset,
+                           int32_t size);
+
+#ifdef SPY_TARGET_WASM32
+/***** WASM imports, must be provided by the host *****/
+// Read from the given stream into buf until it is full or EOF. Return the
+// number of bytes which were read, or -1 if the stream doesn't exist.
+int32_t spy_host_read(int32_t stream, char *buf, int32_t size);
+/***** end of WASM imports *****/
+#endif
+
+#ifndef SPY_TARGET_WASM32
+
+#define SPY_IO_BUFSIZE (64 * 1024)
+
+typedef struct {
+    int fd;
+    // buf[pos:end] contains the data which has been read from the file but
+    // not consumed yet
+    size_t pos;
+    size_t end;
+    char buf[SPY_IO_BUFSIZE];
+} spy_Reader;
+
+typedef struct {
+    int fd;
+    size_t length;
+    char buf[SPY_IO_BUFSIZE];
+} spy_Writer;
+
+spy_Reader *spy_io$open_reader(spy_Str *path);
+spy_Str *spy_io$readline(spy_Reader *r);
+int32_t spy_io$read(spy_Reader *r, spy_RawBuffer *rb, int32_t offset,
+                    int32_t size);
+void spy_io$close_reader(spy_Reader *r);
+
+spy_Writer *spy_io$open_writer(spy_Str *path);
+void spy_io$write(spy_Writer *w, spy_Str *s);
+void spy_io$write_rb(spy_Writer *w, spy_RawBuffer *rb, int32_t offset,
+                     int32_t size);
+void spy_io$flush(spy_Writer *w);
+void spy_io$close_writer(spy_Writer *w);
+
+// ReadBatch is a spy_ReadBatch, see spy/aio.h
+spy_ReadBatch *spy_io$read_batch(void);
+int32_t spy_io$submit_read(spy_ReadBatch *b, spy_Str *path, spy_RawBuffer *rb,
+                           int32_t offset, int32_t size, int64_t file_offset);
+int32_t spy_io$wait_any(spy_ReadBatch *b);
+void spy_io$wait_all(spy_ReadBatch *b);
+int32_t spy_io$read_result(spy_ReadBatch *b, int32_t id);
+void spy_io$close_batch(spy_ReadBatch *b);
+
+#endif /* SPY_TARGET_WASM32 */
+
+#endif /* SPY_IO_H */
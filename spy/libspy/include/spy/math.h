@@ -0,0 +1,64 @@
+#ifndef SPY_MATH_H
+#define SPY_MATH_H
+
+#include "spy.h"
+
+// The `math` module, see spy/vm/modules/math.py.
+//
+// We use the compiler builtins, which become a single instruction whenever
+// the target has one: e.g. on wasm32 sqrt, floor, ceil, trunc, fabs and
+// copysign are f64.sqrt & co. On native, __builtin_sqrt might still call
+// libm to set errno for negative inputs, which is why we link with -lm.
+//
+// fma is an instruction only on some CPUs: in the other cases it is a call
+// to libm. On wasm32 we don't have a libm, so src/libc.c provides one.
+
+static inline double
+spy_math$sqrt(double x) {
+    return __builtin_sqrt(x);
+}
+
+static inline double
+spy_math$floor(double x) {
+    return __builtin_floor(x);
+}
+
+static inline double
+spy_math$ceil(double x) {
+    return __builtin_ceil(x);
+}
+
+static inline double
+spy_math$trunc(double x) {
+    return __builtin_trunc(x);
+}
+
+static inline double
+spy_math$fabs(double x) {
+    return __builtin_fabs(x);
+}
+
+static inline double
+spy_math$copysign(double x, double y) {
+    return __builtin_copysign(x, y);
+}
+
+// we don't use fmin/fmax because of their nan semantics, which most CPUs
+// don't implement in a single instruction: these become minsd/maxsd on
+// x86_64
+static inline double
+spy_math$min(double a, double b) {
+    return a < b ? a : b;
+}
+
+static inline double
+spy_math$max(double a, double b) {
+    return a > b ? a : b;
+}
+
+static inline double
+spy_math$fma(double a, double b, double c) {
+    return __builtin_fma(a, b, c);
+}
+
+#endif /* SPY_MATH_H */
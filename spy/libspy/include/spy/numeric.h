@@ -0,0 +1,84 @@
+#ifndef SPY_NUMERIC_H
+#define SPY_NUMERIC_H
+
+#include "spy.h"
+
+// Arithmetic on i8, u8, i16, u16 and i64, see opimpl_numeric.py.
+//
+// The C backend emits most of the numeric opimpls as plain C operators, but
+// it cannot do that for these types:
+//
+//   - the types which are smaller than int are promoted to int, so the
+//     result doesn't wrap around and the multiplication of two u16 can even
+//     overflow a signed int, which is undefined behavior;
+//
+//   - the overflow of signed types is undefined behavior, while SPy wraps
+//     around.
+//
+// So add, sub and mul are computed in an unsigned type U and then truncated.
+//
+// Moreover, integer division rounds towards negative infinity, as in the
+// interpreter, while C truncates towards zero: e.g. -7 / 2 is -4. MIN / -1
+// wraps around to MIN, instead of trapping.
+
+#define SPY_WRAPPING_OPS(NAME, T, U)                                \
+    static inline T spy_operator$##NAME##_add(T a, T b) {           \
+        return (T)((U)a + (U)b);                                    \
+    }                                                               \
+    static inline T spy_operator$##NAME##_sub(T a, T b) {           \
+        return (T)((U)a - (U)b);                                    \
+    }                                                               \
+    static inline T spy_operator$##NAME##_mul(T a, T b) {           \
+        return (T)((U)a * (U)b);                                    \
+    }
+
+#define SPY_FLOOR_DIV(NAME, T, U)                                   \
+    static inline T spy_operator$##NAME##_div(T a, T b) {           \
+        if (b == -1)                                                \
+            return (T)(0 - (U)a);                                   \
+        T q = (T)(a / b);                                           \
+        if (a % b != 0 && (a < 0) != (b < 0))                       \
+            q--;                                                    \
+        return q;                                                   \
+    }
+
+#define SPY_UNSIGNED_DIV(NAME, T)                                   \
+    static inline T spy_operator$##NAME##_div(T a, T b) {           \
+        return (T)(a / b);                                          \
+    }
+
+SPY_WRAPPING_OPS(i8, int8_t, uint32_t)
+SPY_FLOOR_DIV(i8, int8_t, uint32_t)
+SPY_WRAPPING_OPS(u8, uint8_t, uint32_t)
+SPY_UNSIGNED_DIV(u8, uint8_t)
+SPY_WRAPPING_OPS(i16, int16_t, uint32_t)
+SPY_FLOOR_DIV(i16, int16_t, uint32_t)
+SPY_WRAPPING_OPS(u16, uint16_t, uint32_t)
+SPY_UNSIGNED_DIV(u16, uint16_t)
+SPY_WRAPPING_OPS(i64, int64_t, uint64_t)
+SPY_FLOOR_DIV(i64, int64_t, uint64_t)
+
+// 64x64 -> 128 bit multiplication, used by libspy: return the low half and
+// store the high half in *hi. On wasm32 there is no instruction for it and
+// __int128 would need the __multi3 helper from compiler-rt, so we compute
+// it from 32-bit halves, which is what __multi3 would do anyway.
+static inline uint64_t
+spy_umul128(uint64_t a, uint64_t b, uint64_t *hi) {
+#if defined(__SIZEOF_INT128__) && !defined(__wasm__)
+    __uint128_t r = (__uint128_t)a * b;
+    *hi = (uint64_t)(r >> 64);
+    return (uint64_t)r;
+#else
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+    *hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    return (cross << 32) | (uint32_t)lo_lo;
+#endif
+}
+
+#endif /* SPY_NUMERIC_H */
@@ -0,0 +1,38 @@
+#ifndef SPY_PARALLEL_H
+#define SPY_PARALLEL_H
+
+#include "spy.h"
+
+// Support for `for i in parallel_range(n)`.
+//
+// The C backend outlines the body of the loop into a function which executes
+// the iterations [start, end), and calls spy_parallel_for to distribute
+// them. On the native target, the iterations are executed by a pool of
+// pthreads, which is started lazily. On the other targets, and for nested
+// loops, spy_parallel_for just runs all the iterations in the calling
+// thread.
+
+typedef void (*spy_parallel_body)(void *env, int32_t start, int32_t end);
+
+#define SPY_SCHEDULE_STATIC  0  // one contiguous block per thread
+#define SPY_SCHEDULE_DYNAMIC 1  // fixed-size chunks, taken on demand
+#define SPY_SCHEDULE_GUIDED  2  // shrinking chunks, taken on demand
+
+void spy_parallel_for(int32_t n, int32_t schedule, spy_parallel_body body,
+                      void *env);
+
+// The outlined function holds this lock while it merges its partial
+// reductions into env.
+void spy_parallel_reduce_lock(void);
+void spy_parallel_reduce_unlock(void);
+
+// Number of threads used by spy_parallel_for, including the caller. It can
+// be set with the SPY_NUM_THREADS env variable; the default is the number of
+// CPUs.
+int32_t spy_parallel_num_threads(void);
+
+// The value of SPY_NUM_THREADS, or the number of CPUs. It is also used to size
+// the pool of spy_task_spawn.
+int32_t spy_default_num_threads(void);
+
+#endif /* SPY_PARALLEL_H */
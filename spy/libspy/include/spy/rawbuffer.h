@@ -45,5 +45,67 @@ spy_rawbuffer$rb_get_f64(spy_RawBuffer *rb, int32_t offset) {
     return *p;
 }
 
+// the other numeric types. We use memcpy so that it is fine to read the
+// same bytes with different types, which would break strict aliasing
+
+#define SPY_RB_ACCESSORS(NAME, T)                                       \
+    static inline void                                                  \
+    spy_rawbuffer$rb_set_##NAME(spy_RawBuffer *rb, int32_t offset, T val) { \
+        memcpy((char *)rb->buf + offset, &val, sizeof(T));              \
+    }                                                                   \
+    static inline T                                                     \
+    spy_rawbuffer$rb_get_##NAME(spy_RawBuffer *rb, int32_t offset) {    \
+        T val;                                                          \
+        memcpy(&val, rb->buf + offset, sizeof(T));                      \
+        return val;                                                     \
+    }
+
+SPY_RB_ACCESSORS(i8, int8_t)
+SPY_RB_ACCESSORS(u8, uint8_t)
+SPY_RB_ACCESSORS(i16, int16_t)
+SPY_RB_ACCESSORS(u16, uint16_t)
+SPY_RB_ACCESSORS(u32, uint32_t)
+SPY_RB_ACCESSORS(i64, int64_t)
+SPY_RB_ACCESSORS(u64, uint64_t)
+SPY_RB_ACCESSORS(f32, float)
+
+// SIMD vectors: the offset doesn't need to be aligned, so we use memcpy,
+// which the compiler turns into a single unaligned load or store
+
+static inline void
+spy_rawbuffer$rb_set_f64x2(spy_RawBuffer *rb, int32_t offset, spy_f64x2 val) {
+    memcpy((char *)rb->buf + offset, &val, sizeof(val));
+}
+
+static inline spy_f64x2
+spy_rawbuffer$rb_get_f64x2(spy_RawBuffer *rb, int32_t offset) {
+    spy_f64x2 val;
+    memcpy(&val, rb->buf + offset, sizeof(val));
+    return val;
+}
+
+static inline void
+spy_rawbuffer$rb_set_f32x4(spy_RawBuffer *rb, int32_t offset, spy_f32x4 val) {
+    memcpy((char *)rb->buf + offset, &val, sizeof(val));
+}
+
+static inline spy_f32x4
+spy_rawbuffer$rb_get_f32x4(spy_RawBuffer *rb, int32_t offset) {
+    spy_f32x4 val;
+    memcpy(&val, rb->buf + offset, sizeof(val));
+    return val;
+}
+
+static inline void
+spy_rawbuffer$rb_set_i32x4(spy_RawBuffer *rb, int32_t offset, spy_i32x4 val) {
+    memcpy((char *)rb->buf + offset, &val, sizeof(val));
+}
+
+static inline spy_i32x4
+spy_rawbuffer$rb_get_i32x4(spy_RawBuffer *rb, int32_t offset) {
+    spy_i32x4 val;
+    memcpy(&val, rb->buf + offset, sizeof(val));
+    return val;
+}
 
 #endif /* SPY_RAW_BUFFER_H */
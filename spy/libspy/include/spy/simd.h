@@ -0,0 +1,90 @@
+#ifndef SPY_SIMD_H
+#define SPY_SIMD_H
+
+#include "spy.h"
+#include "spy/debug.h"  // for spy_panic
+
+// SIMD vector types, see spy/vm/simd.py.
+//
+// They are implemented with the GCC/clang vector extensions, which support
+// the arithmetic operators lane-wise and v[i] to read a lane: the C backend
+// emits them directly. The compiler lowers them to SSE2 on x86_64, NEON on
+// aarch64 and simd128 on wasm32, when compiled with -msimd128.
+
+typedef double spy_f64x2 __attribute__((vector_size(16)));
+typedef float spy_f32x4 __attribute__((vector_size(16)));
+typedef int32_t spy_i32x4 __attribute__((vector_size(16)));
+
+static inline double
+spy_operator$f64x2_getitem(spy_f64x2 v, int32_t i) {
+    if ((uint32_t)i >= 2)
+        spy_panic("vector index out of bounds");
+    return v[i];
+}
+
+static inline double
+spy_operator$f32x4_getitem(spy_f32x4 v, int32_t i) {
+    if ((uint32_t)i >= 4)
+        spy_panic("vector index out of bounds");
+    return v[i];
+}
+
+static inline int32_t
+spy_operator$i32x4_getitem(spy_i32x4 v, int32_t i) {
+    if ((uint32_t)i >= 4)
+        spy_panic("vector index out of bounds");
+    return v[i];
+}
+
+static inline spy_f64x2
+spy_simd$make_f64x2(double a, double b) {
+    return (spy_f64x2){a, b};
+}
+
+static inline spy_f64x2
+spy_simd$splat_f64x2(double x) {
+    return (spy_f64x2){x, x};
+}
+
+static inline double
+spy_simd$sum_f64x2(spy_f64x2 v) {
+    return v[0] + v[1];
+}
+
+static inline spy_f32x4
+spy_simd$make_f32x4(double a, double b, double c, double d) {
+    return (spy_f32x4){(float)a, (float)b, (float)c, (float)d};
+}
+
+static inline spy_f32x4
+spy_simd$splat_f32x4(double x) {
+    float f = (float)x;
+    return (spy_f32x4){f, f, f, f};
+}
+
+static inline double
+spy_simd$sum_f32x4(spy_f32x4 v) {
+    float lo = v[0] + v[1];
+    float hi = v[2] + v[3];
+    return lo + hi;
+}
+
+static inline spy_i32x4
+spy_simd$make_i32x4(int32_t a, int32_t b, int32_t c, int32_t d) {
+    return (spy_i32x4){a, b, c, d};
+}
+
+static inline spy_i32x4
+spy_simd$splat_i32x4(int32_t x) {
+    return (spy_i32x4){x, x, x, x};
+}
+
+static inline int32_t
+spy_simd$sum_i32x4(spy_i32x4 v) {
+    // wrap around on overflow
+    uint32_t res = (uint32_t)v[0] + (uint32_t)v[1] +
+                   (uint32_t)v[2] + (uint32_t)v[3];
+    return (int32_t)res;
+}
+
+#endif /* SPY_SIMD_H */
@@ -4,14 +4,45 @@
 #include <stddef.h>
 #include "spy.h"
 
-typedef struct {
+// A string is either "flat", i.e. it owns its utf-8 data, or a view into the
+// data of another string, see spy_str_slice. In both cases utf8 points to the
+// first byte: flat strings allocated by spy_str_alloc store the data right
+// after the header, while prebuilt strings point to a C string literal.
+typedef struct spy_Str {
     size_t length;
-    const char utf8[];
+    const char *utf8;
+    // for views, the flat string which owns the data and which must be kept
+    // alive as long as the view. NULL for flat strings
+    const struct spy_Str *parent;
+    uint32_t flags;
+    uint64_t hash;  // valid only if SPY_STR_HASHED is set
 } spy_Str;
 
+// The data is known to be valid utf-8. It is set by the functions which
+// create strings from untrusted bytes, after validating them, and it is
+// propagated by the operations which cannot break it (e.g., the
+// concatenation of two valid strings is valid). When it is not set the
+// string has simply not been checked: see spy_str_is_valid_utf8.
+#define SPY_STR_VALID_UTF8 1
+
+// The hash has been computed and cached, see spy_str_hash
+#define SPY_STR_HASHED 2
+
+// Allocate a string whose data will be filled by the caller: the flags are
+// 0, because we don't know what will be written
 spy_Str *
 WASM_EXPORT(spy_str_alloc)(size_t length);
 
+// Create a string from bytes which come from the outside world, e.g. a file
+// or the host: panic if they are not valid utf-8
+spy_Str *
+WASM_EXPORT(spy_str_from_utf8)(const char *buf, size_t length);
+
+// Check whether s is valid utf-8. The result is cached in the flags, so each
+// string is validated at most once
+bool
+WASM_EXPORT(spy_str_is_valid_utf8)(spy_Str *s);
+
 spy_Str *
 WASM_EXPORT(spy_str_add)(spy_Str *a, spy_Str *b);
 
@@ -26,14 +57,109 @@ spy_str_ne(spy_Str *a, spy_Str *b) {
     return !spy_str_eq(a, b);
 }
 
+// Three-way comparison: return a value <0, 0 or >0. Comparing the utf-8
+// bytes gives the same order as comparing the code points. The C backend
+// lowers `a < b` & co. to `spy_str_cmp(a, b) < 0`, see CFuncWriter
+static inline int32_t
+spy_str_cmp(spy_Str *a, spy_Str *b) {
+    size_t n = a->length < b->length ? a->length : b->length;
+    int res = memcmp(a->utf8, b->utf8, n);
+    if (res != 0)
+        return res;
+    // one is a prefix of the other: the shorter comes first
+    return (a->length > b->length) - (a->length < b->length);
+}
+
+// The hash of a string, i.e. `hash(s)`. It is computed by spy_hash_bytes with
+// a fixed seed, so that it is reproducible across runs and backends, and it
+// is cached in the header
+int64_t
+WASM_EXPORT(spy_str_hash)(spy_Str *s);
+
 // XXX: should we introduce a separate type Char?
 spy_Str *
 WASM_EXPORT(spy_str_getitem)(spy_Str *s, int32_t i);
 
+// s[start:stop], with the same semantics as Python for negative and out of
+// bound indexes. The indexes are offsets in the utf-8 representation
+spy_Str *
+WASM_EXPORT(spy_str_slice)(spy_Str *s, int32_t start, int32_t stop);
+
+// s.split(sep). The pieces are found lazily, the first time that somebody
+// asks for the length or for an item, and each item is created only when
+// requested, as a slice of s. See str.c
+typedef struct {
+    spy_Str *s;
+    spy_Str *sep;
+    int32_t length;   // the number of pieces, or -1 if not computed yet
+    int32_t *starts;  // the offset in s of each piece
+} spy_StrSplit;
+
+spy_StrSplit *
+WASM_EXPORT(spy_str_split)(spy_Str *s, spy_Str *sep);
+
+int32_t
+WASM_EXPORT(spy_StrSplit_length)(spy_StrSplit *sp);
+
+spy_Str *
+WASM_EXPORT(spy_StrSplit_getitem)(spy_StrSplit *sp, int32_t i);
+
+// sep.join(items): both compute the length of the result first, then do
+// exactly one allocation
+spy_Str *
+WASM_EXPORT(spy_str_join)(spy_Str *sep, spy_Str **items, int32_t n);
+
+spy_Str *
+WASM_EXPORT(spy_str_join_split)(spy_Str *sep, spy_StrSplit *sp);
+
+// Substring search: the indexes are offsets in the utf-8 representation.
+// See str.c for the algorithm
+int32_t
+WASM_EXPORT(spy_str_find)(spy_Str *s, spy_Str *sub);
+
+int32_t
+WASM_EXPORT(spy_str_count)(spy_Str *s, spy_Str *sub);
+
+static inline bool
+spy_str_startswith(spy_Str *s, spy_Str *prefix) {
+    return (s->length >= prefix->length &&
+            memcmp(s->utf8, prefix->utf8, prefix->length) == 0);
+}
+
+static inline bool
+spy_str_endswith(spy_Str *s, spy_Str *suffix) {
+    if (s->length < suffix->length)
+        return false;
+    size_t start = s->length - suffix->length;
+    return memcmp(s->utf8 + start, suffix->utf8, suffix->length) == 0;
+}
+
+// `sub in s`
+static inline bool
+spy_str_in(spy_Str *sub, spy_Str *s) {
+    return spy_str_find(s, sub) >= 0;
+}
+
+static inline bool
+spy_str_not_in(spy_Str *sub, spy_Str *s) {
+    return spy_str_find(s, sub) < 0;
+}
+
 #define spy_operator$str_add spy_str_add
 #define spy_operator$str_mul spy_str_mul
 #define spy_operator$str_eq  spy_str_eq
 #define spy_operator$str_ne  spy_str_ne
 #define spy_operator$str_getitem spy_str_getitem
+#define spy_operator$str_slice spy_str_slice
+#define spy_operator$str_find spy_str_find
+#define spy_operator$str_count spy_str_count
+#define spy_operator$str_startswith spy_str_startswith
+#define spy_operator$str_endswith spy_str_endswith
+#define spy_operator$str_split spy_str_split
+#define spy_operator$str_join_split spy_str_join_split
+#define spy_operator$StrSplit_length spy_StrSplit_length
+#define spy_operator$StrSplit_getitem spy_StrSplit_getitem
+#define spy_operator$str_in spy_str_in
+#define spy_operator$str_not_in spy_str_not_in
 
 #endif /* SPY_STR_H */
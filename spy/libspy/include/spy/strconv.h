@@ -0,0 +1,24 @@
+#ifndef SPY_STRCONV_H
+#define SPY_STRCONV_H
+
+#include "spy.h"
+
+// Conversions from str to numbers, i.e. `i32(s)`, `i64(s)` and `f64(s)`. See
+// src/strconv.c for the algorithms.
+//
+// The syntax is the same as Python's int() and float(), apart from the
+// underscores and the non-ASCII digits, which are not supported. Leading and
+// trailing whitespace is ignored. Invalid strings and integers which don't
+// fit in the target type cause a panic. Floats which are too large become
+// inf, like in Python.
+
+int32_t
+WASM_EXPORT(spy_str_to_i32)(spy_Str *s);
+
+int64_t
+WASM_EXPORT(spy_str_to_i64)(spy_Str *s);
+
+double
+WASM_EXPORT(spy_str_to_f64)(spy_Str *s);
+
+#endif /* SPY_STRCONV_H */
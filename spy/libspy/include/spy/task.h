@@ -0,0 +1,30 @@
+#ifndef SPY_TASK_H
+#define SPY_TASK_H
+
+#include "spy.h"
+
+// Support for `spawn(f, *args)` and `join(task)`.
+//
+// The C backend emits a trampoline for each spawned function, which reads
+// the arguments from an env struct and stores the result in its first
+// field. spy_task_spawn copies the env into the task. Once the task is
+// finished, spy_task_join copies the first result_size bytes of the env to
+// *result and frees the task: each task must be joined exactly once.
+//
+// On the native target, tasks are executed by a pool of worker threads,
+// which is started lazily. Each worker owns a Chase-Lev deque: it pushes and
+// pops the tasks that it spawns at the bottom, while idle workers steal from
+// the top. The tasks spawned by the other threads go to a shared injection
+// queue. A thread which joins an unfinished task does not block: it keeps
+// running other tasks until the one it is waiting for is done.
+//
+// On the other targets, spy_task_spawn runs the task immediately.
+
+typedef void (*spy_task_fn)(void *env);
+
+typedef struct spy_Task spy_Task;
+
+spy_Task *spy_task_spawn(spy_task_fn fn, const void *env, size_t env_size);
+void spy_task_join(spy_Task *task, void *result, size_t result_size);
+
+#endif /* SPY_TASK_H */
@@ -0,0 +1,12 @@
+#ifndef SPY_UTF8_H
+#define SPY_UTF8_H
+
+#include "spy.h"
+
+// Return true if buf[0:n] is valid utf-8, i.e. it doesn't contain overlong
+// encodings, surrogates, code points > U+10FFFF or truncated sequences. See
+// src/utf8.c for the algorithm.
+bool
+WASM_EXPORT(spy_utf8_validate)(const char *buf, size_t n);
+
+#endif /* SPY_UTF8_H */
@@ -0,0 +1,461 @@
+#include "spy.h"
+
+#ifndef SPY_TARGET_WASM32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef SPY_TARGET_NATIVE
+#  include <linux/io_uring.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  define HAVE_IO_URING
+#endif
+
+// number of entries of the submission queue: it is also the maximum number
+// of reads which are in flight at the same time
+#define URING_ENTRIES 256
+
+// maximum number of files that a batch keeps open: spy_aio_submit waits for
+// the older reads before opening more
+#define MAX_OPEN_FILES 256
+
+typedef struct spy_ReadReq spy_ReadReq;
+struct spy_ReadReq {
+    int32_t id;
+    // closed as soon as the read is complete, before finish()
+    int fd;
+    char *buf;
+    size_t size;
+    int64_t offset;
+    int32_t result;
+    // set by the owner of the batch when it sees that the read is complete
+    bool finished;
+    spy_Task *task;
+    // link in the pool_done stack
+    spy_ReadReq *next;
+};
+
+#ifdef HAVE_IO_URING
+typedef struct {
+    int fd;
+    unsigned entries;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+    void *sq_ptr;
+    void *cq_ptr;
+    size_t sq_size;
+    size_t cq_size;
+    size_t sqes_size;
+} spy_Uring;
+#endif
+
+struct spy_ReadBatch {
+    spy_ReadReq **reqs;
+    int32_t n;
+    int32_t capacity;
+    // the indexes of the finished reads, in order of completion:
+    // completed[:n_returned] have been returned by spy_aio_wait_any
+    int32_t *completed;
+    int32_t n_completed;
+    int32_t n_returned;
+    // reqs[:first_unfinished] are all finished
+    int32_t first_unfinished;
+    bool closed;
+    bool use_uring;
+    // the reads which have been completed by the thread pool but not
+    // finished yet, most recent first. The workers push with a CAS, the
+    // owner takes the whole stack at once.
+    spy_ReadReq *pool_done;
+#ifdef HAVE_IO_URING
+    spy_Uring ring;
+    // reqs[next_queued:] are not in the submission queue yet
+    int32_t next_queued;
+    // the entries which are in the submission queue, but have not been
+    // consumed by the kernel yet
+    unsigned to_submit;
+    int32_t in_flight;
+#endif
+};
+
+// Read until buf is full or EOF, and return the number of bytes read
+static size_t pread_all(int fd, char *buf, size_t size, int64_t offset) {
+    size_t n = 0;
+    while (n < size) {
+        ssize_t k = pread(fd, buf + n, size - n, (off_t)(offset + n));
+        if (k < 0) {
+            if (errno == EINTR)
+                continue;
+            spy_panic("read error");
+        }
+        if (k == 0)
+            break;
+        n += (size_t)k;
+    }
+    return n;
+}
+
+static void finish(spy_ReadBatch *b, int32_t id) {
+    spy_ReadReq *req = b->reqs[id];
+    req->finished = true;
+    b->completed[b->n_completed++] = id;
+    while (b->first_unfinished < b->n &&
+           b->reqs[b->first_unfinished]->finished)
+        b->first_unfinished++;
+}
+
+/* ========== io_uring ========== */
+
+#ifdef HAVE_IO_URING
+
+static bool uring_enabled(void) {
+    const char *s = getenv("SPY_IO_URING");
+    return s == NULL || strcmp(s, "0") != 0;
+}
+
+static bool uring_init(spy_Uring *u) {
+    struct io_uring_params p;
+    __builtin_memset(&p, 0, sizeof(p));
+    int fd = (int)syscall(__NR_io_uring_setup, URING_ENTRIES, &p);
+    if (fd < 0)
+        return false;
+    u->fd = fd;
+    u->entries = p.sq_entries;
+    u->sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    u->cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    u->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    // since Linux 5.4 the two rings share the same mapping
+    bool single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap && u->cq_size > u->sq_size)
+        u->sq_size = u->cq_size;
+    u->sq_ptr = mmap(NULL, u->sq_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (u->sq_ptr == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    if (single_mmap)
+        u->cq_ptr = u->sq_ptr;
+    else {
+        u->cq_ptr = mmap(NULL, u->cq_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (u->cq_ptr == MAP_FAILED) {
+            munmap(u->sq_ptr, u->sq_size);
+            close(fd);
+            return false;
+        }
+    }
+    u->sqes = mmap(NULL, u->sqes_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED) {
+        if (!single_mmap)
+            munmap(u->cq_ptr, u->cq_size);
+        munmap(u->sq_ptr, u->sq_size);
+        close(fd);
+        return false;
+    }
+    char *sq = u->sq_ptr;
+    char *cq = u->cq_ptr;
+    u->sq_head = (unsigned *)(sq + p.sq_off.head);
+    u->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    u->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    u->sq_array = (unsigned *)(sq + p.sq_off.array);
+    u->cq_head = (unsigned *)(cq + p.cq_off.head);
+    u->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    u->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    u->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return true;
+}
+
+// Setting up a ring costs as much as dozens of reads, so each thread keeps
+// the ring of the last closed batch for the next one. A closed batch has
+// no reads in flight, so the ring is idle.
+static __thread spy_Uring cached_ring;
+static __thread bool have_cached_ring = false;
+
+static void uring_free(spy_Uring *u) {
+    munmap(u->sqes, u->sqes_size);
+    if (u->cq_ptr != u->sq_ptr)
+        munmap(u->cq_ptr, u->cq_size);
+    munmap(u->sq_ptr, u->sq_size);
+    close(u->fd);
+}
+
+// Move the queued reads to the submission queue. We never have more reads
+// in flight than entries, so that the completion queue cannot overflow.
+static void uring_push(spy_ReadBatch *b) {
+    spy_Uring *u = &b->ring;
+    unsigned mask = *u->sq_mask;
+    unsigned tail = *u->sq_tail;
+    unsigned head = __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE);
+    while (b->next_queued < b->n && tail - head < u->entries &&
+           b->in_flight < (int32_t)u->entries) {
+        int32_t id = b->next_queued++;
+        spy_ReadReq *req = b->reqs[id];
+        struct io_uring_sqe *sqe = &u->sqes[tail & mask];
+        __builtin_memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = req->fd;
+        sqe->addr = (uint64_t)(uintptr_t)req->buf;
+        sqe->len = (uint32_t)req->size;
+        sqe->off = (uint64_t)req->offset;
+        sqe->user_data = (uint64_t)id;
+        u->sq_array[tail & mask] = tail & mask;
+        tail++;
+        b->to_submit++;
+        b->in_flight++;
+    }
+    __atomic_store_n(u->sq_tail, tail, __ATOMIC_RELEASE);
+}
+
+static void uring_reap(spy_ReadBatch *b) {
+    spy_Uring *u = &b->ring;
+    unsigned mask = *u->cq_mask;
+    unsigned head = *u->cq_head;
+    unsigned tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; head++) {
+        struct io_uring_cqe *cqe = &u->cqes[head & mask];
+        int32_t id = (int32_t)cqe->user_data;
+        spy_ReadReq *req = b->reqs[id];
+        int32_t res = cqe->res;
+        // errors (including the kernels which don't know IORING_OP_READ)
+        // and short reads are completed synchronously: pread_all panics if
+        // there is a real error
+        if (res < 0)
+            res = (int32_t)pread_all(req->fd, req->buf, req->size,
+                                     req->offset);
+        else if (res > 0 && (size_t)res < req->size)
+            res += (int32_t)pread_all(req->fd, req->buf + res,
+                                      req->size - res, req->offset + res);
+        req->result = res;
+        close(req->fd);
+        req->fd = -1;
+        b->in_flight--;
+        finish(b, id);
+    }
+    __atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+}
+
+// Submit the queued reads and reap the completed ones. If wait is true,
+// block until at least one read is complete.
+static void uring_progress(spy_ReadBatch *b, bool wait) {
+    uring_push(b);
+    unsigned min_complete = wait ? 1 : 0;
+    unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+    if (b->to_submit > 0 || wait) {
+        int ret = (int)syscall(__NR_io_uring_enter, b->ring.fd, b->to_submit,
+                               min_complete, flags, NULL, 0);
+        if (ret < 0) {
+            // EAGAIN and EBUSY mean that the kernel is short of resources
+            // or that the completion queue is full: reaping makes progress
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                spy_panic("io_uring_enter failed");
+        }
+        else
+            b->to_submit -= (unsigned)ret;
+    }
+    uring_reap(b);
+}
+
+#endif /* HAVE_IO_URING */
+
+/* ========== thread pool ========== */
+
+typedef struct {
+    spy_ReadBatch *b;
+    spy_ReadReq *req;
+} spy_ReadTaskEnv;
+
+static void read_task(void *env) {
+    spy_ReadBatch *b = ((spy_ReadTaskEnv *)env)->b;
+    spy_ReadReq *req = ((spy_ReadTaskEnv *)env)->req;
+    req->result = (int32_t)pread_all(req->fd, req->buf, req->size,
+                                     req->offset);
+    close(req->fd);
+    req->fd = -1;
+    // publish the result to the owner
+    spy_ReadReq *head = __atomic_load_n(&b->pool_done, __ATOMIC_RELAXED);
+    do {
+        req->next = head;
+    } while (!__atomic_compare_exchange_n(&b->pool_done, &head, req, true,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+// Finish the reads which are done. If wait is true and there are none,
+// block until the oldest unfinished one is done: it is pushed to pool_done
+// before its task is marked as done.
+static void pool_progress(spy_ReadBatch *b, bool wait) {
+    spy_ReadReq *req = __atomic_exchange_n(&b->pool_done, NULL,
+                                           __ATOMIC_ACQUIRE);
+    if (req == NULL && wait && b->first_unfinished < b->n) {
+        spy_ReadReq *oldest = b->reqs[b->first_unfinished];
+        spy_task_join(oldest->task, NULL, 0);
+        oldest->task = NULL;
+        req = __atomic_exchange_n(&b->pool_done, NULL, __ATOMIC_ACQUIRE);
+    }
+    // the stack is most recent first: reverse it to finish the reads in
+    // order of completion
+    spy_ReadReq *ordered = NULL;
+    while (req != NULL) {
+        spy_ReadReq *next = req->next;
+        req->next = ordered;
+        ordered = req;
+        req = next;
+    }
+    for (req = ordered; req != NULL; req = req->next) {
+        // the task is done as soon as read_task returns: join it to free it
+        if (req->task != NULL) {
+            spy_task_join(req->task, NULL, 0);
+            req->task = NULL;
+        }
+        finish(b, req->id);
+    }
+}
+
+/* ========== ReadBatch ========== */
+
+static void progress(spy_ReadBatch *b, bool wait) {
+#ifdef HAVE_IO_URING
+    if (b->use_uring) {
+        uring_progress(b, wait);
+        return;
+    }
+#endif
+    pool_progress(b, wait);
+}
+
+spy_ReadBatch *
+spy_aio_batch_new(void) {
+    spy_ReadBatch *b = (spy_ReadBatch *)spy_GcAlloc(sizeof(spy_ReadBatch)).p;
+    __builtin_memset(b, 0, sizeof(spy_ReadBatch));
+#ifdef HAVE_IO_URING
+    if (uring_enabled()) {
+        if (have_cached_ring) {
+            b->ring = cached_ring;
+            have_cached_ring = false;
+            b->use_uring = true;
+        }
+        else
+            b->use_uring = uring_init(&b->ring);
+    }
+#endif
+    return b;
+}
+
+// Open the file of a new read. If we run out of file descriptors, wait for
+// the reads which are in progress, which close theirs.
+static int open_for_read(spy_ReadBatch *b, const char *path) {
+    for (;;) {
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd >= 0)
+            return fd;
+        if (errno == EINTR)
+            continue;
+        if ((errno == EMFILE || errno == ENFILE) && b->n_completed < b->n) {
+            progress(b, true);
+            continue;
+        }
+        spy_panic("cannot open file");
+    }
+}
+
+int32_t
+spy_aio_submit(spy_ReadBatch *b, const char *path, char *buf, size_t size,
+               int64_t offset) {
+    if (b->closed)
+        spy_panic("I/O operation on closed batch");
+    while (b->n - b->n_completed >= MAX_OPEN_FILES)
+        progress(b, true);
+    int fd = open_for_read(b, path);
+    if (b->n == b->capacity) {
+        b->capacity = b->capacity ? b->capacity * 2 : 64;
+        b->reqs = realloc(b->reqs, b->capacity * sizeof(spy_ReadReq *));
+        b->completed = realloc(b->completed, b->capacity * sizeof(int32_t));
+    }
+    int32_t id = b->n;
+    spy_ReadReq *req = malloc(sizeof(spy_ReadReq));
+    req->id = id;
+    req->fd = fd;
+    req->buf = buf;
+    req->size = size;
+    req->offset = offset;
+    req->result = 0;
+    req->finished = false;
+    req->task = NULL;
+    req->next = NULL;
+    b->reqs[id] = req;
+    b->n++;
+#ifdef HAVE_IO_URING
+    if (b->use_uring) {
+        // keep the kernel busy once we have enough reads for a full batch
+        if (b->n - b->next_queued >= (int32_t)b->ring.entries)
+            uring_progress(b, false);
+        return id;
+    }
+#endif
+    spy_ReadTaskEnv env = {b, req};
+    req->task = spy_task_spawn(read_task, &env, sizeof(env));
+    return id;
+}
+
+int32_t
+spy_aio_wait_any(spy_ReadBatch *b) {
+    while (b->n_returned == b->n_completed) {
+        if (b->n_completed == b->n)
+            return -1;
+        progress(b, true);
+    }
+    return b->completed[b->n_returned++];
+}
+
+void
+spy_aio_wait_all(spy_ReadBatch *b) {
+    while (b->n_completed < b->n)
+        progress(b, true);
+}
+
+int32_t
+spy_aio_result(spy_ReadBatch *b, int32_t id) {
+    if (id < 0 || id >= b->n)
+        spy_panic("invalid read id");
+    while (!b->reqs[id]->finished)
+        progress(b, true);
+    return b->reqs[id]->result;
+}
+
+void
+spy_aio_batch_close(spy_ReadBatch *b) {
+    if (b->closed)
+        return;
+    spy_aio_wait_all(b);
+#ifdef HAVE_IO_URING
+    if (b->use_uring) {
+        if (have_cached_ring)
+            uring_free(&b->ring);
+        else {
+            cached_ring = b->ring;
+            have_cached_ring = true;
+        }
+    }
+#endif
+    for (int32_t id = 0; id < b->n; id++)
+        free(b->reqs[id]);
+    free(b->reqs);
+    free(b->completed);
+    b->reqs = NULL;
+    b->completed = NULL;
+    b->n = 0;
+    b->n_completed = 0;
+    b->n_returned = 0;
+    b->first_unfinished = 0;
+    b->closed = true;
+}
+
+#endif /* SPY_TARGET_WASM32 */
@@ -0,0 +1,168 @@
+#include "spy.h"
+
+#if defined(SPY_TARGET_NATIVE)
+#  include <sched.h>
+#endif
+
+typedef struct {
+    uint64_t seq;          // MPMC only, see spy_channel_try_send
+    spy_ChannelItem item;
+} spy_ChannelSlot;
+
+// the fields which are written by the senders and by the receivers live on
+// different cache lines
+struct spy_Channel {
+    uint64_t mask;         // number of slots - 1
+    uint64_t capacity;     // MPMC only, see spy_channel_new
+    bool mpmc;
+    spy_ChannelSlot *slots;
+    char pad0[64];
+    uint64_t tail;         // next slot to write
+    uint64_t head_cache;   // SPSC only: last value of head seen by the sender
+    char pad1[64];
+    uint64_t head;         // next slot to read
+    uint64_t tail_cache;   // SPSC only: last value of tail seen by the receiver
+    char pad2[64];
+};
+
+spy_Channel *spy_channel_new(int32_t capacity, bool mpmc) {
+    if (capacity <= 0)
+        spy_panic("invalid channel capacity");
+    uint64_t size = 1;
+    while (size < (uint64_t)capacity)
+        size *= 2;
+    spy_Channel *ch = (spy_Channel *)spy_GcAlloc(sizeof(spy_Channel)).p;
+    ch->capacity = size;
+    // with a single slot, the seq of a full slot (pos+1) would be equal to
+    // the next pos, and MPMC senders would overwrite it: use two slots and
+    // check the capacity in mpmc_try_send
+    if (mpmc && size < 2)
+        size = 2;
+    ch->mask = size - 1;
+    ch->tail = ch->head_cache = 0;
+    ch->head = ch->tail_cache = 0;
+    ch->mpmc = mpmc;
+    ch->slots = (spy_ChannelSlot *)spy_GcAlloc(size * sizeof(spy_ChannelSlot)).p;
+    for (uint64_t i = 0; i < size; i++)
+        ch->slots[i].seq = i;
+    return ch;
+}
+
+static bool spsc_try_send(spy_Channel *ch, spy_ChannelItem item) {
+    uint64_t tail = __atomic_load_n(&ch->tail, __ATOMIC_RELAXED);
+    if (tail - ch->head_cache > ch->mask) {
+        ch->head_cache = __atomic_load_n(&ch->head, __ATOMIC_ACQUIRE);
+        if (tail - ch->head_cache > ch->mask)
+            return false;
+    }
+    ch->slots[tail & ch->mask].item = item;
+    __atomic_store_n(&ch->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool spsc_try_recv(spy_Channel *ch, spy_ChannelItem *item) {
+    uint64_t head = __atomic_load_n(&ch->head, __ATOMIC_RELAXED);
+    if (head == ch->tail_cache) {
+        ch->tail_cache = __atomic_load_n(&ch->tail, __ATOMIC_ACQUIRE);
+        if (head == ch->tail_cache)
+            return false;
+    }
+    *item = ch->slots[head & ch->mask].item;
+    __atomic_store_n(&ch->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// A slot whose seq is equal to pos can be written by the sender which
+// claims pos; then its seq becomes pos+1, and it can be read by the receiver
+// which claims pos. After the read, its seq becomes pos+capacity, i.e. it's
+// ready for the next round.
+static bool mpmc_try_send(spy_Channel *ch, spy_ChannelItem item) {
+    uint64_t pos = __atomic_load_n(&ch->tail, __ATOMIC_RELAXED);
+    for (;;) {
+        spy_ChannelSlot *slot = &ch->slots[pos & ch->mask];
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t)(seq - pos);
+        if (diff == 0) {
+            if (ch->capacity <= ch->mask &&
+                pos - __atomic_load_n(&ch->head, __ATOMIC_ACQUIRE) >=
+                    ch->capacity)
+                return false;  // full, although there is a free slot
+            if (__atomic_compare_exchange_n(&ch->tail, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                slot->item = item;
+                __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+            // else: pos has been updated by the failed CAS, retry
+        }
+        else if (diff < 0) {
+            return false;  // full
+        }
+        else {
+            pos = __atomic_load_n(&ch->tail, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static bool mpmc_try_recv(spy_Channel *ch, spy_ChannelItem *item) {
+    uint64_t pos = __atomic_load_n(&ch->head, __ATOMIC_RELAXED);
+    for (;;) {
+        spy_ChannelSlot *slot = &ch->slots[pos & ch->mask];
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t)(seq - (pos + 1));
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ch->head, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                *item = slot->item;
+                __atomic_store_n(&slot->seq, pos + ch->mask + 1,
+                                 __ATOMIC_RELEASE);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            return false;  // empty
+        }
+        else {
+            pos = __atomic_load_n(&ch->head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+bool spy_channel_try_send(spy_Channel *ch, spy_ChannelItem item) {
+    if (ch->mpmc)
+        return mpmc_try_send(ch, item);
+    return spsc_try_send(ch, item);
+}
+
+bool spy_channel_try_recv(spy_Channel *ch, spy_ChannelItem *item) {
+    if (ch->mpmc)
+        return mpmc_try_recv(ch, item);
+    return spsc_try_recv(ch, item);
+}
+
+static void backoff(int32_t *spins, const char *panic_msg) {
+#if defined(SPY_TARGET_NATIVE)
+    (void)panic_msg;
+    if (++*spins > 64)
+        sched_yield();
+#else
+    (void)spins;
+    spy_panic(panic_msg);
+#endif
+}
+
+void spy_channel_send(spy_Channel *ch, spy_ChannelItem item) {
+    int32_t spins = 0;
+    while (!spy_channel_try_send(ch, item))
+        backoff(&spins, "send on a full channel would block forever");
+}
+
+spy_ChannelItem spy_channel_recv(spy_Channel *ch) {
+    spy_ChannelItem item;
+    int32_t spins = 0;
+    while (!spy_channel_try_recv(ch, &item))
+        backoff(&spins, "recv on an empty channel would block forever");
+    return item;
+}
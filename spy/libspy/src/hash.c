@@ -0,0 +1,98 @@
+#include "spy.h"
+
+// We use wyhash by Wang Yi (final version 4), which is public domain: it
+// is one of the fastest hashes that pass SMHasher, and it is simple. It
+// needs a 64x64 -> 128 bit multiplication, which is a single instruction on
+// x86_64 and aarch64 and a few on wasm32, see spy_umul128.
+//
+// The result depends only on the bytes and on the seed, so a string has
+// the same hash on all targets and in the interpreter, which calls the
+// wasm32 version of libspy.
+
+static const uint64_t wyp[4] = {
+    0x2d358dccaa6c78a5, 0x8bb84b93962eacc9,
+    0x4b33a62ed433d4a3, 0x4d5a2da51de1aa47,
+};
+
+static inline void
+wymum(uint64_t *a, uint64_t *b) {
+    uint64_t hi;
+    *a = spy_umul128(*a, *b, &hi);
+    *b = hi;
+}
+
+static inline uint64_t
+wymix(uint64_t a, uint64_t b) {
+    wymum(&a, &b);
+    return a ^ b;
+}
+
+// little endian reads: all our targets are little endian
+static inline uint64_t
+wyr8(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t
+wyr4(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+// 1, 2 or 3 bytes
+static inline uint64_t
+wyr3(const uint8_t *p, size_t k) {
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+}
+
+uint64_t
+spy_hash_bytes(const char *buf, size_t n, uint64_t seed) {
+    const uint8_t *p = (const uint8_t *)buf;
+    seed ^= wymix(seed ^ wyp[0], wyp[1]);
+    uint64_t a, b;
+    if (n <= 16) {
+        if (n >= 4) {
+            // two overlapping reads of 4 bytes from each side
+            size_t mid = (n >> 3) << 2;
+            a = (wyr4(p) << 32) | wyr4(p + mid);
+            b = (wyr4(p + n - 4) << 32) | wyr4(p + n - 4 - mid);
+        }
+        else if (n > 0) {
+            a = wyr3(p, n);
+            b = 0;
+        }
+        else {
+            a = b = 0;
+        }
+    }
+    else {
+        size_t i = n;
+        if (i >= 48) {
+            // three independent lanes, to use the multipliers in parallel
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ seed);
+                see1 = wymix(wyr8(p + 16) ^ wyp[2], wyr8(p + 24) ^ see1);
+                see2 = wymix(wyr8(p + 32) ^ wyp[3], wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        // the last 16 bytes, which might overlap with the previous ones
+        a = wyr8(p + i - 16);
+        b = wyr8(p + i - 8);
+    }
+    a ^= wyp[1];
+    b ^= seed;
+    wymum(&a, &b);
+    return wymix(a ^ wyp[0] ^ n, b ^ wyp[1]);
+}
@@ -0,0 +1,304 @@
+#include "spy.h"
+
+static void check_region(spy_RawBuffer *rb, int32_t offset, int32_t size) {
+    if (offset < 0 || size < 0 || (size_t)offset + size > rb->length)
+        spy_panic("RawBuffer region out of bounds");
+}
+
+#ifdef SPY_TARGET_WASM32
+
+int32_t
+spy_io$read_stream(int32_t stream, spy_RawBuffer *rb, int32_t offset,
+                   int32_t size) {
+    check_region(rb, offset, size);
+    // the host reads directly into the linear memory
+    int32_t n = spy_host_read(stream, (char *)rb->buf + offset, size);
+    if (n < 0)
+        spy_panic("invalid stream");
+    return n;
+}
+
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static void check_open(int fd) {
+    if (fd < 0)
+        spy_panic("I/O operation on closed file");
+}
+
+// spy_Str is not NUL-terminated: the result must be freed by the caller
+static char *c_path(spy_Str *path) {
+    char *cpath = malloc(path->length + 1);
+    memcpy(cpath, path->utf8, path->length);
+    cpath[path->length] = '\0';
+    return cpath;
+}
+
+static int open_path(spy_Str *path, int flags) {
+    char *cpath = c_path(path);
+    int fd = open(cpath, flags | O_CLOEXEC, 0666);
+    free(cpath);
+    if (fd < 0)
+        spy_panic("cannot open file");
+    return fd;
+}
+
+// Return the number of bytes which were read, 0 at EOF
+static size_t read_some(int fd, char *buf, size_t size) {
+    for (;;) {
+        ssize_t n = read(fd, buf, size);
+        if (n >= 0)
+            return (size_t)n;
+        if (errno != EINTR)
+            spy_panic("read error");
+    }
+}
+
+static void write_all(int fd, const char *buf, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, buf, size);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            spy_panic("write error");
+        }
+        buf += n;
+        size -= (size_t)n;
+    }
+}
+
+int32_t
+spy_io$read_stream(int32_t stream, spy_RawBuffer *rb, int32_t offset,
+                   int32_t size) {
+    check_region(rb, offset, size);
+    char *dst = (char *)rb->buf + offset;
+    size_t n = 0;
+    while (n < (size_t)size) {
+        ssize_t k = read(stream, dst + n, (size_t)size - n);
+        if (k < 0) {
+            if (errno == EINTR)
+                continue;
+            spy_panic(errno == EBADF ? "invalid stream" : "read error");
+        }
+        if (k == 0)
+            break;
+        n += (size_t)k;
+    }
+    return (int32_t)n;
+}
+
+/* ========== Reader ========== */
+
+spy_Reader *
+spy_io$open_reader(spy_Str *path) {
+    int fd = open_path(path, O_RDONLY);
+    spy_Reader *r = (spy_Reader *)spy_GcAlloc(sizeof(spy_Reader)).p;
+    r->fd = fd;
+    r->pos = 0;
+    r->end = 0;
+    return r;
+}
+
+spy_Str *
+spy_io$readline(spy_Reader *r) {
+    check_open(r->fd);
+    if (r->pos == r->end) {
+        r->pos = 0;
+        r->end = 0;
+    }
+    // the lines which don't fit in the buffer are accumulated here
+    char *line = NULL;
+    size_t length = 0;
+    // buf[pos:scan] doesn't contain a newline
+    size_t scan = r->pos;
+    size_t stop;
+    for (;;) {
+        char *nl = memchr(r->buf + scan, '\n', r->end - scan);
+        if (nl) {
+            stop = (size_t)(nl - r->buf) + 1;
+            break;
+        }
+        if (r->end == SPY_IO_BUFSIZE) {
+            // make room for the next read
+            if (r->pos == 0) {
+                line = realloc(line, length + r->end);
+                memcpy(line + length, r->buf, r->end);
+                length += r->end;
+                r->end = 0;
+            }
+            else {
+                memmove(r->buf, r->buf + r->pos, r->end - r->pos);
+                r->end -= r->pos;
+                r->pos = 0;
+            }
+        }
+        scan = r->end;
+        size_t n = read_some(r->fd, r->buf + r->end,
+                             SPY_IO_BUFSIZE - r->end);
+        if (n == 0) {
+            // EOF: the last line has no newline
+            stop = r->end;
+            break;
+        }
+        r->end += n;
+    }
+
+    char *start = r->buf + r->pos;
+    size_t n = stop - r->pos;
+    r->pos = stop;
+    if (line == NULL)
+        return spy_str_from_utf8(start, n);
+    line = realloc(line, length + n);
+    memcpy(line + length, start, n);
+    spy_Str *res = spy_str_from_utf8(line, length + n);
+    free(line);
+    return res;
+}
+
+int32_t
+spy_io$read(spy_Reader *r, spy_RawBuffer *rb, int32_t offset, int32_t size) {
+    check_open(r->fd);
+    check_region(rb, offset, size);
+    char *dst = (char *)rb->buf + offset;
+    size_t want = (size_t)size;
+    // first, the data which is already buffered
+    size_t n = r->end - r->pos;
+    if (n > want)
+        n = want;
+    memcpy(dst, r->buf + r->pos, n);
+    r->pos += n;
+    while (n < want) {
+        size_t k;
+        if (want - n >= SPY_IO_BUFSIZE) {
+            // large reads go directly into the RawBuffer
+            k = read_some(r->fd, dst + n, want - n);
+        }
+        else {
+            r->end = read_some(r->fd, r->buf, SPY_IO_BUFSIZE);
+            k = r->end < want - n ? r->end : want - n;
+            memcpy(dst + n, r->buf, k);
+            r->pos = k;
+        }
+        if (k == 0)
+            break;
+        n += k;
+    }
+    return (int32_t)n;
+}
+
+void
+spy_io$close_reader(spy_Reader *r) {
+    if (r->fd >= 0)
+        close(r->fd);
+    r->fd = -1;
+    r->pos = 0;
+    r->end = 0;
+}
+
+/* ========== Writer ========== */
+
+spy_Writer *
+spy_io$open_writer(spy_Str *path) {
+    int fd = open_path(path, O_WRONLY | O_CREAT | O_TRUNC);
+    spy_Writer *w = (spy_Writer *)spy_GcAlloc(sizeof(spy_Writer)).p;
+    w->fd = fd;
+    w->length = 0;
+    return w;
+}
+
+static void flush_buffer(spy_Writer *w) {
+    write_all(w->fd, w->buf, w->length);
+    w->length = 0;
+}
+
+// Like bufio.Writer in Go: fill the buffer before flushing it, so that
+// all the writes have the same size, unless the buffer is empty and the
+// data would not fit anyway
+static void writer_write(spy_Writer *w, const char *buf, size_t size) {
+    check_open(w->fd);
+    while (size > SPY_IO_BUFSIZE - w->length) {
+        if (w->length == 0) {
+            write_all(w->fd, buf, size);
+            return;
+        }
+        size_t n = SPY_IO_BUFSIZE - w->length;
+        memcpy(w->buf + w->length, buf, n);
+        w->length = SPY_IO_BUFSIZE;
+        buf += n;
+        size -= n;
+        flush_buffer(w);
+    }
+    memcpy(w->buf + w->length, buf, size);
+    w->length += size;
+}
+
+void
+spy_io$write(spy_Writer *w, spy_Str *s) {
+    writer_write(w, s->utf8, s->length);
+}
+
+void
+spy_io$write_rb(spy_Writer *w, spy_RawBuffer *rb, int32_t offset,
+                int32_t size) {
+    check_region(rb, offset, size);
+    writer_write(w, rb->buf + offset, (size_t)size);
+}
+
+void
+spy_io$flush(spy_Writer *w) {
+    check_open(w->fd);
+    flush_buffer(w);
+}
+
+void
+spy_io$close_writer(spy_Writer *w) {
+    if (w->fd < 0)
+        return;
+    flush_buffer(w);
+    close(w->fd);
+    w->fd = -1;
+}
+
+/* ========== ReadBatch ========== */
+
+spy_ReadBatch *
+spy_io$read_batch(void) {
+    return spy_aio_batch_new();
+}
+
+int32_t
+spy_io$submit_read(spy_ReadBatch *b, spy_Str *path, spy_RawBuffer *rb,
+                   int32_t offset, int32_t size, int64_t file_offset) {
+    check_region(rb, offset, size);
+    if (file_offset < 0)
+        spy_panic("negative file offset");
+    char *cpath = c_path(path);
+    int32_t id = spy_aio_submit(b, cpath, (char *)rb->buf + offset,
+                                (size_t)size, file_offset);
+    free(cpath);
+    return id;
+}
+
+int32_t
+spy_io$wait_any(spy_ReadBatch *b) {
+    return spy_aio_wait_any(b);
+}
+
+void
+spy_io$wait_all(spy_ReadBatch *b) {
+    spy_aio_wait_all(b);
+}
+
+int32_t
+spy_io$read_result(spy_ReadBatch *b, int32_t id) {
+    return spy_aio_result(b, id);
+}
+
+void
+spy_io$close_batch(spy_ReadBatch *b) {
+    spy_aio_batch_close(b);
+}
+
+#endif /* SPY_TARGET_WASM32 */
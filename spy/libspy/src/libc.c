@@ -1,13 +1,27 @@
 #include "spy.h"
 
+typedef unsigned char spy_u8x16 __attribute__((vector_size(16)));
+
 int memcmp(const void *s1, const void *s2, size_t n) {
     // it seems that __builtin_memcmp simply calls libc's memcmp (which we
-    // don't have), so we need to implement it by ourselves. Poor's man
-    // implementation here :(
+    // don't have), so we need to implement it by ourselves. We compare 16
+    // bytes at a time with simd128 until we find a block which differs,
+    // then we look for the first different byte inside it
     const unsigned char *b1 = s1;
     const unsigned char *b2 = s2;
+    size_t i = 0;
 
-    for (size_t i = 0; i < n; ++i) {
+    for (; i + 16 <= n; i += 16) {
+        spy_u8x16 x, y;
+        __builtin_memcpy(&x, b1 + i, 16);
+        __builtin_memcpy(&y, b2 + i, 16);
+        spy_u8x16 ne = (spy_u8x16)(x != y);
+        uint64_t halves[2];
+        __builtin_memcpy(halves, &ne, 16);
+        if ((halves[0] | halves[1]) != 0)
+            break;
+    }
+    for (; i < n; ++i) {
         if (b1[i] < b2[i]) {
             return -1;
         } else if (b1[i] > b2[i]) {
@@ -16,3 +30,61 @@ int memcmp(const void *s1, const void *s2, size_t n) {
     }
     return 0;
 }
+
+// fma() is needed by spy_math$fma, since wasm32 doesn't have an fma
+// instruction. We use the algorithm described in "Emulation of FMA and
+// correctly-rounded sums: proved algorithms using rounding to odd" (Boldo
+// and Melquiond, 2008), with Dekker's TwoProduct to compute a*b exactly.
+// The result is correctly rounded, unless a*b is so large that the
+// splitting overflows or so small that the error term is subnormal.
+#pragma STDC FP_CONTRACT OFF
+
+static void two_sum(double a, double b, double *s, double *e) {
+    *s = a + b;
+    double bb = *s - a;
+    *e = (a - (*s - bb)) + (b - bb);
+}
+
+static void split(double a, double *hi, double *lo) {
+    double c = 134217729.0 * a;  // 2**27 + 1
+    *hi = c - (c - a);
+    *lo = a - *hi;
+}
+
+static void two_prod(double a, double b, double *p, double *e) {
+    double ah, al, bh, bl;
+    *p = a * b;
+    split(a, &ah, &al);
+    split(b, &bh, &bl);
+    *e = ((ah * bh - *p) + ah * bl + al * bh) + al * bl;
+}
+
+// a + b, rounded to odd: if it is inexact, we pick the neighbour whose
+// last bit is 1
+static double add_round_to_odd(double a, double b) {
+    double s, e;
+    two_sum(a, b, &s, &e);
+    if (e != 0) {
+        uint64_t bits;
+        memcpy(&bits, &s, sizeof(s));
+        if ((bits & 1) == 0) {
+            // move towards the exact result, i.e. towards e
+            if ((e > 0) == (s > 0))
+                bits++;
+            else
+                bits--;
+            memcpy(&s, &bits, sizeof(s));
+        }
+    }
+    return s;
+}
+
+double fma(double a, double b, double c) {
+    double p = a * b;
+    if (p == 0 || !__builtin_isfinite(p) || !__builtin_isfinite(c))
+        return p + c;  // no rounding error to compensate for
+    double uh, ul, th, tl;
+    two_prod(a, b, &uh, &ul);
+    two_sum(c, uh, &th, &tl);
+    return th + add_round_to_odd(tl, ul);
+}
@@ -0,0 +1,214 @@
+#include "spy.h"
+
+#if !defined(SPY_TARGET_NATIVE)
+
+// no threads: run everything sequentially
+
+void spy_parallel_for(int32_t n, int32_t schedule, spy_parallel_body body,
+                      void *env) {
+    (void)schedule;
+    if (n > 0)
+        body(env, 0, n);
+}
+
+void spy_parallel_reduce_lock(void) {}
+void spy_parallel_reduce_unlock(void) {}
+
+int32_t spy_parallel_num_threads(void) {
+    return 1;
+}
+
+int32_t spy_default_num_threads(void) {
+    return 1;
+}
+
+#else
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define MAX_THREADS 256
+
+typedef struct {
+    spy_parallel_body body;
+    void *env;
+    int32_t n;
+    int32_t schedule;
+    int32_t chunk;   // chunk size for DYNAMIC, minimum chunk size for GUIDED
+    int64_t next;    // next iteration to hand out, for DYNAMIC and GUIDED
+} spy_ParallelJob;
+
+// The pool is a set of n_threads-1 workers, plus the thread which calls
+// spy_parallel_for. Each job is identified by a generation number: the
+// workers wait until the generation changes, execute their share of the job,
+// and decrement n_running. Only one job can run at a time, see job_lock.
+static struct {
+    pthread_mutex_t lock;        // protects generation and n_running
+    pthread_cond_t wakeup;       // a new job is available
+    pthread_cond_t finished;     // n_running dropped to 0
+    uint64_t generation;
+    int32_t n_running;
+    spy_ParallelJob job;
+    int32_t n_threads;
+    pthread_mutex_t job_lock;    // held while a job is running
+    pthread_mutex_t reduce_lock;
+} pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wakeup = PTHREAD_COND_INITIALIZER,
+    .finished = PTHREAD_COND_INITIALIZER,
+    .job_lock = PTHREAD_MUTEX_INITIALIZER,
+    .reduce_lock = PTHREAD_MUTEX_INITIALIZER,
+    .n_threads = 1,
+};
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+// true if the current thread is executing a job: nested loops run
+// sequentially
+static __thread bool in_parallel = false;
+
+static void run_share(spy_ParallelJob *job, int32_t tid) {
+    int32_t n = job->n;
+    int32_t n_threads = pool.n_threads;
+    if (job->schedule == SPY_SCHEDULE_STATIC) {
+        int32_t start = (int32_t)((int64_t)n * tid / n_threads);
+        int32_t end = (int32_t)((int64_t)n * (tid + 1) / n_threads);
+        if (start < end)
+            job->body(job->env, start, end);
+    }
+    else if (job->schedule == SPY_SCHEDULE_DYNAMIC) {
+        for (;;) {
+            int64_t start = __atomic_fetch_add(&job->next, job->chunk,
+                                               __ATOMIC_RELAXED);
+            if (start >= n)
+                break;
+            int64_t end = start + job->chunk;
+            if (end > n)
+                end = n;
+            job->body(job->env, (int32_t)start, (int32_t)end);
+        }
+    }
+    else {
+        // GUIDED: each chunk is a fraction of the remaining iterations
+        int64_t start = __atomic_load_n(&job->next, __ATOMIC_RELAXED);
+        for (;;) {
+            if (start >= n)
+                break;
+            int64_t size = (n - start) / (2 * n_threads);
+            if (size < job->chunk)
+                size = job->chunk;
+            if (size > n - start)
+                size = n - start;
+            if (__atomic_compare_exchange_n(&job->next, &start, start + size,
+                                            true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                job->body(job->env, (int32_t)start, (int32_t)(start + size));
+                start = __atomic_load_n(&job->next, __ATOMIC_RELAXED);
+            }
+            // else: start has been updated by the failed CAS, retry
+        }
+    }
+}
+
+static void *worker_main(void *arg) {
+    int32_t tid = (int32_t)(intptr_t)arg;
+    uint64_t seen = 0;
+    in_parallel = true;
+    for (;;) {
+        pthread_mutex_lock(&pool.lock);
+        while (pool.generation == seen)
+            pthread_cond_wait(&pool.wakeup, &pool.lock);
+        seen = pool.generation;
+        pthread_mutex_unlock(&pool.lock);
+
+        run_share(&pool.job, tid);
+
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.n_running == 0)
+            pthread_cond_signal(&pool.finished);
+        pthread_mutex_unlock(&pool.lock);
+    }
+    return NULL;
+}
+
+int32_t spy_default_num_threads(void) {
+    long n = 0;
+    const char *s = getenv("SPY_NUM_THREADS");
+    if (s != NULL)
+        n = atol(s);
+    if (n <= 0)
+        n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n <= 0)
+        n = 1;
+    if (n > MAX_THREADS)
+        n = MAX_THREADS;
+    return (int32_t)n;
+}
+
+static void pool_init(void) {
+    int32_t n = spy_default_num_threads();
+    // tid 0 is the caller of spy_parallel_for
+    int32_t n_threads = 1;
+    for (int32_t tid = 1; tid < n; tid++) {
+        pthread_t t;
+        if (pthread_create(&t, NULL, worker_main, (void *)(intptr_t)tid) != 0)
+            break;
+        pthread_detach(t);
+        n_threads++;
+    }
+    pool.n_threads = n_threads;
+}
+
+int32_t spy_parallel_num_threads(void) {
+    pthread_once(&pool_once, pool_init);
+    return pool.n_threads;
+}
+
+void spy_parallel_for(int32_t n, int32_t schedule, spy_parallel_body body,
+                      void *env) {
+    if (n <= 0)
+        return;
+    int32_t n_threads = spy_parallel_num_threads();
+    // run sequentially if it's not worth it, if we are inside another
+    // parallel loop, or if another thread is already using the pool
+    if (n == 1 || n_threads == 1 || in_parallel ||
+        pthread_mutex_trylock(&pool.job_lock) != 0) {
+        body(env, 0, n);
+        return;
+    }
+    in_parallel = true;
+    int32_t chunk = 1;
+    if (schedule == SPY_SCHEDULE_DYNAMIC) {
+        chunk = n / (n_threads * 16);
+        if (chunk < 1)
+            chunk = 1;
+    }
+    pool.job = (spy_ParallelJob){body, env, n, schedule, chunk, 0};
+
+    pthread_mutex_lock(&pool.lock);
+    pool.n_running = n_threads - 1;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.wakeup);
+    pthread_mutex_unlock(&pool.lock);
+
+    run_share(&pool.job, 0);
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.n_running > 0)
+        pthread_cond_wait(&pool.finished, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+
+    in_parallel = false;
+    pthread_mutex_unlock(&pool.job_lock);
+}
+
+void spy_parallel_reduce_lock(void) {
+    pthread_mutex_lock(&pool.reduce_lock);
+}
+
+void spy_parallel_reduce_unlock(void) {
+    pthread_mutex_unlock(&pool.reduce_lock);
+}
+
+#endif /* !defined(SPY_TARGET_NATIVE) */
@@ -5,9 +5,40 @@ spy_str_alloc(size_t length) {
     size_t size = sizeof(spy_Str) + length;
     spy_Str *res = (spy_Str*)spy_GcAlloc(size).p;
     res->length = length;
+    res->utf8 = (const char *)(res + 1);
+    res->parent = NULL;
+    res->flags = 0;
     return res;
 }
 
+// UTF-8 validity. The operations below set SPY_STR_VALID_UTF8 on their
+// result when it follows from the validity of the operands, so that strings
+// which are built from valid ones never need to be validated again.
+
+static inline uint32_t
+valid_utf8(const spy_Str *s) {
+    return s->flags & SPY_STR_VALID_UTF8;
+}
+
+spy_Str *
+spy_str_from_utf8(const char *buf, size_t length) {
+    if (!spy_utf8_validate(buf, length)) {
+        spy_panic("invalid utf-8");
+        return NULL;
+    }
+    spy_Str *res = spy_str_alloc(length);
+    memcpy((char *)res->utf8, buf, length);
+    res->flags = SPY_STR_VALID_UTF8;
+    return res;
+}
+
+bool
+spy_str_is_valid_utf8(spy_Str *s) {
+    if (!valid_utf8(s) && spy_utf8_validate(s->utf8, s->length))
+        s->flags |= SPY_STR_VALID_UTF8;
+    return valid_utf8(s);
+}
+
 spy_Str *
 spy_str_add(spy_Str *a, spy_Str *b) {
     size_t l = a->length + b->length;
@@ -15,6 +46,7 @@ spy_str_add(spy_Str *a, spy_Str *b) {
     char *buf = (char*)res->utf8;
     memcpy(buf, a->utf8, a->length);
     memcpy(buf + a->length, b->utf8, b->length);
+    res->flags = valid_utf8(a) & valid_utf8(b);
     return res;
 }
 
@@ -27,6 +59,7 @@ spy_str_mul(spy_Str *a, int32_t b) {
         memcpy(buf, a->utf8, a->length);
         buf += a->length;
     }
+    res->flags = valid_utf8(a);
     return res;
 }
 
@@ -37,6 +70,17 @@ spy_str_eq(spy_Str *a, spy_Str *b) {
     return memcmp(a->utf8, b->utf8, a->length) == 0;
 }
 
+#define SPY_STR_HASH_SEED 0
+
+int64_t
+spy_str_hash(spy_Str *s) {
+    if (!(s->flags & SPY_STR_HASHED)) {
+        s->hash = spy_hash_bytes(s->utf8, s->length, SPY_STR_HASH_SEED);
+        s->flags |= SPY_STR_HASHED;
+    }
+    return (int64_t)s->hash;
+}
+
 spy_Str *
 spy_str_getitem(spy_Str *s, int32_t i) {
     // XXX this is wrong: it should return a code point
@@ -51,5 +95,277 @@ spy_str_getitem(spy_Str *s, int32_t i) {
     spy_Str *res = spy_str_alloc(1);
     char *buf = (char*)res->utf8;
     buf[0] = s->utf8[i];
+    res->flags = (uint8_t)buf[0] < 0x80 ? SPY_STR_VALID_UTF8 : 0;
+    return res;
+}
+
+// Slices.
+//
+// A slice is a view into the data of its parent whenever this is
+// convenient, and a copy otherwise:
+//
+//   - short slices are always copied: a view needs a header anyway, and for
+//     them the copy is not much more expensive than the header itself;
+//
+//   - slices which are much smaller than their parent are copied as well,
+//     else they would keep a big string alive just for a few bytes. Parents
+//     whose data is a C string literal are immortal, so this doesn't apply.
+//
+// Views never form chains: a slice of a view points directly to the flat
+// string which owns the data.
+
+#define SPY_STR_VIEW_MIN_LENGTH 32
+
+// a view must be at least 1/SPY_STR_VIEW_MAX_RATIO of its parent
+#define SPY_STR_VIEW_MAX_RATIO 4
+
+static inline bool
+owns_inline_data(const spy_Str *s) {
+    return s->utf8 == (const char *)(s + 1);
+}
+
+// a slice of a valid string is valid iff it doesn't cut a character, i.e.
+// if it starts and stops at the beginning of one
+static inline bool
+is_char_boundary(const spy_Str *s, int32_t i) {
+    return (size_t)i == s->length || ((uint8_t)s->utf8[i] & 0xC0) != 0x80;
+}
+
+static inline int32_t
+clamp_index(int32_t i, int32_t length) {
+    if (i < 0) {
+        i += length;
+        return i < 0 ? 0 : i;
+    }
+    return i > length ? length : i;
+}
+
+spy_Str *
+spy_str_slice(spy_Str *s, int32_t start, int32_t stop) {
+    int32_t l = (int32_t)s->length;
+    start = clamp_index(start, l);
+    stop = clamp_index(stop, l);
+    if (stop < start)
+        stop = start;
+    size_t length = stop - start;
+    if (length == s->length)
+        return s;  // strings are immutable, no need to make a new one
+
+    uint32_t flags = 0;
+    if (valid_utf8(s) && is_char_boundary(s, start) &&
+        is_char_boundary(s, stop))
+        flags = SPY_STR_VALID_UTF8;
+
+    const spy_Str *owner = s->parent ? s->parent : s;
+    if (length < SPY_STR_VIEW_MIN_LENGTH ||
+        (owns_inline_data(owner) &&
+         length * SPY_STR_VIEW_MAX_RATIO < owner->length)) {
+        spy_Str *res = spy_str_alloc(length);
+        memcpy((char *)res->utf8, s->utf8 + start, length);
+        res->flags = flags;
+        return res;
+    }
+    spy_Str *res = (spy_Str*)spy_GcAlloc(sizeof(spy_Str)).p;
+    res->length = length;
+    res->utf8 = s->utf8 + start;
+    res->parent = owner;
+    res->flags = flags;
+    return res;
+}
+
+// Substring search.
+//
+// We use the "generic SIMD" algorithm described by Wojciech Muła in
+// "SIMD-friendly algorithms for substring searching": we compare the first
+// and the last byte of the needle against 16 positions of the haystack at
+// once, and we do a full memcmp only for the positions where both match. The
+// vector extensions become SSE2 on x86_64, NEON on aarch64 and simd128 on
+// wasm32. The last positions, which don't fill a whole block, are checked
+// one by one.
+
+typedef uint8_t spy_u8x16 __attribute__((vector_size(16)));
+
+static inline spy_u8x16 load_u8x16(const char *p) {
+    spy_u8x16 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Return the index of the first occurrence of needle in h[start:], or -1
+static int64_t
+find_from(const char *h, size_t n, const char *needle, size_t m, size_t start) {
+    if (m > n || start > n - m)
+        return -1;
+    if (m == 0)
+        return (int64_t)start;
+    size_t last = n - m; // the last position where needle can start
+    uint8_t first_ch = (uint8_t)needle[0];
+    uint8_t last_ch = (uint8_t)needle[m - 1];
+    spy_u8x16 v_first = first_ch - (spy_u8x16){};  // splat
+    spy_u8x16 v_last = last_ch - (spy_u8x16){};
+    size_t i = start;
+    // the block of positions i..i+15 reads up to h[i+15+m-1]
+    for (; i + 15 <= last; i += 16) {
+        spy_u8x16 eq = ((load_u8x16(h + i) == v_first) &
+                        (load_u8x16(h + i + m - 1) == v_last));
+        // each lane is either 0x00 or 0xff. Lane k is byte k of the two
+        // halves, since all our targets are little endian
+        uint64_t halves[2];
+        memcpy(halves, &eq, sizeof(halves));
+        for (int k = 0; k < 2; k++) {
+            uint64_t mask = halves[k];
+            while (mask != 0) {
+                int bit = __builtin_ctzll(mask);
+                size_t pos = i + 8 * k + bit / 8;
+                // the first and the last bytes are already known to match
+                if (m <= 2 || memcmp(h + pos + 1, needle + 1, m - 2) == 0)
+                    return (int64_t)pos;
+                mask &= ~((uint64_t)0xff << bit);
+            }
+        }
+    }
+    for (; i <= last; i++) {
+        if ((uint8_t)h[i] == first_ch && memcmp(h + i, needle, m) == 0)
+            return (int64_t)i;
+    }
+    return -1;
+}
+
+int32_t
+spy_str_find(spy_Str *s, spy_Str *sub) {
+    return (int32_t)find_from(s->utf8, s->length, sub->utf8, sub->length, 0);
+}
+
+int32_t
+spy_str_count(spy_Str *s, spy_Str *sub) {
+    // like Python, we count non-overlapping occurrences, and the empty
+    // string occurs length+1 times
+    size_t m = sub->length;
+    if (m == 0)
+        return (int32_t)(s->length + 1);
+    int32_t count = 0;
+    size_t start = 0;
+    int64_t i;
+    while ((i = find_from(s->utf8, s->length, sub->utf8, m, start)) >= 0) {
+        count++;
+        start = (size_t)i + m;
+    }
+    return count;
+}
+
+// split and join.
+//
+// The offsets of the pieces are computed with two passes of find_from: the
+// first counts them, so that the second can fill an array of the exact
+// size. Like Python, an empty separator is an error.
+
+spy_StrSplit *
+spy_str_split(spy_Str *s, spy_Str *sep) {
+    if (sep->length == 0) {
+        spy_panic("empty separator");
+        return NULL;
+    }
+    spy_StrSplit *res = (spy_StrSplit*)spy_GcAlloc(sizeof(spy_StrSplit)).p;
+    res->s = s;
+    res->sep = sep;
+    res->length = -1;
+    res->starts = NULL;
+    return res;
+}
+
+static void
+split_compute(spy_StrSplit *sp) {
+    const char *h = sp->s->utf8;
+    size_t n = sp->s->length;
+    size_t m = sp->sep->length;
+    int32_t length = spy_str_count(sp->s, sp->sep) + 1;
+    int32_t *starts = (int32_t*)spy_GcAlloc(length * sizeof(int32_t)).p;
+    starts[0] = 0;
+    size_t start = 0;
+    for (int32_t k = 1; k < length; k++) {
+        int64_t i = find_from(h, n, sp->sep->utf8, m, start);
+        start = (size_t)i + m;
+        starts[k] = (int32_t)start;
+    }
+    sp->starts = starts;
+    sp->length = length;
+}
+
+int32_t
+spy_StrSplit_length(spy_StrSplit *sp) {
+    if (sp->length < 0)
+        split_compute(sp);
+    return sp->length;
+}
+
+spy_Str *
+spy_StrSplit_getitem(spy_StrSplit *sp, int32_t i) {
+    int32_t l = spy_StrSplit_length(sp);
+    if (i < 0) {
+        i += l;
+    }
+    if (i >= l || i < 0) {
+        spy_panic("split index out of bound");
+        return NULL;
+    }
+    int32_t start = sp->starts[i];
+    int32_t stop = (i + 1 < l ?
+                    sp->starts[i + 1] - (int32_t)sp->sep->length :
+                    (int32_t)sp->s->length);
+    return spy_str_slice(sp->s, start, stop);
+}
+
+spy_Str *
+spy_str_join(spy_Str *sep, spy_Str **items, int32_t n) {
+    if (n == 0) {
+        spy_Str *res = spy_str_alloc(0);
+        res->flags = SPY_STR_VALID_UTF8;
+        return res;
+    }
+    if (n == 1)
+        return items[0];
+    size_t length = sep->length * (n - 1);
+    uint32_t flags = valid_utf8(sep);
+    for (int32_t i = 0; i < n; i++) {
+        length += items[i]->length;
+        flags &= valid_utf8(items[i]);
+    }
+    spy_Str *res = spy_str_alloc(length);
+    res->flags = flags;
+    char *buf = (char*)res->utf8;
+    for (int32_t i = 0; i < n; i++) {
+        if (i > 0) {
+            memcpy(buf, sep->utf8, sep->length);
+            buf += sep->length;
+        }
+        memcpy(buf, items[i]->utf8, items[i]->length);
+        buf += items[i]->length;
+    }
+    return res;
+}
+
+spy_Str *
+spy_str_join_split(spy_Str *sep, spy_StrSplit *sp) {
+    // we copy the pieces directly from the original string, without
+    // creating them. Their total length is known in advance
+    int32_t n = spy_StrSplit_length(sp);
+    spy_Str *s = sp->s;
+    size_t old_m = sp->sep->length;
+    size_t length = s->length - old_m * (n - 1) + sep->length * (n - 1);
+    spy_Str *res = spy_str_alloc(length);
+    char *buf = (char*)res->utf8;
+    for (int32_t i = 0; i < n; i++) {
+        size_t start = sp->starts[i];
+        size_t stop = i + 1 < n ? sp->starts[i + 1] - old_m : s->length;
+        if (i > 0) {
+            memcpy(buf, sep->utf8, sep->length);
+            buf += sep->length;
+        }
+        memcpy(buf, s->utf8 + start, stop - start);
+        buf += stop - start;
+    }
+    // a valid separator can match only at character boundaries, so the
+    // pieces of a valid string are valid
+    res->flags = valid_utf8(s) & valid_utf8(sp->sep) & valid_utf8(sep);
     return res;
 }
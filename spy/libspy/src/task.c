@@ -0,0 +1,321 @@
+#include "spy.h"
+
+// the env is copied right after the header: make sure that it is aligned
+// for any type that a trampoline might store in it
+typedef union {
+    int64_t i;
+    double d;
+    void *p;
+} spy_TaskEnvAlign;
+
+struct spy_Task {
+    spy_task_fn fn;
+    int32_t done;        // set to 1 (with release semantics) by run_task
+    spy_Task *next;      // link in the injection queue
+    spy_TaskEnvAlign env[];
+};
+
+static spy_Task *task_new(spy_task_fn fn, const void *env, size_t env_size) {
+    spy_Task *task = (spy_Task *)malloc(sizeof(spy_Task) + env_size);
+    task->fn = fn;
+    task->done = 0;
+    task->next = NULL;
+    memcpy(task->env, env, env_size);
+    return task;
+}
+
+static void run_task(spy_Task *task) {
+    task->fn(task->env);
+    __atomic_store_n(&task->done, 1, __ATOMIC_RELEASE);
+}
+
+// the result is at the beginning of the env, see spy/task.h
+static void task_free(spy_Task *task, void *result, size_t result_size) {
+    if (result_size > 0)
+        memcpy(result, task->env, result_size);
+    free(task);
+}
+
+#if !defined(SPY_TARGET_NATIVE)
+
+// no threads: run the task immediately
+
+spy_Task *spy_task_spawn(spy_task_fn fn, const void *env, size_t env_size) {
+    spy_Task *task = task_new(fn, env, env_size);
+    run_task(task);
+    return task;
+}
+
+void spy_task_join(spy_Task *task, void *result, size_t result_size) {
+    task_free(task, result, result_size);
+}
+
+#else
+
+#include <pthread.h>
+#include <sched.h>
+
+#define DEQUE_SIZE 4096  // must be a power of 2
+
+// Chase-Lev work-stealing deque, as described by "Correct and Efficient
+// Work-Stealing for Weak Memory Models" (Lê et al., PPoPP 2013). The owner
+// pushes and takes at the bottom, the thieves steal at the top. The buffer
+// has a fixed size: when it is full, spy_task_spawn runs the task
+// immediately, which is always a valid schedule.
+typedef struct {
+    int64_t top;
+    char pad0[64 - sizeof(int64_t)];  // top and bottom on different lines
+    int64_t bottom;
+    char pad1[64 - sizeof(int64_t)];
+    spy_Task *buf[DEQUE_SIZE];
+} spy_Deque;
+
+// only the owner can call deque_push and deque_take
+static bool deque_push(spy_Deque *d, spy_Task *task) {
+    int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED);
+    int64_t t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    if (b - t >= DEQUE_SIZE)
+        return false;
+    __atomic_store_n(&d->buf[b & (DEQUE_SIZE - 1)], task, __ATOMIC_RELAXED);
+    // publish the task, and its content, to the thieves
+    __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static spy_Task *deque_take(spy_Deque *d) {
+    int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&d->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t t = __atomic_load_n(&d->top, __ATOMIC_RELAXED);
+    if (t > b) {
+        // empty
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    spy_Task *task = __atomic_load_n(&d->buf[b & (DEQUE_SIZE - 1)],
+                                     __ATOMIC_RELAXED);
+    if (t == b) {
+        // last item: race against the thieves
+        if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, false,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+            task = NULL;
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+    return task;
+}
+
+typedef enum { STEAL_EMPTY, STEAL_ABORT, STEAL_OK } spy_StealResult;
+
+static spy_StealResult deque_steal(spy_Deque *d, spy_Task **out) {
+    int64_t t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t b = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE);
+    if (t >= b)
+        return STEAL_EMPTY;
+    spy_Task *task = __atomic_load_n(&d->buf[t & (DEQUE_SIZE - 1)],
+                                     __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        return STEAL_ABORT;  // lost the race with another thief or the owner
+    *out = task;
+    return STEAL_OK;
+}
+
+// The scheduler has n_workers threads, each with its own deque. Threads
+// which are not workers (e.g. the main thread) push their tasks to the
+// injection queue, and join by stealing like everybody else.
+//
+// Idle workers sleep on `wakeup`. To avoid lost wakeups, a worker reads
+// `epoch` before looking for work, and goes to sleep only if nobody has
+// spawned anything in the meantime: spawners bump `epoch` after publishing
+// the task, and signal only if there are sleeping workers.
+static struct {
+    int32_t n_workers;
+    spy_Deque *deques;
+    pthread_mutex_t inject_lock;   // protects inject_head and inject_tail
+    spy_Task *inject_head;
+    spy_Task *inject_tail;
+    int32_t n_injected;            // to check the queue without locking
+    pthread_mutex_t sleep_lock;
+    pthread_cond_t wakeup;
+    uint64_t epoch;
+    int32_t n_sleeping;
+} sched = {
+    .inject_lock = PTHREAD_MUTEX_INITIALIZER,
+    .sleep_lock = PTHREAD_MUTEX_INITIALIZER,
+    .wakeup = PTHREAD_COND_INITIALIZER,
+};
+
+static pthread_once_t sched_once = PTHREAD_ONCE_INIT;
+
+// the index of the deque of the current thread, or -1 if it is not a worker
+static __thread int32_t worker_id = -1;
+static __thread uint32_t rng_state = 0;
+
+static uint32_t next_random(void) {
+    // xorshift32, to pick the first victim
+    uint32_t x = rng_state;
+    if (x == 0)
+        x = (uint32_t)(uintptr_t)&rng_state | 1;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+static void inject_push(spy_Task *task) {
+    pthread_mutex_lock(&sched.inject_lock);
+    if (sched.inject_tail == NULL)
+        sched.inject_head = task;
+    else
+        sched.inject_tail->next = task;
+    sched.inject_tail = task;
+    __atomic_fetch_add(&sched.n_injected, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&sched.inject_lock);
+}
+
+static spy_Task *inject_pop(void) {
+    if (__atomic_load_n(&sched.n_injected, __ATOMIC_ACQUIRE) == 0)
+        return NULL;
+    pthread_mutex_lock(&sched.inject_lock);
+    spy_Task *task = sched.inject_head;
+    if (task != NULL) {
+        sched.inject_head = task->next;
+        if (sched.inject_head == NULL)
+            sched.inject_tail = NULL;
+        __atomic_fetch_sub(&sched.n_injected, 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&sched.inject_lock);
+    return task;
+}
+
+// Find a task to run: first from our own deque, then from the injection
+// queue (only if we are idle), then by stealing from a random victim.
+//
+// While we are joining, we don't take tasks from the injection queue: they
+// are the roots of whole trees of tasks, and running them would make the
+// stack grow without bounds.
+static spy_Task *find_task(bool idle) {
+    spy_Task *task;
+    if (worker_id >= 0) {
+        task = deque_take(&sched.deques[worker_id]);
+        if (task != NULL)
+            return task;
+    }
+    if (idle) {
+        task = inject_pop();
+        if (task != NULL)
+            return task;
+    }
+    // workers might start before sched_init sets n_workers
+    int32_t n = __atomic_load_n(&sched.n_workers, __ATOMIC_ACQUIRE);
+    bool retry = n > 0;
+    while (retry) {
+        retry = false;
+        int32_t start = (int32_t)(next_random() % (uint32_t)n);
+        for (int32_t i = 0; i < n; i++) {
+            int32_t victim = (start + i) % n;
+            if (victim == worker_id)
+                continue;
+            spy_StealResult res = deque_steal(&sched.deques[victim], &task);
+            if (res == STEAL_OK)
+                return task;
+            if (res == STEAL_ABORT)
+                retry = true;
+        }
+    }
+    return NULL;
+}
+
+static void *worker_main(void *arg) {
+    worker_id = (int32_t)(intptr_t)arg;
+    for (;;) {
+        uint64_t epoch = __atomic_load_n(&sched.epoch, __ATOMIC_SEQ_CST);
+        spy_Task *task = find_task(true);
+        if (task != NULL) {
+            run_task(task);
+            continue;
+        }
+        pthread_mutex_lock(&sched.sleep_lock);
+        __atomic_fetch_add(&sched.n_sleeping, 1, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n(&sched.epoch, __ATOMIC_SEQ_CST) == epoch)
+            pthread_cond_wait(&sched.wakeup, &sched.sleep_lock);
+        __atomic_fetch_sub(&sched.n_sleeping, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&sched.sleep_lock);
+    }
+    return NULL;
+}
+
+static void sched_init(void) {
+    // the threads which spawn and join help the workers, so we start one
+    // worker less than the requested number of threads
+    int32_t n = spy_default_num_threads() - 1;
+    if (n <= 0)
+        return;
+    sched.deques = (spy_Deque *)calloc((size_t)n, sizeof(spy_Deque));
+    if (sched.deques == NULL)
+        return;
+    int32_t n_workers = 0;
+    for (int32_t i = 0; i < n; i++) {
+        pthread_t t;
+        if (pthread_create(&t, NULL, worker_main, (void *)(intptr_t)i) != 0)
+            break;
+        pthread_detach(t);
+        n_workers++;
+    }
+    __atomic_store_n(&sched.n_workers, n_workers, __ATOMIC_RELEASE);
+}
+
+static void notify_workers(void) {
+    __atomic_fetch_add(&sched.epoch, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&sched.n_sleeping, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&sched.sleep_lock);
+        pthread_cond_signal(&sched.wakeup);
+        pthread_mutex_unlock(&sched.sleep_lock);
+    }
+}
+
+spy_Task *spy_task_spawn(spy_task_fn fn, const void *env, size_t env_size) {
+    pthread_once(&sched_once, sched_init);
+    spy_Task *task = task_new(fn, env, env_size);
+    if (__atomic_load_n(&sched.n_workers, __ATOMIC_ACQUIRE) == 0) {
+        run_task(task);
+        return task;
+    }
+    if (worker_id >= 0) {
+        if (!deque_push(&sched.deques[worker_id], task)) {
+            run_task(task);
+            return task;
+        }
+    }
+    else {
+        inject_push(task);
+    }
+    notify_workers();
+    return task;
+}
+
+void spy_task_join(spy_Task *task, void *result, size_t result_size) {
+    int32_t spins = 0;
+    while (!__atomic_load_n(&task->done, __ATOMIC_ACQUIRE)) {
+        // workers help: the task we are waiting for is either in some
+        // deque, or it is being run by another worker, possibly one which is
+        // waiting for a task that we spawned. The other threads just wait:
+        // their tasks are in the injection queue, which the idle workers
+        // drain.
+        spy_Task *other = NULL;
+        if (worker_id >= 0)
+            other = find_task(false);
+        if (other != NULL) {
+            run_task(other);
+            spins = 0;
+        }
+        else if (++spins > 64) {
+            sched_yield();
+        }
+    }
+    task_free(task, result, result_size);
+}
+
+#endif /* !defined(SPY_TARGET_NATIVE) */
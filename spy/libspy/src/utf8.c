@@ -0,0 +1,236 @@
+#include "spy.h"
+
+// UTF-8 validation.
+//
+// We use the "lookup" algorithm described by Keiser and Lemire in
+// "Validating UTF-8 In Less Than One Instruction Per Byte" (2021), which is
+// also the one used by simdutf. Every invalid sequence can be detected by
+// looking only at the high nibble of a byte and at the previous byte: three
+// 16-entry tables give a bitmask of the errors which are possible for each
+// of the three nibbles, and a byte is wrong iff the AND of the three masks
+// is nonzero. Sequences of 3 and 4 bytes also need the bytes at distance 2
+// and 3, see check_block.
+//
+// The table lookups are a single byte shuffle instruction: tbl on aarch64,
+// i8x16.swizzle on wasm32 and pshufb on x86_64. pshufb needs SSSE3, which is
+// not part of the x86_64 baseline: unless we are compiled with -mssse3, we
+// check at runtime whether the CPU has it. Targets without a shuffle do the
+// same lookups one byte at a time. In all cases, blocks of pure ASCII skip
+// the lookups entirely.
+
+#if defined(__wasm_simd128__)
+#  include <wasm_simd128.h>
+#  define HAVE_SHUFFLE true
+#elif defined(__aarch64__)
+#  include <arm_neon.h>
+#  define HAVE_SHUFFLE true
+#elif defined(__x86_64__) && defined(__SSSE3__)
+#  include <tmmintrin.h>
+#  define HAVE_SHUFFLE true
+#elif defined(__x86_64__)
+#  include <tmmintrin.h>
+#  define HAVE_SHUFFLE false
+#  define DISPATCH_SSSE3
+#else
+#  define HAVE_SHUFFLE false
+#endif
+
+typedef uint8_t spy_u8x16 __attribute__((vector_size(16)));
+
+static inline spy_u8x16 load_u8x16(const uint8_t *p) {
+    spy_u8x16 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// table[idx[i]] for each lane: all the indexes are < 16
+#if defined(__wasm_simd128__)
+static inline spy_u8x16 lookup16(spy_u8x16 table, spy_u8x16 idx) {
+    return (spy_u8x16)wasm_i8x16_swizzle((v128_t)table, (v128_t)idx);
+}
+#elif defined(__aarch64__)
+static inline spy_u8x16 lookup16(spy_u8x16 table, spy_u8x16 idx) {
+    return (spy_u8x16)vqtbl1q_u8((uint8x16_t)table, (uint8x16_t)idx);
+}
+#elif defined(__x86_64__)
+__attribute__((target("ssse3")))
+static inline spy_u8x16 lookup16(spy_u8x16 table, spy_u8x16 idx) {
+    return (spy_u8x16)_mm_shuffle_epi8((__m128i)table, (__m128i)idx);
+}
+#else
+// never called, see HAVE_SHUFFLE
+static inline spy_u8x16 lookup16(spy_u8x16 table, spy_u8x16 idx) {
+    return table;
+}
+#endif
+
+// the errors which are detected by the lookup tables
+#define TOO_SHORT      (1 << 0)  // lead byte not followed by a continuation
+#define TOO_LONG       (1 << 1)  // continuation not preceded by a lead byte
+#define OVERLONG_3     (1 << 2)
+#define TOO_LARGE      (1 << 3)  // code point > U+10FFFF
+#define SURROGATE      (1 << 4)
+#define OVERLONG_2     (1 << 5)
+#define TOO_LARGE_1000 (1 << 6)
+#define OVERLONG_4     (1 << 6)
+#define TWO_CONTS      (1 << 7)  // two continuations, see check_block
+#define CARRY (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+// indexed by the high nibble of the previous byte
+static const spy_u8x16 byte_1_high = {
+    // 0_______: ASCII
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    // 10______: continuation
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    // 1100____: lead of 2 bytes, C0 and C1 are always overlong
+    TOO_SHORT | OVERLONG_2,
+    // 1101____: lead of 2 bytes
+    TOO_SHORT,
+    // 1110____: lead of 3 bytes
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    // 1111____: lead of 4 bytes
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+};
+
+// indexed by the low nibble of the previous byte
+static const spy_u8x16 byte_1_low = {
+    // ____0000
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    // ____0001
+    CARRY | OVERLONG_2,
+    // ____001_
+    CARRY,
+    CARRY,
+    // ____0100
+    CARRY | TOO_LARGE,
+    // ____0101
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    // ____011_
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    // ____1___
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    // ____1101
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+};
+
+// indexed by the high nibble of the current byte
+static const spy_u8x16 byte_2_high = {
+    // 0_______: ASCII
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    // 1000____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 |
+        OVERLONG_4,
+    // 1001____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    // 101_____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    // 11______: lead byte
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+};
+
+static inline bool is_zero(spy_u8x16 v) {
+    uint64_t lo, hi;
+    memcpy(&lo, &v, 8);
+    memcpy(&hi, (char *)&v + 8, 8);
+    return (lo | hi) == 0;
+}
+
+// Check the 16 bytes at p, which must be preceded by 3 readable bytes: the
+// previous bytes are loaded again with unaligned loads. Return false if
+// there is an error.
+static inline __attribute__((always_inline)) bool
+check_block(const uint8_t *p, bool shuffle) {
+    if (!shuffle) {
+        uint8_t error = 0;
+        for (int i = 0; i < 16; i++) {
+            uint8_t sc = byte_1_high[p[i - 1] >> 4] &
+                         byte_1_low[p[i - 1] & 0x0F] &
+                         byte_2_high[p[i] >> 4];
+            uint8_t must23 = p[i - 2] >= 0xE0 || p[i - 3] >= 0xF0;
+            error |= (must23 << 7) ^ sc;
+        }
+        return error == 0;
+    }
+    spy_u8x16 input = load_u8x16(p);
+    spy_u8x16 prev1 = load_u8x16(p - 1);
+    spy_u8x16 prev2 = load_u8x16(p - 2);
+    spy_u8x16 prev3 = load_u8x16(p - 3);
+    spy_u8x16 sc = lookup16(byte_1_high, prev1 >> 4) &
+                   lookup16(byte_1_low, prev1 & 0x0F) &
+                   lookup16(byte_2_high, input >> 4);
+    // the 2nd and 3rd continuation of a sequence are not detected by the
+    // tables: for them, TWO_CONTS is set and expected
+    spy_u8x16 must23 = (spy_u8x16)((prev2 >= 0xE0) | (prev3 >= 0xF0));
+    return is_zero((must23 & 0x80) ^ sc);
+}
+
+static inline bool is_ascii(spy_u8x16 v) {
+    return is_zero(v & 0x80);
+}
+
+// the bytes before p expect more continuations
+static inline bool is_incomplete(const uint8_t *p) {
+    return p[-1] >= 0xC0 || p[-2] >= 0xE0 || p[-3] >= 0xF0;
+}
+
+static inline __attribute__((always_inline)) bool
+validate(const char *buf, size_t n, bool shuffle) {
+    const uint8_t *p = (const uint8_t *)buf;
+    // the first and the last block are copied here, with the 3 previous
+    // bytes in front (0 at the beginning) and padded with 0 at the end
+    uint8_t tmp[3 + 16];
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const uint8_t *block = p + i;
+        if (i == 0) {
+            __builtin_memset(tmp, 0, 3);
+            memcpy(tmp + 3, p, 16);
+            block = tmp + 3;
+        }
+        if (is_ascii(load_u8x16(block))) {
+            // a sequence might still be truncated by this block
+            if (is_incomplete(block))
+                return false;
+            continue;
+        }
+        if (!check_block(block, shuffle))
+            return false;
+    }
+    // the last block, possibly empty: the padding also catches a sequence
+    // which is truncated by the end of the string
+    __builtin_memset(tmp, 0, sizeof(tmp));
+    for (size_t k = 1; k <= 3 && k <= i; k++)
+        tmp[3 - k] = p[i - k];
+    memcpy(tmp + 3, p + i, n - i);
+    return check_block(tmp + 3, shuffle);
+}
+
+#ifdef DISPATCH_SSSE3
+__attribute__((target("ssse3")))
+static bool
+validate_ssse3(const char *buf, size_t n) {
+    return validate(buf, n, true);
+}
+
+bool
+spy_utf8_validate(const char *buf, size_t n) {
+    if (__builtin_cpu_supports("ssse3"))
+        return validate_ssse3(buf, n);
+    return validate(buf, n, false);
+}
+#else
+bool
+spy_utf8_validate(const char *buf, size_t n) {
+    return validate(buf, n, HAVE_SHUFFLE);
+}
+#endif
@@ -9,8 +9,13 @@ It is called 'LL' for two reasons:
 
   - it's an unused prefix: other prefixes as "Py", "Wasm", "W" etc. would have
     been very confusing :)
+
+A wt.Store is not thread-safe: every LLWasmInstance has a reentrant lock
+which serializes all the calls and memory accesses done through it.
 """
 
+import threading
+import ctypes
 from typing import Any, Optional, Literal
 from typing_extensions import Self
 import py.path
@@ -60,6 +65,7 @@ def link(store: wt.Store, llmod: LLWasmModule,
 
     py2w = {
         int: wt.ValType.i32(),
+        float: wt.ValType.f64(),
     }
 
     def FuncType_from_pyfunc(pyfunc: Any) -> wt.FuncType:
@@ -87,16 +93,18 @@ class LLWasmInstance:
     store: wt.Store
     instance: wt.Instance
     mem: 'LLWasmMemory'
+    lock: threading.RLock
 
     def __init__(self, llmod: LLWasmModule,
                  hostmods: list[HostModule]=[]) -> None:
         self.llmod = llmod
+        self.lock = threading.RLock()
         self.store = wt.Store(ENGINE)
         imports = link(self.store, llmod, hostmods)
         self.instance = wt.Instance(self.store, self.llmod.mod, imports)
         memory = self.instance.exports(self.store).get('memory')
         assert isinstance(memory, wt.Memory)
-        self.mem = LLWasmMemory(self.store, memory)
+        self.mem = LLWasmMemory(self.store, memory, self.lock)
         for hostmod in hostmods:
             hostmod.ll = self
 
@@ -118,9 +126,10 @@ class LLWasmInstance:
         return list(exports._extern_map)
 
     def call(self, name: str, *args: Any) -> Any:
-        func = self.get_export(name)
-        assert isinstance(func, wt.Func)
-        return func(self.store, *args)
+        with self.lock:
+            func = self.get_export(name)
+            assert isinstance(func, wt.Func)
+            return func(self.store, *args)
 
     def read_global(self, name: str, deref: LLWasmType = None) -> Any:
         """
@@ -153,9 +162,10 @@ class LLWasmInstance:
             read_global('a', deref='i16') == 0xAAAA
             read_global('b', deref='i16') == 0xBBBB # first item of the array
         """
-        g = self.get_export(name)
-        assert isinstance(g, wt.Global)
-        addr = g.value(self.store)
+        with self.lock:
+            g = self.get_export(name)
+            assert isinstance(g, wt.Global)
+            addr = g.value(self.store)
         assert isinstance(addr, int)
         if deref is None:
             return addr
@@ -173,16 +183,20 @@ class LLWasmMemory:
     """
     store: wt.Store
     mem: wt.Memory
+    lock: threading.RLock
 
-    def __init__(self, store: wt.Store, mem: wt.Memory):
+    def __init__(self, store: wt.Store, mem: wt.Memory,
+                 lock: threading.RLock) -> None:
         self.store = store
         self.mem = mem
+        self.lock = lock
 
     def read(self, addr: int, n: int) -> bytearray:
         """
         Read n bytes of memory at the given address.
         """
-        return self.mem.read(self.store, addr, addr+n)
+        with self.lock:
+            return self.mem.read(self.store, addr, addr+n)
 
     def read_i32(self, addr: int) -> int:
         rawbytes = self.read(addr, 4)
@@ -204,10 +218,29 @@ class LLWasmMemory:
         for every char To be faster we probably need to bypass wasmtime and
         access directly the ctypes-based view of the memory.
         """
-        n = 0
-        while self.read_i8(addr + n) != 0:
-            n += 1
-        return self.read(addr, n)
+        with self.lock:
+            n = 0
+            while self.read_i8(addr + n) != 0:
+                n += 1
+            return self.read(addr, n)
 
     def write(self, addr: int, b: bytes) -> None:
-        self.mem.write(self.store, b, addr)
+        with self.lock:
+            self.mem.write(self.store, b, addr)
+
+    def view(self, addr: int, n: int) -> memoryview:
+        """
+        Return a writable view of n bytes of memory at the given address,
+        without copying them.
+
+        WARNING: the view is invalidated when the memory grows, so it must be
+        used only while holding the lock and not stored anywhere.
+        """
+        with self.lock:
+            ptr = self.mem.data_ptr(self.store)
+            size = self.mem.data_len(self.store)
+        if addr < 0 or n < 0 or addr + n > size:
+            raise IndexError('memory access out of bounds')
+        base = ctypes.addressof(ptr.contents)
+        buf = (ctypes.c_ubyte * n).from_address(base + addr)
+        return memoryview(buf).cast('B')
@@ -1,17 +1,69 @@
-import dataclasses
-from dataclasses import dataclass
+import sys
 import linecache
 
-@dataclass
 class Loc:
     """
-    Represent a location inside the source code
+    Represent a location inside the source code.
+
+    There is one Loc for each AST node, so we want them to be compact: the
+    filename is interned, and the four line/col numbers are packed into a
+    single int. They are exposed as read-only properties.
     """
+    __slots__ = ('filename', '_packed')
     filename: str
-    line_start: int
-    line_end: int
-    col_start: int
-    col_end: int
+    _packed: int
+
+    _BITS = 32
+    _MASK = (1 << _BITS) - 1
+
+    def __init__(self, filename: str, line_start: int, line_end: int,
+                 col_start: int, col_end: int) -> None:
+        self.filename = sys.intern(filename)
+        self._packed = self._pack(line_start, line_end, col_start, col_end)
+
+    @classmethod
+    def _pack(cls, *values: int) -> int:
+        packed = 0
+        for i, v in enumerate(values):
+            assert 0 <= v <= cls._MASK, f'Loc field out of range: {v}'
+            packed |= v << (i * cls._BITS)
+        return packed
+
+    def _get(self, i: int) -> int:
+        return (self._packed >> (i * self._BITS)) & self._MASK
+
+    @property
+    def line_start(self) -> int:
+        return self._get(0)
+
+    @property
+    def line_end(self) -> int:
+        return self._get(1)
+
+    @property
+    def col_start(self) -> int:
+        return self._get(2)
+
+    @property
+    def col_end(self) -> int:
+        return self._get(3)
+
+    def __eq__(self, other: object) -> bool:
+        if not isinstance(other, Loc):
+            return NotImplemented
+        return (self.filename == other.filename and
+                self._packed == other._packed)
+
+    def __hash__(self) -> int:
+        return hash((self.filename, self._packed))
+
+    def __getstate__(self) -> tuple[str, int]:
+        return (self.filename, self._packed)
+
+    def __setstate__(self, state: tuple[str, int]) -> None:
+        filename, packed = state
+        self.filename = sys.intern(filename)
+        self._packed = packed
 
     @classmethod
     def fake(cls) -> 'Loc':
@@ -33,7 +85,12 @@ class Loc:
         return cls(start.filename, l1, l2, c1, c2)
 
     def replace(self, **kwargs: int) -> 'Loc':
-        return dataclasses.replace(self, **kwargs)
+        fields = dict(line_start=self.line_start,
+                      line_end=self.line_end,
+                      col_start=self.col_start,
+                      col_end=self.col_end)
+        fields.update(kwargs)
+        return Loc(self.filename, **fields)
 
     def make_end_loc(self) -> 'Loc':
         """
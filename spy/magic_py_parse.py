@@ -13,28 +13,36 @@ The idea is the following:
 2. search for pairs of NAMEs starting with 'var' (from the point of view of
    the tokenizer, 'var' is a plain NAME
 
-3. remove the 'var' token, and keep track of the location in which it was seen
+3. replace "var x" with "x   " directly in the source lines, so that all
+   the columns after it are preserved, and keep track of the location in
+   which it was seen
 
-4. turn back the (modified) tokens into source code
+4. parse the modified source code into an AST
 
-5. parse the generated source code into an AST
-
-6. add a new field "is_var: bool" to all ast.Name nodes, using the infos
-   gathered at point (3)
+5. set "is_var = True" on the ast.Name nodes found at point (3). The other
+   ast.Name nodes don't have the attribute: read it with
+   getattr(node, 'is_var', False).
 
 It is important to make sure that whitespace is preserved as much as possible,
 because we want the AST to contain location info which match the actual file
-on disk. For this, we use the `untokenize` module (available on PyPI) which
-does exactly that.
+on disk: this is why we edit the source in place instead of rebuilding it
+from the tokens.
+
+Most of the files don't contain "var" at all: in that case we skip the
+tokenization completely and we just call ast.parse.
 """
 
 from dataclasses import dataclass
 import ast as py_ast
-from tokenize import tokenize, NUMBER, STRING, NAME, OP, TokenInfo
-from io import BytesIO
-import untokenize
+import re
+from tokenize import generate_tokens, NAME, TokenInfo
+from io import StringIO
 import spy.ast_dump
 
+# quick check to decide whether we need to tokenize at all. It can give false
+# positives (e.g. "var" inside a string or comment), but never false negatives
+RE_VAR = re.compile(r'\bvar\b')
+
 @dataclass(frozen=True)
 class LocInfo:
     lineno: int
@@ -49,6 +57,8 @@ def magic_py_parse(src: str) -> py_ast.Module:
     """
     src2, var_locs = preprocess(src)
     py_mod = py_ast.parse(src2)
+    if not var_locs:
+        return py_mod
 
     for node in py_ast.walk(py_mod):
         if isinstance(node, py_ast.Name):
@@ -56,17 +66,20 @@ def magic_py_parse(src: str) -> py_ast.Module:
             assert node.end_col_offset is not None
             loc = LocInfo(node.lineno, node.end_lineno,
                           node.col_offset, node.end_col_offset)
-            node.is_var = loc in var_locs
+            if loc in var_locs:
+                node.is_var = True
 
     return py_mod
 
 def get_tokens(src: str) -> list[TokenInfo]:
-    readline = BytesIO(src.encode('utf-8')).readline
-    return list(tokenize(readline))
+    readline = StringIO(src).readline
+    return list(generate_tokens(readline))
 
 def preprocess(src: str) -> tuple[str, set[LocInfo]]:
+    if not RE_VAR.search(src):
+        return src, set()
     tokens = get_tokens(src)
-    newtokens = []
+    lines = StringIO(src).readlines()
     i = 0
     N = len(tokens)
     var_locs = set()
@@ -91,9 +104,9 @@ def preprocess(src: str) -> tuple[str, set[LocInfo]]:
             assert var_l0 == var_l1 == name_l0 == name_l1, \
                 'multiline var not supported'
             spaces = ' ' * (name_c0 - var_c0)
-            newtok = TokenInfo(NAME, tok1.string + spaces,
-                               tok0.start, tok1.end, tok1.line)
-            newtokens.append(newtok)
+            line = lines[var_l0 - 1]
+            lines[var_l0 - 1] = (line[:var_c0] + tok1.string + spaces +
+                                 line[name_c1:])
             # compute the location info of the future ast.Name
             loc = LocInfo(
                 lineno = var_l0,
@@ -103,8 +116,6 @@ def preprocess(src: str) -> tuple[str, set[LocInfo]]:
             )
             var_locs.add(loc)
             i += 1
-        else:
-            newtokens.append(tok0)
         i += 1
-    src2 = untokenize.untokenize(newtokens)
+    src2 = ''.join(lines)
     return src2, var_locs
@@ -241,7 +241,7 @@ class Parser:
         assign = self.from_py_stmt_Assign(py_node)
         assert isinstance(assign, spy.ast.Assign)
         kind: spy.ast.VarKind = 'const'
-        if py_node.targets[0].is_var:  # type: ignore
+        if getattr(py_node.targets[0], 'is_var', False):
             kind = 'var'
         vardef = spy.ast.VarDef(loc=py_node.loc,
                                 kind=kind,
@@ -265,7 +265,7 @@ class Parser:
         # local VarDef are always 'var' (for now?)
         is_local = not is_global
         kind: spy.ast.VarKind
-        if is_local or py_node.target.is_var:
+        if is_local or getattr(py_node.target, 'is_var', False):
             kind = 'var'
         else:
             kind = 'const'
@@ -339,6 +339,46 @@ class Parser:
             body = self.from_py_body(py_node.body)
         )
 
+    def from_py_stmt_For(self, py_node: py_ast.For) -> spy.ast.ParallelFor:
+        # for now, the only supported kind of loop is:
+        #     for i in parallel_range(n [, schedule]):
+        py_iter = py_node.iter
+        if not (isinstance(py_iter, py_ast.Call) and
+                isinstance(py_iter.func, py_ast.Name) and
+                py_iter.func.id == 'parallel_range'):
+            self.unsupported(py_iter, '`for` loops over anything else than '
+                             '`parallel_range()`')
+        if py_node.orelse:
+            self.unsupported(py_node, '`else` clause in `for` loops')
+        if not isinstance(py_node.target, py_ast.Name):
+            self.unsupported(py_node.target, 'complex `for` targets')
+        #
+        py_args = list(py_iter.args)
+        for py_kw in py_iter.keywords:
+            if py_kw.arg != 'schedule':
+                self.unsupported(py_kw, 'keyword arguments to `parallel_range`')
+            py_args.append(py_kw.value)
+        if len(py_args) not in (1, 2):
+            self.error('`parallel_range` takes 1 or 2 arguments',
+                       'wrong number of arguments', py_iter.loc)
+        schedule = 'static'
+        if len(py_args) == 2:
+            py_sched = py_args[1]
+            if (not isinstance(py_sched, py_ast.Constant) or
+                py_sched.value not in ('static', 'dynamic', 'guided')):
+                self.error('invalid schedule',
+                           "expected 'static', 'dynamic' or 'guided'",
+                           py_sched.loc)
+            schedule = py_sched.value
+        return spy.ast.ParallelFor(
+            loc = py_node.loc,
+            target_loc = py_node.target.loc,
+            target = py_node.target.id,
+            n = self.from_py_expr(py_args[0]),
+            schedule = schedule,  # type: ignore
+            body = self.from_py_body(py_node.body),
+        )
+
     # ====== spy.ast.Expr ======
 
     def from_py_expr(self, py_node: py_ast.expr) -> spy.ast.Expr:
@@ -365,9 +405,23 @@ class Parser:
             assert False, f'Unexpected literal: {py_node.value}'
 
 
-    def from_py_expr_Subscript(self, py_node: py_ast.Subscript) -> spy.ast.GetItem:
+    def from_py_expr_Subscript(self, py_node: py_ast.Subscript) -> spy.ast.Expr:
         value = self.from_py_expr(py_node.value)
-        index = self.from_py_expr(py_node.slice)
+        py_slice = py_node.slice
+        if isinstance(py_slice, py_ast.Slice):
+            if py_slice.step is not None:
+                self.unsupported(py_slice.step, 'slices with a step')
+            if py_slice.lower is None:
+                start: spy.ast.Expr = spy.ast.Constant(py_node.loc, 0)
+            else:
+                start = self.from_py_expr(py_slice.lower)
+            if py_slice.upper is None:
+                stop: spy.ast.Expr = spy.ast.Constant(py_node.loc,
+                                                      spy.ast.GetSlice.END)
+            else:
+                stop = self.from_py_expr(py_slice.upper)
+            return spy.ast.GetSlice(py_node.loc, value, start, stop)
+        index = self.from_py_expr(py_slice)
         return spy.ast.GetItem(py_node.loc, value, index)
 
     def from_py_expr_Attribute(self,
@@ -0,0 +1,143 @@
+import pytest
+from spy.libspy import SPyPanicError
+from spy.tests.support import CompilerTest
+
+class TestAtomic(CompilerTest):
+
+    def test_atomic_i32(self):
+        mod = self.compile("""
+        from atomic import (AtomicI32, atomic_i32, atomic_load_i32,
+                            atomic_store_i32, atomic_cas_i32,
+                            atomic_fetch_add_i32)
+
+        def foo() -> i32:
+            a: AtomicI32 = atomic_i32(40)
+            old = atomic_fetch_add_i32(a, 2)
+            if old != 40:
+                return -1
+            if atomic_cas_i32(a, 0, 100):
+                return -2
+            if atomic_cas_i32(a, 42, 43):
+                atomic_store_i32(a, atomic_load_i32(a) - 1)
+                return atomic_load_i32(a)
+            return -3
+        """)
+        assert mod.foo() == 42
+
+    def test_parallel_counter(self):
+        mod = self.compile("""
+        from atomic import (AtomicI32, atomic_i32, atomic_load_i32,
+                            atomic_fetch_add_i32)
+
+        def foo(n: i32) -> i32:
+            counter: AtomicI32 = atomic_i32(0)
+            for i in parallel_range(n, 'dynamic'):
+                atomic_fetch_add_i32(counter, i)
+            return atomic_load_i32(counter)
+        """)
+        assert mod.foo(1000) == sum(range(1000))
+
+    def test_channel_i32(self):
+        mod = self.compile("""
+        from atomic import (ChannelI32, spsc_i32, mpmc_i32, ch_send_i32,
+                            ch_try_send_i32, ch_recv_i32)
+
+        def fill(ch: ChannelI32) -> i32:
+            n = 0
+            while ch_try_send_i32(ch, n):
+                n = n + 1
+            return n
+
+        def sum_spsc(n: i32) -> i32:
+            ch: ChannelI32 = spsc_i32(n)
+            i = 0
+            while i < n:
+                ch_send_i32(ch, i)
+                i = i + 1
+            total = 0
+            while i > 0:
+                total = total + ch_recv_i32(ch)
+                i = i - 1
+            return total
+
+        def capacity_spsc(n: i32) -> i32:
+            return fill(spsc_i32(n))
+
+        def capacity_mpmc(n: i32) -> i32:
+            return fill(mpmc_i32(n))
+        """)
+        assert mod.sum_spsc(10) == sum(range(10))
+        # the capacity is rounded up to a power of two
+        assert mod.capacity_spsc(5) == 8
+        assert mod.capacity_mpmc(5) == 8
+        assert mod.capacity_mpmc(1) == 1
+
+    def test_channel_capacity_one(self):
+        mod = self.compile("""
+        from atomic import (ChannelI32, mpmc_i32, ch_try_send_i32,
+                            ch_recv_i32)
+
+        def fill_and_drain() -> i32:
+            ch: ChannelI32 = mpmc_i32(1)
+            res = 0
+            if ch_try_send_i32(ch, 10):
+                res = res + 1
+            if ch_try_send_i32(ch, 20):
+                res = res + 100
+            res = res + ch_recv_i32(ch)
+            if ch_try_send_i32(ch, 30):
+                res = res + 1000
+            if ch_try_send_i32(ch, 40):
+                res = res + 10000
+            return res + ch_recv_i32(ch)
+        """)
+        # only one item fits, and it is never overwritten
+        assert mod.fill_and_drain() == 1 + 10 + 1000 + 30
+
+    def test_channel_f64(self):
+        mod = self.compile("""
+        from atomic import ChannelF64, mpmc_f64, ch_send_f64, ch_recv_f64
+
+        def foo(x: f64) -> f64:
+            ch: ChannelF64 = mpmc_f64(4)
+            ch_send_f64(ch, x)
+            ch_send_f64(ch, x * 2.0)
+            return ch_recv_f64(ch) - ch_recv_f64(ch)
+        """)
+        assert mod.foo(1.5) == -1.5
+
+    def test_pipeline(self):
+        mod = self.compile("""
+        from atomic import ChannelI32, spsc_i32, ch_send_i32, ch_recv_i32
+
+        def produce(ch: ChannelI32, n: i32) -> void:
+            i = 0
+            while i < n:
+                ch_send_i32(ch, i * i)
+                i = i + 1
+
+        def consume(ch: ChannelI32, n: i32) -> i32:
+            total = 0
+            while n > 0:
+                total = total + ch_recv_i32(ch)
+                n = n - 1
+            return total
+
+        def foo(n: i32) -> i32:
+            ch: ChannelI32 = spsc_i32(n)
+            t = spawn(produce, ch, n)
+            res = consume(ch, n)
+            join(t)
+            return res
+        """)
+        assert mod.foo(100) == sum(i*i for i in range(100))
+
+    def test_invalid_capacity(self):
+        mod = self.compile("""
+        from atomic import ChannelI32, spsc_i32
+
+        def foo() -> void:
+            ch: ChannelI32 = spsc_i32(0)
+        """)
+        with pytest.raises(SPyPanicError, match="invalid channel capacity"):
+            mod.foo()
@@ -0,0 +1,183 @@
+from typing import Any
+import struct
+import io
+import pytest
+from spy.libspy import SPyPanicError
+from spy.tests.support import CompilerTest, skip_backends
+
+# we cannot do I/O in our internal tests, see also test_basic::test_print
+@skip_backends('C', reason='no I/O for wasm32')
+class TestIO(CompilerTest):
+
+    def test_readline(self):
+        mod = self.compile(
+        """
+        from io import Reader, open_reader, readline, close_reader
+
+        def read_lines(path: str) -> str:
+            r: Reader = open_reader(path)
+            res = ''
+            line = readline(r)
+            while line != '':
+                res = res + '[' + line + ']'
+                line = readline(r)
+            close_reader(r)
+            return res
+        """)
+        f = self.tmpdir.join('input.txt')
+        f.write_binary('hello\n\nàèì €\nno newline'.encode('utf-8'))
+        res = mod.read_lines(str(f))
+        assert res == '[hello\n][\n][àèì €\n][no newline]'
+        #
+        f.write_binary(b'')
+        assert mod.read_lines(str(f)) == ''
+        # lines which are longer than the buffer
+        long_line = 'x' * 100_000
+        f.write_binary(f'a\n{long_line}\nb'.encode('utf-8'))
+        assert mod.read_lines(str(f)) == f'[a\n][{long_line}\n][b]'
+
+    def test_read(self):
+        mod = self.compile(
+        """
+        from rawbuffer import RawBuffer, rb_alloc, rb_get_i32
+        from io import Reader, open_reader, readline, read, close_reader
+
+        def foo(path: str) -> i32:
+            r: Reader = open_reader(path)
+            header = readline(r)
+            buf: RawBuffer = rb_alloc(16)
+            n = read(r, buf, 4, 12)
+            if n != 8:
+                return -1
+            res = rb_get_i32(buf, 4) + rb_get_i32(buf, 8)
+            n = read(r, buf, 0, 4)
+            close_reader(r)
+            if n != 0:
+                return -2
+            return res
+        """)
+        f = self.tmpdir.join('input.bin')
+        f.write_binary(b'header\n' + struct.pack('ii', 40, 2))
+        assert mod.foo(str(f)) == 42
+
+    def test_write(self):
+        mod = self.compile(
+        """
+        from rawbuffer import RawBuffer, rb_alloc, rb_set_i32
+        from io import Writer, open_writer, write, write_rb, close_writer
+
+        def foo(path: str, n: i32) -> void:
+            w: Writer = open_writer(path)
+            buf: RawBuffer = rb_alloc(8)
+            rb_set_i32(buf, 0, 1)
+            rb_set_i32(buf, 4, 2)
+            i = 0
+            while i < n:
+                write(w, 'line\\n')
+                i = i + 1
+            write_rb(w, buf, 4, 4)
+            close_writer(w)
+        """)
+        f = self.tmpdir.join('output.bin')
+        mod.foo(str(f), 3)
+        assert f.read_binary() == b'line\n' * 3 + b'\x02\0\0\0'
+        # more than the buffer
+        mod.foo(str(f), 20_000)
+        assert f.read_binary() == b'line\n' * 20_000 + b'\x02\0\0\0'
+
+    def test_invalid_utf8(self):
+        mod = self.compile(
+        """
+        from io import Reader, open_reader, readline
+
+        def foo(path: str) -> str:
+            r: Reader = open_reader(path)
+            return readline(r)
+        """)
+        f = self.tmpdir.join('input.txt')
+        f.write_binary(b'abc\xff\n')
+        with pytest.raises(SPyPanicError, match='invalid utf-8'):
+            mod.foo(str(f))
+        with pytest.raises(SPyPanicError, match='cannot open file'):
+            mod.foo(str(self.tmpdir.join('nonexistent')))
+
+    def test_read_batch(self):
+        mod = self.compile(
+        """
+        from rawbuffer import RawBuffer, rb_alloc, rb_get_i32
+        from io import (ReadBatch, read_batch, submit_read, wait_any,
+                        wait_all, read_result, close_batch)
+
+        # read the n i32 of the file in reverse order, one per read
+        def read_all(path: str, n: i32) -> i32:
+            b: ReadBatch = read_batch()
+            buf: RawBuffer = rb_alloc(4 * n)
+            i = 0
+            while i < n:
+                submit_read(b, path, buf, 4 * i, 4, 4 * (n - 1 - i))
+                i = i + 1
+            total = 0
+            count = 0
+            read_id = wait_any(b)
+            while read_id != -1:
+                total = total + rb_get_i32(buf, 4 * read_id) * read_id
+                count = count + read_result(b, read_id)
+                read_id = wait_any(b)
+            close_batch(b)
+            if count != 4 * n:
+                return -1
+            return total
+
+        def read_tail(path: str) -> i32:
+            b: ReadBatch = read_batch()
+            buf: RawBuffer = rb_alloc(100)
+            read_id = submit_read(b, path, buf, 0, 100, 8)
+            wait_all(b)
+            res = read_result(b, read_id)
+            close_batch(b)
+            return res
+        """)
+        n = 300
+        f = self.tmpdir.join('data')
+        f.write_binary(struct.pack(f'{n}i', *range(n)))
+        expected = sum((n - 1 - i) * i for i in range(n))
+        assert mod.read_all(str(f), n) == expected
+        # only 4 bytes after the offset
+        f.write_binary(struct.pack('iii', 1, 2, 3))
+        assert mod.read_tail(str(f)) == 4
+
+
+# read_stream works also on wasm32, where the host provides the streams
+class TestReadStream(CompilerTest):
+
+    def add_stream(self, mod: Any, data: bytes) -> int:
+        if self.backend == 'C':
+            libspy = mod.ll.libspy
+        else:
+            libspy = self.vm.ll.libspy
+        return libspy.add_stream(io.BytesIO(data))
+
+    def test_read_stream(self):
+        mod = self.compile(
+        """
+        from rawbuffer import RawBuffer, rb_alloc, rb_get_i32
+        from io import read_stream
+
+        def sum_stream(stream: i32) -> i32:
+            buf: RawBuffer = rb_alloc(16)
+            total = 0
+            n = read_stream(stream, buf, 0, 16)
+            while n == 16:
+                total = total + rb_get_i32(buf, 0) + rb_get_i32(buf, 4)
+                total = total + rb_get_i32(buf, 8) + rb_get_i32(buf, 12)
+                n = read_stream(stream, buf, 0, 16)
+            return total * 100 + n
+
+        def read_invalid() -> i32:
+            buf: RawBuffer = rb_alloc(16)
+            return read_stream(42, buf, 0, 16)
+        """)
+        stream = self.add_stream(mod, struct.pack('10i', *range(10)))
+        assert mod.sum_stream(stream) == sum(range(8)) * 100 + 8
+        with pytest.raises(SPyPanicError, match='invalid stream'):
+            mod.read_invalid()
@@ -2,7 +2,7 @@
 
 import pytest
 from spy.vm.object import W_Type
-from spy.tests.support import CompilerTest, only_interp
+from spy.tests.support import CompilerTest, only_interp, no_C
 
 @only_interp
 class TestList(CompilerTest):
@@ -50,3 +50,23 @@ class TestList(CompilerTest):
         """)
         assert mod.foo(0) == [10, 1, 2]
         assert mod.foo(1) == [0, 11, 2]
+
+
+# lists are not supported by the C backend yet, but they can already be
+# prebuilt constants
+@no_C
+class TestPrebuiltList(CompilerTest):
+
+    def test_prebuilt(self):
+        mod = self.compile(
+        """
+        @blue
+        def make_names():
+            return ["foo", "bar", "baz"]
+
+        def foo(i: i32) -> str:
+            names: list[str] = make_names()
+            return names[i]
+        """)
+        assert mod.foo(0) == "foo"
+        assert mod.foo(2) == "baz"
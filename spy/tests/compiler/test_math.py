@@ -0,0 +1,70 @@
+import math
+from spy.tests.support import CompilerTest
+
+class TestMath(CompilerTest):
+
+    def test_rounding(self):
+        mod = self.compile("""
+        from math import floor, ceil, trunc
+
+        def f(x: f64) -> f64:
+            return floor(x)
+
+        def c(x: f64) -> f64:
+            return ceil(x)
+
+        def t(x: f64) -> f64:
+            return trunc(x)
+        """)
+        assert mod.f(2.5) == 2.0
+        assert mod.f(-2.5) == -3.0
+        assert mod.c(2.5) == 3.0
+        assert mod.c(-2.5) == -2.0
+        assert mod.t(2.5) == 2.0
+        assert mod.t(-2.5) == -2.0
+        assert math.copysign(1.0, mod.t(-0.5)) == -1.0
+
+    def test_sqrt_fabs_copysign(self):
+        mod = self.compile("""
+        from math import sqrt, fabs, copysign
+
+        def hypot(x: f64, y: f64) -> f64:
+            return sqrt(x*x + y*y)
+
+        def s(x: f64) -> f64:
+            return sqrt(x)
+
+        def a(x: f64) -> f64:
+            return fabs(x)
+
+        def cs(x: f64, y: f64) -> f64:
+            return copysign(x, y)
+        """)
+        assert mod.hypot(3.0, 4.0) == 5.0
+        assert math.isnan(mod.s(-1.0))
+        assert mod.a(-1.5) == 1.5
+        assert mod.cs(2.0, -0.0) == -2.0
+
+    def test_min_max(self):
+        mod = self.compile("""
+        from math import min, max
+
+        def clamp(x: f64, lo: f64, hi: f64) -> f64:
+            return min(max(x, lo), hi)
+        """)
+        assert mod.clamp(5.0, 0.0, 1.0) == 1.0
+        assert mod.clamp(-5.0, 0.0, 1.0) == 0.0
+        assert mod.clamp(0.5, 0.0, 1.0) == 0.5
+
+    def test_fma(self):
+        mod = self.compile("""
+        from math import fma
+
+        def foo(a: f64, b: f64, c: f64) -> f64:
+            return fma(a, b, c)
+        """)
+        assert mod.foo(2.0, 3.0, 1.0) == 7.0
+        # a*b is rounded only once: the result is the rounding error of
+        # a*a, which would be 0 without fma
+        a = 1.0 + 2.0**-30
+        assert mod.foo(a, a, -(a*a)) == 2.0**-60
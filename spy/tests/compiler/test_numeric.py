@@ -0,0 +1,207 @@
+import struct
+import pytest
+from spy.libspy import SPyPanicError
+from spy.tests.support import CompilerTest, expect_errors
+
+class TestNumeric(CompilerTest):
+
+    def test_i64(self):
+        mod = self.compile("""
+        def fact(n: i64) -> i64:
+            res: i64 = 1
+            while n > 1:
+                res = res * n
+                n = n - 1
+            return res
+
+        def big() -> i64:
+            return 5000000000 + 1
+        """)
+        assert mod.fact(20) == 2432902008176640000
+        assert mod.big() == 5000000001
+
+    def test_wraparound(self):
+        mod = self.compile("""
+        def add_u8(x: u8, y: u8) -> u8:
+            return x + y
+
+        def mul_u16(x: u16, y: u16) -> u16:
+            return x * y
+
+        def sub_u32(x: u32, y: u32) -> u32:
+            return x - y
+
+        def add_i8(x: i8, y: i8) -> i8:
+            return x + y
+
+        def cmp_u8(x: u8, y: u8) -> bool:
+            return x + y < x
+        """)
+        assert mod.add_u8(250, 10) == 4
+        assert mod.mul_u16(65535, 65535) == 1
+        assert mod.sub_u32(0, 1) == 2**32 - 1
+        assert mod.add_i8(127, 1) == -128
+        assert mod.cmp_u8(250, 10) is True
+        assert mod.cmp_u8(25, 10) is False
+
+    def test_signed_overflow(self):
+        # in C, the overflow of signed integers must wrap around as well
+        mod = self.compile("""
+        def add_i64(x: i64, y: i64) -> i64:
+            return x + y
+
+        def sub_i64(x: i64, y: i64) -> i64:
+            return x - y
+
+        def mul_i64(x: i64, y: i64) -> i64:
+            return x * y
+
+        def mul_i16(x: i16, y: i16) -> i16:
+            return x * y
+        """)
+        assert mod.add_i64(2**63 - 1, 1) == -2**63
+        assert mod.sub_i64(-2**63, 1) == 2**63 - 1
+        assert mod.mul_i64(2**62, 4) == 0
+        assert mod.mul_i64(-3037000500, 3037000500) == 9223372036709301616
+        assert mod.mul_i16(-32768, -1) == -32768
+
+    def test_division(self):
+        # integer division rounds towards negative infinity
+        mod = self.compile("""
+        def div_i8(x: i8, y: i8) -> i8:
+            return x / y
+
+        def div_i16(x: i16, y: i16) -> i16:
+            return x / y
+
+        def div_i64(x: i64, y: i64) -> i64:
+            return x / y
+
+        def div_u8(x: u8, y: u8) -> u8:
+            return x / y
+        """)
+        assert mod.div_i8(-7, 2) == -4
+        assert mod.div_i8(7, -2) == -4
+        assert mod.div_i8(-7, -2) == 3
+        assert mod.div_i8(-8, 2) == -4
+        assert mod.div_i8(-128, -1) == -128
+        assert mod.div_i16(-7, 2) == -4
+        assert mod.div_i16(-32768, -1) == -32768
+        assert mod.div_i64(-7, 2) == -4
+        assert mod.div_i64(7, 2) == 3
+        assert mod.div_i64(-2**63, -1) == -2**63
+        assert mod.div_i64(-2**63, 3) == -3074457345618258603
+        assert mod.div_u8(255, 2) == 127
+
+    def test_f32(self):
+        mod = self.compile("""
+        def foo(x: f32) -> f32:
+            return x * 3.0 + 1
+
+        def to_f64(x: f32) -> f64:
+            return x
+        """)
+        assert mod.foo(0.5) == 2.5
+        # the result is rounded to single precision
+        assert mod.foo(0.1) == struct.unpack('f', struct.pack('f', 1.3))[0]
+        assert mod.to_f64(0.1) == 0.10000000149011612
+
+    def test_literals(self):
+        mod = self.compile("""
+        def foo() -> u8:
+            x: u8 = 200
+            return x + 55
+
+        def bar(x: i16) -> i16:
+            return x * -2
+
+        def baz() -> u64:
+            return 18446744073709551615
+        """)
+        assert mod.foo() == 255
+        assert mod.bar(100) == -200
+        assert mod.baz() == 2**64 - 1
+
+    def test_implicit_conversions(self):
+        mod = self.compile("""
+        def widen(a: u8, b: i16, c: u16, d: i32, e: u32) -> i64:
+            x: i32 = a
+            y: i32 = b
+            z: i64 = d
+            return x + y + z + c + e
+
+        def to_float(a: u16, b: i16) -> f64:
+            x: f32 = a
+            return x + b
+        """)
+        assert mod.widen(1, -2, 3, 4, 2**32 - 1) == 2**32 + 5
+        assert mod.to_float(3, 4) == 7.0
+
+    def test_lossy_conversion(self):
+        src = """
+        def foo() -> u8:
+            x: i32 = 1
+            return x
+        """
+        errors = expect_errors(
+            'mismatched types',
+            ('expected `u8`, got `i32`', 'x'),
+        )
+        self.compile_raises(src, 'foo', errors)
+
+    def test_literal_out_of_range(self):
+        src = """
+        def foo() -> u8:
+            return 256
+        """
+        errors = expect_errors(
+            'mismatched types',
+            ('expected `u8`, got `i32`', '256'),
+        )
+        self.compile_raises(src, 'foo', errors)
+
+    def test_explicit_conversions(self):
+        mod = self.compile("""
+        def to_u8(x: i32) -> u8:
+            return u8(x)
+
+        def to_i32(x: f64) -> i32:
+            return i32(x)
+
+        def to_f32(x: f64) -> f32:
+            return f32(x)
+
+        def roundtrip(x: i64) -> i64:
+            return i64(i16(x))
+        """)
+        assert mod.to_u8(-1) == 255
+        assert mod.to_u8(300) == 44
+        assert mod.to_i32(-3.9) == -3
+        assert mod.to_f32(0.1) == 0.10000000149011612
+        assert mod.roundtrip(70000) == 4464
+
+    def test_rawbuffer(self):
+        mod = self.compile("""
+        from rawbuffer import (RawBuffer, rb_alloc, rb_set_u8, rb_get_u8,
+                               rb_set_i16, rb_set_f32, rb_get_f32,
+                               rb_set_i64, rb_get_i64)
+
+        def foo() -> RawBuffer:
+            buf: RawBuffer = rb_alloc(16)
+            rb_set_u8(buf, 0, 255)
+            rb_set_u8(buf, 1, rb_get_u8(buf, 0) + 2)
+            rb_set_i16(buf, 2, -3)
+            rb_set_f32(buf, 4, 1.5)
+            rb_set_i64(buf, 8, 10000000000)
+            return buf
+
+        def bar() -> f64:
+            buf: RawBuffer = rb_alloc(8)
+            rb_set_f32(buf, 0, 0.25)
+            rb_set_i64(buf, 0, rb_get_i64(buf, 0) * 2)
+            return rb_get_f32(buf, 0)
+        """)
+        rb = mod.foo()
+        assert struct.unpack('BBhfq', rb) == (255, 1, -3, 1.5, 10000000000)
+        # 0.25f is 0x3e800000: multiplying by 2 shifts the exponent
+        assert mod.bar() == struct.unpack('f', struct.pack('I', 0x7d000000))[0]
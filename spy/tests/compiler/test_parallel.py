@@ -0,0 +1,140 @@
+import pytest
+from spy.tests.support import CompilerTest, expect_errors
+
+class TestParallel(CompilerTest):
+
+    def test_sum(self):
+        mod = self.compile("""
+        def foo(n: i32) -> i32:
+            acc = 0
+            for i in parallel_range(n):
+                acc = acc + i
+            return acc
+        """)
+        assert mod.foo(0) == 0
+        assert mod.foo(1000) == sum(range(1000))
+
+    def test_schedules(self):
+        mod = self.compile("""
+        def f_static(n: i32) -> f64:
+            acc = 1.0
+            for i in parallel_range(n):
+                acc = acc * 2.0
+            return acc
+
+        def f_dynamic(n: i32) -> i32:
+            acc = 0
+            for i in parallel_range(n, 'dynamic'):
+                acc = acc + i * 2
+            return acc
+
+        def f_guided(n: i32) -> i32:
+            acc = 0
+            for i in parallel_range(n, schedule='guided'):
+                acc = acc + 1
+            return acc
+        """)
+        assert mod.f_static(10) == 1024.0
+        assert mod.f_dynamic(100) == sum(range(100)) * 2
+        assert mod.f_guided(1234) == 1234
+
+    def test_rawbuffer_kernel(self):
+        mod = self.compile("""
+        from rawbuffer import RawBuffer, rb_alloc, rb_set_f64, rb_get_f64
+
+        def foo(n: i32, k: f64) -> f64:
+            buf: RawBuffer = rb_alloc(n * 8)
+            for i in parallel_range(n, 'dynamic'):
+                x = i * k
+                rb_set_f64(buf, i * 8, x)
+            total = 0.0
+            for i in parallel_range(n):
+                total = total + rb_get_f64(buf, i * 8)
+            return total
+        """)
+        assert mod.foo(100, 0.5) == sum(range(100)) * 0.5
+
+    def test_nested(self):
+        mod = self.compile("""
+        def foo(n: i32, m: i32) -> i32:
+            acc = 0
+            for i in parallel_range(n):
+                for j in parallel_range(m):
+                    acc = acc + i * j
+            return acc
+        """)
+        assert mod.foo(10, 20) == sum(range(10)) * sum(range(20))
+
+    def test_loop_var_shadows_global(self):
+        src = """
+        var i: i32 = 100
+
+        def foo(n: i32) -> i32:
+            acc = 0
+            for i in parallel_range(n):
+                acc = acc + i
+            return acc
+        """
+        errors = expect_errors(
+            'variable `i` shadows a name declared in an outer scope',
+            ('this is the new declaration', 'i'),
+            ('this is the previous declaration', 'var i: i32 = 100'),
+        )
+        self.compile_raises(src, 'foo', errors, error_reporting='eager')
+
+    def test_shared_var(self):
+        src = """
+        def foo(n: i32) -> i32:
+            x = 0
+            for i in parallel_range(n):
+                x = i
+            return x
+        """
+        errors = expect_errors(
+            '`x` is shared between the iterations of the loop',
+            ('assigned here', 'x'),
+            ('used outside the loop here', 'x'),
+        )
+        self.compile_raises(src, 'foo', errors, error_reporting='eager')
+
+    def test_loop_var_used_outside(self):
+        src = """
+        def foo(n: i32) -> i32:
+            for i in parallel_range(n):
+                pass
+            return i
+        """
+        errors = expect_errors(
+            'loop variable `i` is used outside the loop',
+            ('this is the loop variable', 'i'),
+            ('used here', 'i'),
+        )
+        self.compile_raises(src, 'foo', errors, error_reporting='eager')
+
+    def test_invalid_schedule(self):
+        src = """
+        def foo(n: i32) -> void:
+            for i in parallel_range(n, 'random'):
+                pass
+        """
+        errors = expect_errors(
+            'invalid schedule',
+            ("expected 'static', 'dynamic' or 'guided'", "'random'"),
+        )
+        self.compile_raises(src, 'foo', errors, error_reporting='eager')
+
+    def test_str_reduction(self):
+        src = """
+        def foo() -> str:
+            s = ''
+            for i in parallel_range(3):
+                s = s + 'a'
+            return s
+        """
+        errors = expect_errors(
+            'cannot use `s` as a reduction variable',
+            ('this is `str`, but only `i32` and `f64` are supported',
+             "s = ''"),
+            ('reduction in this loop', 'i'),
+        )
+        self.compile_raises(src, 'foo', errors)
@@ -45,3 +45,65 @@ class TestRawBuffer(CompilerTest):
         rb = mod.foo()
         assert isinstance(rb, bytearray)
         assert struct.unpack('iid', rb) == (12, 34, 56.7)
+
+    def test_prebuilt(self):
+        mod = self.compile(
+        """
+        from rawbuffer import RawBuffer, rb_alloc, rb_set_i32, rb_get_i32
+
+        @blue
+        def make_squares():
+            buf: RawBuffer = rb_alloc(4 * 10)
+            i = 0
+            while i < 10:
+                rb_set_i32(buf, 4 * i, i * i)
+                i = i + 1
+            return buf
+
+        SQUARES = make_squares()
+
+        def square(i: i32) -> i32:
+            return rb_get_i32(make_squares(), 4 * i)
+
+        def square2(i: i32) -> i32:
+            return rb_get_i32(SQUARES, 4 * i)
+        """)
+        assert mod.square(0) == 0
+        assert mod.square(7) == 49
+        assert mod.square(9) == 81
+        assert mod.square2(9) == 81
+
+    def test_prebuilt_write(self):
+        # prebuilt RawBuffers are writable: this must not put them in the
+        # read-only section of the C binary
+        mod = self.compile(
+        """
+        from rawbuffer import RawBuffer, rb_alloc, rb_set_i32, rb_get_i32
+
+        @blue
+        def make_counters():
+            buf: RawBuffer = rb_alloc(4)
+            rb_set_i32(buf, 0, 100)
+            return buf
+
+        @blue
+        def make_global():
+            buf: RawBuffer = rb_alloc(4)
+            rb_set_i32(buf, 0, 200)
+            return buf
+
+        BUF = make_global()
+
+        def incr_prebuilt() -> i32:
+            buf: RawBuffer = make_counters()
+            rb_set_i32(buf, 0, rb_get_i32(buf, 0) + 1)
+            return rb_get_i32(make_counters(), 0)
+
+        def incr_global() -> i32:
+            rb_set_i32(BUF, 0, rb_get_i32(BUF, 0) + 1)
+            return rb_get_i32(BUF, 0)
+        """)
+        assert mod.incr_prebuilt() == 101
+        assert mod.incr_prebuilt() == 102
+        assert mod.incr_global() == 201
+        assert mod.incr_global() == 202
@@ -0,0 +1,114 @@
+import pytest
+from spy.libspy import SPyPanicError
+from spy.tests.support import CompilerTest
+
+class TestSIMD(CompilerTest):
+
+    def test_f64x2(self):
+        mod = self.compile("""
+        from simd import make_f64x2, splat_f64x2, sum_f64x2
+
+        def foo(x: f64, y: f64) -> f64:
+            a: f64x2 = make_f64x2(x, y)
+            b: f64x2 = splat_f64x2(2.0)
+            c = (a + b) * a - b / b
+            return c[0] * 100.0 + c[1]
+
+        def hsum(x: f64, y: f64) -> f64:
+            return sum_f64x2(make_f64x2(x, y))
+        """)
+        # c = [(1+2)*1 - 1, (3+2)*3 - 1] = [2, 14]
+        assert mod.foo(1.0, 3.0) == 214.0
+        assert mod.hsum(1.5, 2.25) == 3.75
+
+    def test_f32x4(self):
+        mod = self.compile("""
+        from simd import make_f32x4, splat_f32x4, sum_f32x4
+
+        def foo(x: f64) -> f64:
+            a: f32x4 = make_f32x4(x, 1.0, 2.0, 3.0)
+            b: f32x4 = a * splat_f32x4(0.5) + a
+            return sum_f32x4(b - splat_f32x4(1.0))
+
+        def lane(x: f64) -> f64:
+            a: f32x4 = make_f32x4(0.0, 0.0, x, 0.0)
+            return a[2]
+        """)
+        assert mod.foo(4.0) == 11.0
+        # the lanes are single precision
+        assert mod.lane(0.1) == 0.10000000149011612
+
+    def test_i32x4(self):
+        mod = self.compile("""
+        from simd import make_i32x4, splat_i32x4, sum_i32x4
+
+        def foo(x: i32) -> i32:
+            a: i32x4 = make_i32x4(x, 2, 3, 4)
+            b: i32x4 = a * a - splat_i32x4(1)
+            return b[0] + b[1] + b[2] + b[3]
+
+        def overflow() -> i32:
+            a: i32x4 = splat_i32x4(2147483647)
+            return (a + splat_i32x4(1))[0]
+
+        def hsum(x: i32) -> i32:
+            return sum_i32x4(make_i32x4(x, x, 1, 2))
+        """)
+        assert mod.foo(1) == 0 + 3 + 8 + 15
+        assert mod.overflow() == -2147483648
+        assert mod.hsum(10) == 23
+
+    def test_rawbuffer(self):
+        mod = self.compile("""
+        from rawbuffer import (RawBuffer, rb_alloc, rb_set_f64, rb_get_f64,
+                               rb_get_f64x2, rb_set_f64x2, rb_set_i32,
+                               rb_get_i32x4)
+        from simd import splat_f64x2, sum_f64x2, sum_i32x4
+
+        def axpy(n: i32) -> f64:
+            # y = 2*x + y, two lanes at a time; 24 is not aligned to 16
+            x: RawBuffer = rb_alloc(24 + n * 8)
+            y: RawBuffer = rb_alloc(24 + n * 8)
+            i = 0
+            while i < n:
+                rb_set_f64(x, 24 + i * 8, i * 1.0)
+                rb_set_f64(y, 24 + i * 8, 1.0)
+                i = i + 1
+            a: f64x2 = splat_f64x2(2.0)
+            v: f64x2 = a
+            i = 0
+            while i < n:
+                off = 24 + i * 8
+                v = a * rb_get_f64x2(x, off) + rb_get_f64x2(y, off)
+                rb_set_f64x2(y, off, v)
+                i = i + 2
+            total = 0.0
+            i = 0
+            while i < n:
+                total = total + rb_get_f64(y, 24 + i * 8)
+                i = i + 1
+            return total
+
+        def load_i32x4() -> i32:
+            buf: RawBuffer = rb_alloc(20)
+            i = 0
+            while i < 5:
+                rb_set_i32(buf, i * 4, i * 10)
+                i = i + 1
+            return sum_i32x4(rb_get_i32x4(buf, 4))
+        """)
+        # sum(2*i + 1 for i in range(8))
+        assert mod.axpy(8) == 64.0
+        assert mod.load_i32x4() == 10 + 20 + 30 + 40
+
+    def test_index_out_of_bounds(self):
+        mod = self.compile("""
+        from simd import splat_f64x2
+
+        def foo(i: i32) -> f64:
+            v: f64x2 = splat_f64x2(1.0)
+            return v[i]
+        """)
+        assert mod.foo(1) == 1.0
+        with pytest.raises(SPyPanicError, match='vector index out of bounds'):
+            mod.foo(2)
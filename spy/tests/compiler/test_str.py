@@ -1,8 +1,10 @@
 #-*- encoding: utf-8 -*-
 
+import bisect
 import pytest
 from spy.libspy import SPyPanicError
-from spy.tests.support import CompilerTest, skip_backends, no_backend
+from spy.tests.support import (CompilerTest, skip_backends, no_backend,
+                               expect_errors, only_interp)
 
 class TestStr(CompilerTest):
 
@@ -64,6 +66,98 @@ class TestStr(CompilerTest):
         with pytest.raises(SPyPanicError, match="string index out of bound"):
             mod.foo('ABCDE', -6)
 
+    def test_slice(self):
+        mod = self.compile(
+        """
+        def slice(s: str, a: i32, b: i32) -> str:
+            return s[a:b]
+
+        def head(s: str, b: i32) -> str:
+            return s[:b]
+
+        def tail(s: str, a: i32) -> str:
+            return s[a:]
+
+        def middle(s: str) -> str:
+            t: str = s[10:-10]
+            return t[5:-5]
+        """)
+        assert mod.slice('hello world', 0, 5) == 'hello'
+        assert mod.slice('hello world', 6, 100) == 'world'
+        assert mod.slice('hello world', -5, -1) == 'worl'
+        assert mod.slice('hello world', -100, 2) == 'he'
+        assert mod.slice('hello world', 5, 2) == ''
+        assert mod.head('hello world', 4) == 'hell'
+        assert mod.tail('hello world', 4) == 'o world'
+        assert mod.tail('hello world', -3) == 'rld'
+        # long enough to be views
+        s = 'abcdefghijklmnopqrstuvwxyz' * 4
+        assert mod.slice(s, 3, 90) == s[3:90]
+        assert mod.middle(s) == s[10:-10][5:-5]
+
+    def test_split(self):
+        mod = self.compile(
+        """
+        def length(s: str, sep: str) -> i32:
+            parts = s.split(sep)
+            return parts.length()
+
+        def item(s: str, sep: str, i: i32) -> str:
+            parts = s.split(sep)
+            return parts[i]
+
+        def count_fields(s: str, field: str) -> i32:
+            parts: StrSplit = s.split(',')
+            n = parts.length()
+            i = 0
+            res = 0
+            while i < n:
+                if parts[i] == field:
+                    res = res + 1
+                i = i + 1
+            return res
+        """)
+        assert mod.length('a,b,,c', ',') == 4
+        assert mod.length('', ',') == 1
+        assert mod.length('abc', 'abc') == 2
+        assert mod.item('a,b,,c', ',', 0) == 'a'
+        assert mod.item('a,b,,c', ',', 2) == ''
+        assert mod.item('a,b,,c', ',', -1) == 'c'
+        assert mod.item('one::two::three', '::', 1) == 'two'
+        s = '\n'.join(['line %d' % i + 'x' * i for i in range(50)])
+        assert mod.item(s, '\n', 42) == 'line 42' + 'x' * 42
+        assert mod.count_fields('x,yy,x,,x', 'x') == 3
+        assert mod.count_fields('x,yy,x,,x', '') == 1
+        with pytest.raises(SPyPanicError, match="split index out of bound"):
+            mod.item('a,b', ',', 2)
+        with pytest.raises(SPyPanicError, match="empty separator"):
+            mod.length('a,b', '')
+
+    def test_join(self):
+        mod = self.compile(
+        """
+        def replace(s: str, old: str, new: str) -> str:
+            return new.join(s.split(old))
+        """)
+        assert mod.replace('a,b,,c', ',', ' - ') == 'a - b -  - c'
+        assert mod.replace('abc', ',', '-') == 'abc'
+        assert mod.replace('', ',', '-') == ''
+        assert mod.replace(',', ',', '') == ''
+
+    @only_interp
+    def test_join_list(self):
+        mod = self.compile(
+        """
+        def foo(sep: str) -> str:
+            return sep.join(['a', 'bb', 'ccc'])
+
+        def one() -> str:
+            return '-'.join(['a'])
+        """)
+        assert mod.foo(', ') == 'a, bb, ccc'
+        assert mod.foo('') == 'abbccc'
+        assert mod.one() == 'a'
+
     def test_compare(self):
         mod = self.compile(
         """
@@ -77,3 +171,239 @@ class TestStr(CompilerTest):
         assert not mod.eq("aaa", "bbb")
         assert mod.ne("aaa", "bbb")
         assert not mod.ne("aaa", "aaa")
+
+    def test_ordering(self):
+        mod = self.compile(
+        """
+        def lt(a: str, b: str) -> bool:
+            return a < b
+
+        def le(a: str, b: str) -> bool:
+            return a <= b
+
+        def gt(a: str, b: str) -> bool:
+            return a > b
+
+        def ge(a: str, b: str) -> bool:
+            return a >= b
+        """)
+        long_a = 'x' * 40 + 'a'
+        long_b = 'x' * 40 + 'b'
+        pairs = [('abc', 'abd'), ('abc', 'abc'), ('ab', 'abc'), ('', 'a'),
+                 ('b', 'abc'), (long_a, long_b), (long_a, 'x' * 40),
+                 ('z', 'à'), ('è', 'é')]
+        for a, b in pairs:
+            for x, y in [(a, b), (b, a)]:
+                assert mod.lt(x, y) == (x < y)
+                assert mod.le(x, y) == (x <= y)
+                assert mod.gt(x, y) == (x > y)
+                assert mod.ge(x, y) == (x >= y)
+
+    def test_bisect(self):
+        mod = self.compile(
+        """
+        def bisect(keys: str, key: str) -> i32:
+            # keys is a sorted comma-separated list: return the index of the
+            # first item which is >= key
+            parts = keys.split(',')
+            lo = 0
+            hi = parts.length()
+            while lo < hi:
+                mid = (lo + hi) / 2
+                if parts[mid] < key:
+                    lo = mid + 1
+                else:
+                    hi = mid
+            return lo
+        """)
+        words = sorted(['apple', 'banana', 'cherry', 'date', 'fig', 'grape',
+                        'kiwi', 'lemon', 'mango'])
+        keys = ','.join(words)
+        for key in words + ['', 'aaa', 'berry', 'zzz', 'kiwis']:
+            assert mod.bisect(keys, key) == bisect.bisect_left(words, key)
+
+    def test_to_int(self):
+        mod = self.compile(
+        """
+        def to_i32(s: str) -> i32:
+            return i32(s)
+
+        def to_i64(s: str) -> i64:
+            return i64(s)
+
+        def sum_fields(s: str) -> i32:
+            parts = s.split(',')
+            n = parts.length()
+            i = 0
+            res = 0
+            while i < n:
+                res = res + i32(parts[i])
+                i = i + 1
+            return res
+        """)
+        assert mod.to_i32('0') == 0
+        assert mod.to_i32('42') == 42
+        assert mod.to_i32('-42') == -42
+        assert mod.to_i32('  +0012345678\n') == 12345678
+        assert mod.to_i32('2147483647') == 2**31 - 1
+        assert mod.to_i32('-2147483648') == -2**31
+        assert mod.to_i64('9223372036854775807') == 2**63 - 1
+        assert mod.to_i64('-9223372036854775808') == -2**63
+        assert mod.to_i64('-00000000000000000000001234567890123') == \
+            -1234567890123
+        assert mod.sum_fields('1,22,333,-4') == 352
+        for s in ['', ' ', '-', '1 2', '0x10', '1_000', '12a', '1.0']:
+            with pytest.raises(SPyPanicError, match="invalid literal for i32"):
+                mod.to_i32(s)
+        for s in ['2147483648', '-2147483649', '99999999999999999999']:
+            with pytest.raises(SPyPanicError, match="out of range for i32"):
+                mod.to_i32(s)
+        for s in ['9223372036854775808', '-9223372036854775809',
+                  '123456789012345678901234567890']:
+            with pytest.raises(SPyPanicError, match="out of range for i64"):
+                mod.to_i64(s)
+
+    def test_to_float(self):
+        mod = self.compile(
+        """
+        def to_f64(s: str) -> f64:
+            return f64(s)
+        """)
+        tests = ['0', '1.5', '-2.25', '  1e10 ', '.5', '5.', '1E-5', '+3.0e+2',
+                 '0.1', '3.141592653589793', '1.7976931348623157e308',
+                 '1e400', '-1e400', '1e-400', '5e-324', '2.2250738585072011e-308',
+                 '9007199254740993', '123456789012345678901234567890',
+                 '1.00000000000000011102230246251565404236316680908203125',
+                 '0.000000000000000000000000000000000000000000001e45',
+                 'inf', '-Infinity', 'INF']
+        for s in tests:
+            assert mod.to_f64(s) == float(s)
+        assert str(mod.to_f64('-0.0')) == '-0.0'
+        assert str(mod.to_f64('nan')) == 'nan'
+        for s in ['', '.', '-', 'e5', '1e', '1.5.2', '1_0', 'infinit', '0x1p3']:
+            with pytest.raises(SPyPanicError, match="could not convert"):
+                mod.to_f64(s)
+
+    def test_hash(self):
+        mod = self.compile(
+        """
+        def h(s: str) -> i64:
+            return hash(s)
+
+        def h_slice(s: str, i: i32, j: i32) -> i64:
+            return hash(s[i:j])
+
+        def h_twice(s: str) -> bool:
+            # the second time it comes from the cache
+            return hash(s) == hash(s)
+        """)
+        # the hash is the same in all backends
+        assert mod.h('') == -7844555533835123294
+        assert mod.h('hello') == 5306810434294928543
+        assert mod.h('hello world' * 10) == -4444507860721954502
+        assert mod.h_slice('say hello', 4, 9) == mod.h('hello')
+        assert mod.h('hello') != mod.h('hellp')
+        assert mod.h_twice('hello world' * 10)
+
+    def test_prebuilt(self):
+        mod = self.compile(
+        """
+        @blue
+        def make_digits():
+            return '0123456789' * 3
+
+        DIGITS = make_digits()
+
+        def foo() -> str:
+            return DIGITS
+
+        def bar(i: i32) -> str:
+            s: str = make_digits()
+            return s[i]
+        """)
+        assert mod.foo() == '0123456789' * 3
+        assert mod.bar(25) == '5'
+
+    def test_find_count(self):
+        mod = self.compile(
+        """
+        def find(s: str, sub: str) -> i32:
+            return s.find(sub)
+
+        def count(s: str, sub: str) -> i32:
+            return s.count(sub)
+        """)
+        assert mod.find('hello world', 'o') == 4
+        assert mod.find('hello world', 'world') == 6
+        assert mod.find('hello world', 'xyz') == -1
+        assert mod.find('hello', '') == 0
+        assert mod.find('', 'a') == -1
+        assert mod.find('ab', 'abc') == -1
+        # long enough to use more than one SIMD block
+        s = 'abcdefghij' * 10 + 'needle' + 'klm'
+        assert mod.find(s, 'needle') == 100
+        assert mod.find(s, 'needlf') == -1
+        assert mod.find(s, 'mkl') == -1
+        assert mod.find(s, 'klm') == 106
+        assert mod.find(s, 'jab') == 9
+        assert mod.count(s, 'abc') == 10
+        assert mod.count('aaaa', 'aa') == 2
+        assert mod.count('hello', '') == 6
+        assert mod.count('hello', 'xyz') == 0
+
+    def test_startswith_endswith(self):
+        mod = self.compile(
+        """
+        def sw(s: str, prefix: str) -> bool:
+            return s.startswith(prefix)
+
+        def ew(s: str, suffix: str) -> bool:
+            return s.endswith(suffix)
+        """)
+        assert mod.sw('hello', 'he')
+        assert mod.sw('hello', '')
+        assert not mod.sw('hello', 'lo')
+        assert not mod.sw('he', 'hello')
+        assert mod.ew('hello', 'lo')
+        assert mod.ew('hello', '')
+        assert not mod.ew('hello', 'he')
+        assert not mod.ew('lo', 'hello')
+
+    def test_in(self):
+        mod = self.compile(
+        """
+        def contains(s: str, sub: str) -> bool:
+            return sub in s
+
+        def not_contains(s: str, sub: str) -> bool:
+            return sub not in s
+        """)
+        assert mod.contains('hello world', 'o w')
+        assert mod.contains('hello world', '')
+        assert not mod.contains('hello world', 'O')
+        assert mod.not_contains('hello world', 'O')
+        assert not mod.not_contains('hello world', 'world')
+
+    def test_method_not_found(self):
+        src = """
+        def foo() -> i32:
+            s: str = 'hello'
+            return s.upper()
+        """
+        errors = expect_errors(
+            "type `str` has no attribute 'upper'",
+            ('this is `str`', 's'),
+        )
+        self.compile_raises(src, "foo", errors)
+
+    def test_method_wrong_argtype(self):
+        src = """
+        def foo() -> i32:
+            s: str = 'hello'
+            return s.find(42)
+        """
+        errors = expect_errors(
+            'mismatched types',
+            ('expected `str`, got `i32`', '42'),
+        )
+        self.compile_raises(src, "foo", errors)
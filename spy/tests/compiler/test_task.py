@@ -0,0 +1,102 @@
+import pytest
+from spy.libspy import SPyPanicError
+from spy.tests.support import CompilerTest, expect_errors, skip_backends
+
+class TestTask(CompilerTest):
+
+    def test_spawn_join(self):
+        mod = self.compile("""
+        def add(x: i32, y: i32) -> i32:
+            return x + y
+
+        def foo(x: i32) -> i32:
+            t = spawn(add, x, 1)
+            return join(t) * 2
+        """)
+        assert mod.foo(20) == 42
+
+    def test_fib(self):
+        mod = self.compile("""
+        def fib(n: i32) -> i32:
+            if n < 2:
+                return n
+            t = spawn(fib, n - 1)
+            b = fib(n - 2)
+            return join(t) + b
+        """)
+        assert mod.fib(15) == 610
+
+    def test_result_types(self):
+        mod = self.compile("""
+        def half(x: f64) -> f64:
+            return x / 2.0
+
+        def greet(name: str) -> str:
+            return 'hello ' + name
+
+        def foo(x: f64) -> f64:
+            t1 = spawn(half, x)
+            t2 = spawn(half, x + 1.0)
+            return join(t1) + join(t2)
+
+        def bar() -> str:
+            return join(spawn(greet, 'world'))
+        """)
+        assert mod.foo(3.0) == 3.5
+        assert mod.bar() == 'hello world'
+
+    def test_void_task(self):
+        mod = self.compile("""
+        from rawbuffer import RawBuffer, rb_alloc, rb_set_i32, rb_get_i32
+
+        def fill(buf: RawBuffer, i: i32, x: i32) -> void:
+            rb_set_i32(buf, i * 4, x)
+
+        def foo() -> i32:
+            buf: RawBuffer = rb_alloc(8)
+            t0 = spawn(fill, buf, 0, 10)
+            t1 = spawn(fill, buf, 1, 32)
+            join(t0)
+            join(t1)
+            return rb_get_i32(buf, 0) + rb_get_i32(buf, 4)
+        """)
+        assert mod.foo() == 42
+
+    @skip_backends('C', reason='join frees the task, so this is UB in C')
+    def test_join_twice(self):
+        mod = self.compile("""
+        def inc(x: i32) -> i32:
+            return x + 1
+
+        def foo() -> i32:
+            t = spawn(inc, 41)
+            a = join(t)
+            return a + join(t)
+        """)
+        with pytest.raises(SPyPanicError, match='task already joined'):
+            mod.foo()
+
+    def test_wrong_args(self):
+        src = """
+        def inc(x: i32) -> i32:
+            return x + 1
+
+        def foo() -> i32:
+            return join(spawn(inc, 'hello'))
+        """
+        errors = expect_errors(
+            'mismatched types',
+            ('expected `i32`, got `str`', "'hello'"),
+        )
+        self.compile_raises(src, 'foo', errors)
+
+    def test_join_non_task(self):
+        src = """
+        def foo() -> i32:
+            return join(42)
+        """
+        errors = expect_errors(
+            'cannot call objects of type `Join`',
+            ('this is `Join`', 'join'),
+        )
+        self.compile_raises(src, 'foo', errors)
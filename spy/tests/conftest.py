@@ -1,8 +1,20 @@
 # type: ignore
 
+import pytest
 import py
 ROOT = py.path.local(__file__).dirpath()
 
+@pytest.fixture(scope='session', autouse=True)
+def parse_cache_dir(tmp_path_factory):
+    """
+    Don't pollute the user's parse cache with the thousands of modules which
+    we create during tests: use a per-session cache dir instead.
+    """
+    cachedir = tmp_path_factory.mktemp('spy-cache')
+    with pytest.MonkeyPatch.context() as mp:
+        mp.setenv('SPY_CACHE_DIR', str(cachedir))
+        yield cachedir
+
 def pytest_collection_modifyitems(session, config, items):
     """
     Reorder the test to have a "better" order. In particular:
@@ -63,3 +63,4 @@ class TestExpr:
         assert cstr(b'--"hello"--') == r'"--\"hello\"--"'
         assert cstr(rb'--aa\bb--') == r'"--aa\\bb--"'
         assert cstr(b'--\x00--\n--\xff--') == r'"--\x00--\x0a--\xff--"'
+        assert cstr(b'\x01a\x02-') == r'"\x01" "a\x02-"'
@@ -117,6 +117,17 @@ class TestSPyBackend(CompilerTest):
         self.compile(src)
         self.assert_dump(src)
 
+    def test_getslice(self):
+        src = """
+        def foo() -> void:
+            a = x[i:j]
+            b = x[:j]
+            c = x[i:]
+            d = x[:]
+        """
+        self.compile(src)
+        self.assert_dump(src)
+
     def test_setitem(self):
         src = """
         def foo() -> void:
@@ -162,6 +173,15 @@ class TestSPyBackend(CompilerTest):
         self.compile(src)
         self.assert_dump(src)
 
+    def test_in(self):
+        src = """
+        def foo() -> void:
+            a = x in y
+            b = x not in y
+        """
+        self.compile(src)
+        self.assert_dump(src)
+
     def test_zz_sanity_check(self):
         """
         This is a hack.
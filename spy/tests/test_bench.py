@@ -0,0 +1,32 @@
+import pytest
+from spy.bench.genmod import GenConfig, generate
+from spy.bench.scaling import PHASES, Pipeline, loglog_slope
+from spy.tests.support import CompilerTest
+
+class TestGenMod(CompilerTest):
+
+    def test_generated_module(self):
+        src = generate(GenConfig(n_funcs=8, n_strings=3, closure_width=4))
+        mod = self.compile(src)
+        #
+        def cg(i: int, x: int) -> int:
+            if i == 0:
+                return x
+            return cg(i-1, x) + cg(i//2, x) + i
+        assert mod.cg7(1) == cg(7, 1)
+        assert mod.lit5() == 'lit_5_0lit_5_1lit_5_2'
+        # make_adder(3)(x) + make_wide(3, 4, 5, 6)(x)
+        assert mod.spec3(10) == (10 + 3) + (10 + 3 + 4 + 5 + 6)
+
+
+def test_loglog_slope():
+    xs = [10.0, 20.0, 40.0, 80.0]
+    assert loglog_slope(xs, [x * 3 for x in xs]) == pytest.approx(1.0)
+    assert loglog_slope(xs, [x * x for x in xs]) == pytest.approx(2.0)
+
+def test_pipeline(tmpdir):
+    src = generate(GenConfig(n_funcs=4))
+    res = Pipeline(src, tmpdir, trace_memory=True).run()
+    assert list(res) == PHASES
+    assert all(r.peak_bytes > 0 for r in res.values())
+    assert tmpdir.join('genmod.c').check(file=True)
@@ -0,0 +1,138 @@
+import textwrap
+import pytest
+from spy.fqn import FQN
+from spy.location import Loc
+from spy.errors import SPyImportError
+from spy.vm.vm import SPyVM
+from spy.irgen import cache
+from spy.irgen.cache import cache_key, get_cache_dir
+from spy.irgen.symtable import SymTable, Symbol
+
+@pytest.mark.usefixtures('init')
+class TestParseCache:
+
+    @pytest.fixture
+    def init(self, tmpdir, monkeypatch):
+        self.tmpdir = tmpdir
+        self.cachedir = tmpdir.join('cache')
+        monkeypatch.setenv('SPY_CACHE_DIR', str(self.cachedir))
+
+    def write(self, src: str) -> None:
+        self.tmpdir.join('test.spy').write(textwrap.dedent(src))
+
+    def new_vm(self, new_process: bool = True) -> SPyVM:
+        # by default, simulate a new process by clearing the in-memory cache,
+        # so that we exercise the on-disk one
+        if new_process:
+            cache.MEMORY_CACHE.clear()
+        vm = SPyVM()
+        vm.path.append(str(self.tmpdir))
+        return vm
+
+    def forbid_parsing(self, monkeypatch):
+        def parse_and_analyze(*args):
+            raise AssertionError('cache miss')
+        monkeypatch.setattr(cache, 'parse_and_analyze', parse_and_analyze)
+
+    def test_get_cache_dir(self, monkeypatch):
+        assert get_cache_dir() == self.cachedir
+        monkeypatch.setenv('SPY_CACHE_DIR', '')
+        assert get_cache_dir() is None
+
+    def test_hit(self, monkeypatch):
+        self.write("""
+        from builtins import abs as my_abs
+
+        def foo(x: i32) -> i32:
+            return my_abs(x) + 1
+        """)
+        vm1 = self.new_vm()
+        vm1.import_('test')
+        assert len(self.cachedir.listdir()) == 1
+        #
+        self.forbid_parsing(monkeypatch)
+        vm2 = self.new_vm()
+        w_mod = vm2.import_('test')
+        w_foo = w_mod.getattr('foo')
+        w_res = vm2.call_function(w_foo, [vm2.wrap(-5)])
+        assert vm2.unwrap(w_res) == 6
+
+    def test_key(self):
+        vm = self.new_vm()
+        k1 = cache_key(vm, 'test.spy', 'x: i32 = 1')
+        assert cache_key(vm, 'test.spy', 'x: i32 = 1') == k1
+        assert cache_key(vm, 'test.spy', 'x: i32 = 2') != k1
+        assert cache_key(vm, 'other.spy', 'x: i32 = 1') != k1
+
+    def test_source_changed(self):
+        self.write("""
+        def foo() -> i32:
+            return 1
+        """)
+        self.new_vm().import_('test')
+        self.write("""
+        def foo() -> i32:
+            return 2
+        """)
+        vm = self.new_vm()
+        w_foo = vm.import_('test').getattr('foo')
+        assert vm.unwrap(vm.call_function(w_foo, [])) == 2
+        assert len(self.cachedir.listdir()) == 2
+
+    def test_imports_are_revalidated(self):
+        self.write("""
+        from rawbuffer import rb_alloc
+        """)
+        self.new_vm().import_('test')
+        vm = self.new_vm()
+        del vm.globals_w[FQN.parse('rawbuffer::rb_alloc')]
+        with pytest.raises(SPyImportError):
+            vm.import_('test')
+
+    def test_corrupted_entry(self):
+        self.write("""
+        def foo() -> i32:
+            return 1
+        """)
+        self.new_vm().import_('test')
+        [entry] = self.cachedir.listdir()
+        entry.write_binary(b'garbage')
+        vm = self.new_vm()
+        w_foo = vm.import_('test').getattr('foo')
+        assert vm.unwrap(vm.call_function(w_foo, [])) == 1
+
+    def test_shared_between_vms(self, monkeypatch):
+        monkeypatch.setenv('SPY_CACHE_DIR', '')
+        self.write("""
+        def foo(x: i32) -> i32:
+            return x + 1
+        """)
+        vm1 = self.new_vm()
+        w_foo1 = vm1.import_('test').getattr('foo')
+        self.forbid_parsing(monkeypatch)
+        vm2 = self.new_vm(new_process=False)
+        w_foo2 = vm2.import_('test').getattr('foo')
+        # the AST is shared, but the W_ objects are not
+        assert w_foo1 is not w_foo2
+        assert w_foo1.funcdef is w_foo2.funcdef
+        assert vm1.unwrap(vm1.call_function(w_foo1, [vm1.wrap(1)])) == 2
+        assert vm2.unwrap(vm2.call_function(w_foo2, [vm2.wrap(2)])) == 3
+
+    def test_memory_cache_lru(self):
+        mc = cache.MemoryCache(2)
+        a, b, c = [object() for _ in range(3)]
+        mc.put('a', a)  # type: ignore
+        mc.put('b', b)  # type: ignore
+        assert mc.get('a') is a  # now 'b' is the least recently used
+        mc.put('c', c)  # type: ignore
+        assert mc.get('b') is None
+        assert mc.get('a') is a
+        assert mc.get('c') is c
+
+
+def test_frozen_symtable():
+    scope = SymTable('foo')
+    scope.freeze()
+    loc = Loc.fake()
+    with pytest.raises(AssertionError):
+        scope.add(Symbol('x', 'red', loc=loc, type_loc=loc, level=0))
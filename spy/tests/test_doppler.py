@@ -176,3 +176,30 @@ class TestDoppler:
         def foo() -> dynamic:
             return [1, 2, 7]
         """)
+
+    def test_structural_sharing(self):
+        src = """
+        def foo(x: i32) -> i32:
+            if x == 0:
+                return x
+            return x + 1
+
+        def bar(x: i32) -> i32:
+            return x
+        """
+        f = self.tmpdir.join('test.spy')
+        f.write(textwrap.dedent(src))
+        w_mod = self.vm.import_('test')
+        old_foo = w_mod.getattr_astfunc('foo').funcdef
+        old_bar = w_mod.getattr_astfunc('bar').funcdef
+        self.vm.redshift()
+        new_foo = w_mod.getattr_astfunc('foo').funcdef
+        new_bar = w_mod.getattr_astfunc('bar').funcdef
+        # the If and the last Return have been shifted, but the inner
+        # Return is unchanged and thus shared
+        assert new_foo is not old_foo
+        assert new_foo.body[0] is not old_foo.body[0]
+        assert new_foo.body[0].then_body[0] is old_foo.body[0].then_body[0]
+        assert new_foo.body[1] is not old_foo.body[1]
+        # nothing to shift in bar
+        assert new_bar is old_bar
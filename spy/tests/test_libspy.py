@@ -1,20 +1,25 @@
 import struct
+import io
+from subprocess import getstatusoutput
 import pytest
 from spy.llwasm import LLWasmModule
+from spy.cbuild import get_toolchain
 from spy.libspy import LLSPyInstance, SPyPanicError
 from spy.tests.support import CTest
 
-def mk_spy_Str(utf8: bytes) -> bytes:
+def read_spy_Str(ll: LLSPyInstance, ptr: int) -> bytes:
     """
-    Return the spy_Str representation of the given utf8 bytes.
+    Read the utf8 content of the spy_Str at the given address.
 
-    For example, for b'hello' we have the following in-memory repr:
+    The in-memory repr of a spy_Str is the following:
          <i   4 bytes of length, little endian
-         5s   5 bytes of data (b'hello')
+         <i   pointer to the utf8 data
+         <i   pointer to the parent (NULL for non-views)
+         <i   flags
+         <q   cached hash
     """
-    n = len(utf8)
-    fmt = f'<i{n}s'
-    return struct.pack(fmt, n, utf8)
+    length, utf8, parent, flags = struct.unpack('<iiii', ll.mem.read(ptr, 16))
+    return bytes(ll.mem.read(utf8, length))
 
 class TestLibSPy(CTest):
 
@@ -57,13 +62,170 @@ class TestLibSPy(CTest):
         test_wasm = self.compile(src, exports=['H', 'mk_W'])
         ll = LLSPyInstance.from_file(test_wasm)
         ptr_H = ll.read_global('H')
-        assert ll.mem.read(ptr_H, 10) == mk_spy_Str(b'hello ')
+        assert read_spy_Str(ll, ptr_H) == b'hello '
         #
         ptr_W = ll.call('mk_W')
-        assert ll.mem.read(ptr_W, 9) == mk_spy_Str(b'world')
+        assert read_spy_Str(ll, ptr_W) == b'world'
         #
         ptr_HW = ll.call('spy_str_add', ptr_H, ptr_W)
-        assert ll.mem.read(ptr_HW, 15) == mk_spy_Str(b'hello world')
+        assert read_spy_Str(ll, ptr_HW) == b'hello world'
+
+    def test_str_slice(self):
+        src = r"""
+        #include <spy.h>
+
+        spy_Str *mk(int32_t n) {
+            spy_Str *s = spy_str_alloc(n);
+            for(int i=0; i<n; i++)
+                ((char*)s->utf8)[i] = 'a' + i % 26;
+            return s;
+        }
+        """
+        test_wasm = self.compile(src, exports=['mk'])
+        ll = LLSPyInstance.from_file(test_wasm)
+        def parent(ptr: int) -> int:
+            return ll.mem.read_i32(ptr + 8)
+        ptr_s = ll.call('mk', 100)
+        s = read_spy_Str(ll, ptr_s)
+        # short slices are copied
+        ptr_a = ll.call('spy_str_slice', ptr_s, 2, 5)
+        assert read_spy_Str(ll, ptr_a) == s[2:5]
+        assert parent(ptr_a) == 0
+        # long slices are views
+        ptr_b = ll.call('spy_str_slice', ptr_s, 10, -10)
+        assert read_spy_Str(ll, ptr_b) == s[10:-10]
+        assert parent(ptr_b) == ptr_s
+        # slices of views point to the original string
+        ptr_c = ll.call('spy_str_slice', ptr_b, 5, 60)
+        assert read_spy_Str(ll, ptr_c) == s[10:-10][5:60]
+        assert parent(ptr_c) == ptr_s
+        # slices which are much smaller than the parent are copied
+        ptr_big = ll.call('mk', 1000)
+        ptr_d = ll.call('spy_str_slice', ptr_big, 0, 100)
+        assert read_spy_Str(ll, ptr_d) == read_spy_Str(ll, ptr_big)[:100]
+        assert parent(ptr_d) == 0
+
+    def test_str_utf8(self):
+        src = r"""
+        #include <spy.h>
+
+        spy_Str *mk_valid(void) {
+            return spy_str_from_utf8("caf\xc3\xa9 \xe2\x82\xac", 9);
+        }
+
+        spy_Str *mk_invalid(void) {
+            return spy_str_from_utf8("caf\xc3", 4);
+        }
+
+        spy_Str *mk_unchecked(void) {
+            spy_Str *s = spy_str_alloc(5);
+            memcpy((void*)s->utf8, "hello", 5);
+            return s;
+        }
+        """
+        test_wasm = self.compile(src, exports=['mk_valid', 'mk_invalid',
+                                               'mk_unchecked'])
+        ll = LLSPyInstance.from_file(test_wasm)
+        def is_valid(ptr: int) -> bool:
+            return bool(ll.mem.read_i32(ptr + 12) & 1)
+        ptr_v = ll.call('mk_valid')
+        assert read_spy_Str(ll, ptr_v) == 'café €'.encode('utf-8')
+        assert is_valid(ptr_v)
+        with pytest.raises(SPyPanicError, match="invalid utf-8"):
+            ll.call('mk_invalid')
+        # the flag is propagated only when the result is known to be valid
+        assert is_valid(ll.call('spy_str_add', ptr_v, ptr_v))
+        assert is_valid(ll.call('spy_str_slice', ptr_v, 0, 5))
+        assert not is_valid(ll.call('spy_str_slice', ptr_v, 0, 4))
+        # unchecked strings are validated lazily
+        ptr_u = ll.call('mk_unchecked')
+        assert not is_valid(ptr_u)
+        assert not is_valid(ll.call('spy_str_add', ptr_v, ptr_u))
+        assert ll.call('spy_str_is_valid_utf8', ptr_u)
+        assert is_valid(ptr_u)
+
+    def test_str_hash(self):
+        src = r"""
+        #include <spy.h>
+
+        spy_Str H = {5, "hello"};
+        """
+        test_wasm = self.compile(src, exports=['H'])
+        ll = LLSPyInstance.from_file(test_wasm)
+        ptr_H = ll.read_global('H')
+        h = ll.call('spy_str_hash', ptr_H)
+        assert h == 5306810434294928543
+        # the hash is cached in the header
+        flags, cached = struct.unpack('<iq', ll.mem.read(ptr_H + 12, 12))
+        assert flags & 2
+        assert cached == h
+        assert ll.call('spy_str_hash', ptr_H) == h
+
+    def test_host_read(self):
+        src = r"""
+        #include <spy.h>
+
+        char buf[16];
+
+        int32_t
+        WASM_EXPORT(read_into_buf)(int32_t stream) {
+            return spy_host_read(stream, buf, 16);
+        }
+        """
+        test_wasm = self.compile(src, exports=['buf'])
+        ll = LLSPyInstance.from_file(test_wasm)
+        ptr = ll.read_global('buf')
+        stream = ll.libspy.add_stream(io.BytesIO(b'x' * 20 + b'hello'))
+        assert stream == 3
+        assert ll.call('read_into_buf', stream) == 16
+        assert ll.call('read_into_buf', stream) == 9
+        assert ll.mem.read(ptr, 9) == b'xxxxhello'
+        assert ll.call('read_into_buf', stream) == 0
+        assert ll.call('read_into_buf', 42) == -1
+
+    @pytest.mark.parametrize("use_uring", ["0", "1"])
+    def test_read_batch_many_files(self, use_uring):
+        # submit more reads than the process can open files: the batch must
+        # wait for the older reads instead of running out of descriptors
+        self.toolchain = get_toolchain('native')
+        src = r"""
+        #include <stdio.h>
+        #include <sys/resource.h>
+        #include "spy.h"
+
+        int main(int argc, char **argv) {
+            struct rlimit lim = {64, 64};
+            setrlimit(RLIMIT_NOFILE, &lim);
+            int n = atoi(argv[2]);
+            spy_ReadBatch *b = spy_io$read_batch();
+            spy_RawBuffer *rb = spy_rawbuffer$rb_alloc(4 * n);
+            char path[4096];
+            for (int i = 0; i < n; i++) {
+                snprintf(path, sizeof(path), "%s/%d", argv[1], i);
+                spy_Str *s = spy_str_from_utf8(path, strlen(path));
+                spy_io$submit_read(b, s, rb, 4 * i, 4, 0);
+            }
+            spy_io$wait_all(b);
+            int64_t total = 0;
+            for (int i = 0; i < n; i++) {
+                if (spy_io$read_result(b, i) != 4)
+                    return 1;
+                total += spy_rawbuffer$rb_get_i32(rb, 4 * i);
+            }
+            spy_io$close_batch(b);
+            printf("%lld\n", (long long)total);
+            return 0;
+        }
+        """
+        test_exe = self.compile_exe(src)
+        n = 300
+        datadir = self.tmpdir.join('data').ensure(dir=True)
+        for i in range(n):
+            datadir.join(str(i)).write_binary(struct.pack('i', i))
+        status, out = getstatusoutput(
+            f'SPY_IO_URING={use_uring} {test_exe} {datadir} {n}')
+        assert status == 0, out
+        assert out == str(sum(range(n)))
 
     def test_debug_log(self):
         src = r"""
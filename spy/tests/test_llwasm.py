@@ -70,6 +70,24 @@ class TestLLWasm(CTest):
         ll.mem.write(ptr, bytearray([40, 50, 60]))
         assert ll.call('foo_total') == 150
 
+    def test_view_mem(self):
+        src = r"""
+        #include <stdint.h>
+        int8_t foo[] = {10, 20, 30};
+        int32_t foo_total(void) {
+            return foo[0] + foo[1] + foo[2];
+        }
+        """
+        test_wasm = self.compile(src, exports=['foo', 'foo_total'])
+        ll = LLWasmInstance.from_file(test_wasm)
+        ptr = ll.read_global('foo')
+        view = ll.mem.view(ptr, 3)
+        assert bytes(view) == bytes([10, 20, 30])
+        view[1] = 70
+        assert ll.call('foo_total') == 110
+        with pytest.raises(IndexError):
+            ll.mem.view(ptr, 1 << 30)
+
     def test_multiple_instances(self):
         src = r"""
         int x = 100;
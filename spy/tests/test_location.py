@@ -0,0 +1,39 @@
+import pickle
+from spy.location import Loc
+
+class TestLoc:
+
+    def test_fields(self):
+        loc = Loc('foo.spy', 1, 2, 3, 4)
+        assert loc.filename == 'foo.spy'
+        assert loc.line_start == 1
+        assert loc.line_end == 2
+        assert loc.col_start == 3
+        assert loc.col_end == 4
+        assert not hasattr(loc, '__dict__')
+
+    def test_interned_filename(self):
+        fname1 = ''.join(['foo', '.spy'])
+        fname2 = ''.join(['foo', '.spy'])
+        assert fname1 is not fname2
+        assert Loc(fname1, 1, 1, 1, 1).filename is Loc(fname2, 1, 1, 1, 1).filename
+
+    def test_large_values(self):
+        loc = Loc('foo.spy', 100_000, 2**32-1, 0, 70_000)
+        assert loc.line_start == 100_000
+        assert loc.line_end == 2**32-1
+        assert loc.col_start == 0
+        assert loc.col_end == 70_000
+
+    def test_eq_replace(self):
+        loc = Loc('foo.spy', 1, 2, 3, 4)
+        assert loc == Loc('foo.spy', 1, 2, 3, 4)
+        assert loc != Loc('bar.spy', 1, 2, 3, 4)
+        loc2 = loc.replace(col_end=10)
+        assert loc2 == Loc('foo.spy', 1, 2, 3, 10)
+        assert loc.make_end_loc() == Loc('foo.spy', 2, 2, 4, 4)
+
+    def test_pickle(self):
+        loc = Loc('foo.spy', 1, 2, 3, 4)
+        loc2 = pickle.loads(pickle.dumps(loc))
+        assert loc2 == loc
@@ -22,6 +22,27 @@ def test_preprocess_var():
     assert src2 == expected
     assert len(var_locs) == 2
 
+def test_preprocess_same_line():
+    src1 = textwrap.dedent("""
+    var x: i32 = 1; var   y: i32 = 2
+    s = "var z"
+    """)
+    src2, var_locs = preprocess(src1)
+    expected = textwrap.dedent("""
+    x    : i32 = 1; y      : i32 = 2
+    s = "var z"
+    """)
+    assert src2 == expected
+    assert len(var_locs) == 2
+
+def test_preprocess_fast_path():
+    src1 = textwrap.dedent("""
+    variable: i32 = 100
+    """)
+    src2, var_locs = preprocess(src1)
+    assert src2 is src1
+    assert var_locs == set()
+
 def test_magic_py_parse():
     src = textwrap.dedent("""
     var x: i32 = 100
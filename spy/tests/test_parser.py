@@ -28,7 +28,8 @@ class TestParser:
 
     def assert_dump(self, node: ast.Node, expected: str):
         dumped = dump(node, use_colors=False,
-                      fields_to_ignore=('symtable',))
+                      fields_to_ignore=('symtable', 'privates',
+                                        'reductions'))
         dumped = dumped.strip()
         expected = textwrap.dedent(expected).strip()
         if '{tmpdir}' in expected:
@@ -271,6 +272,50 @@ class TestParser:
         """
         self.assert_dump(stmt, expected)
 
+    def test_GetSlice(self):
+        mod = self.parse("""
+        def foo() -> void:
+            return s[1:x]
+        """)
+        stmt = mod.get_funcdef('foo').body[0]
+        expected = """
+        Return(
+            value=GetSlice(
+                value=Name(id='s'),
+                start=Constant(value=1),
+                stop=Name(id='x'),
+            ),
+        )
+        """
+        self.assert_dump(stmt, expected)
+        #
+        mod = self.parse("""
+        def foo() -> void:
+            return s[:]
+        """)
+        stmt = mod.get_funcdef('foo').body[0]
+        expected = """
+        Return(
+            value=GetSlice(
+                value=Name(id='s'),
+                start=Constant(value=0),
+                stop=Constant(value=2147483647),
+            ),
+        )
+        """
+        self.assert_dump(stmt, expected)
+
+    def test_GetSlice_step(self):
+        src = """
+        def foo() -> void:
+            return s[1:2:3]
+        """
+        self.expect_errors(
+            src,
+            'not implemented yet: slices with a step',
+            ('this is not supported', '3'),
+        )
+
     def test_SetItem(self):
         mod = self.parse("""
         def foo() -> void:
@@ -665,6 +710,37 @@ class TestParser:
         """
         self.assert_dump(stmt, expected)
 
+    def test_ParallelFor(self):
+        mod = self.parse("""
+        def foo() -> void:
+            for i in parallel_range(10, 'dynamic'):
+                pass
+        """)
+        stmt = mod.get_funcdef('foo').body[0]
+        expected = """
+        ParallelFor(
+            target='i',
+            n=Constant(value=10),
+            schedule='dynamic',
+            body=[
+                Pass(),
+            ],
+        )
+        """
+        self.assert_dump(stmt, expected)
+
+    def test_For_unsupported(self):
+        self.expect_errors(
+            """
+            def foo() -> void:
+                for i in range(10):
+                    pass
+            """,
+            'not implemented yet: `for` loops over anything else than '
+            '`parallel_range()`',
+            ('this is not supported', 'range(10)'),
+        )
+
     def test_from_import(self):
         mod = self.parse("""
         from testmod import a, b as b2
@@ -136,6 +136,41 @@ class TestScopeAnalyzer:
             ('this is the previous declaration', "x: i32 = 1"),
         )
 
+    def test_parallel_for(self):
+        self.analyze("""
+        def foo(n: i32) -> i32:
+            acc = 0
+            prod = 1
+            for i in parallel_range(n):
+                x = i * 2
+                acc = acc + x
+                prod = prod * n
+            for i in parallel_range(n):
+                acc = acc + i
+            return acc + prod
+        """)
+        funcdef = self.mod.get_funcdef('foo')
+        parfor1, parfor2 = funcdef.body[2:4]
+        assert parfor1.privates == ['x']
+        assert parfor1.reductions == {'acc': '+', 'prod': '*'}
+        assert parfor2.privates == []
+        assert parfor2.reductions == {'acc': '+'}
+
+    def test_parallel_for_shared_var(self):
+        src = """
+        def foo(n: i32) -> i32:
+            acc = 0
+            for i in parallel_range(n):
+                acc = acc + acc
+            return acc
+        """
+        self.expect_errors(
+            src,
+            '`acc` is shared between the iterations of the loop',
+            ('assigned here', 'acc'),
+            ('used outside the loop here', 'acc'),
+        )
+
     def test_inner_funcdef(self):
         scopes = self.analyze("""
         def foo() -> void:
@@ -1,3 +1,4 @@
+import io
 import pytest
 import textwrap
 from spy.textbuilder import TextBuilder, ColorFormatter
@@ -134,6 +135,51 @@ class TestTextBuilder:
         """)
         assert b.lineno == 5
 
+    def test_streaming(self):
+        stream = io.StringIO()
+        b = TextBuilder(stream=stream)
+        b.wl('begin')
+        assert stream.getvalue() == 'begin\n'
+        with b.indent():
+            b.w('AAA')
+            assert stream.getvalue() == 'begin\n'
+            b.wl(' BBB')
+        b.wb("""
+        one
+        two
+        """)
+        b.w('end')
+        b.flush()
+        assert stream.getvalue() == textwrap.dedent("""\
+        begin
+            AAA BBB
+        one
+        two
+        end""")
+        assert b.lines == ['']
+
+    def test_streaming_lineno(self):
+        b = TextBuilder(stream=io.StringIO())
+        assert b.lineno == 1
+        b.wl('one')
+        assert b.lineno == 2
+        b.wb("""
+        two
+        three
+        four
+        """)
+        assert b.lineno == 5
+        b.w('five')
+        assert b.lineno == 5
+
+    def test_streaming_errors(self):
+        b = TextBuilder(stream=io.StringIO())
+        with pytest.raises(ValueError, match='make_nested_builder cannot be '
+                           'used in streaming mode'):
+            b.make_nested_builder()
+        with pytest.raises(ValueError, match='build'):
+            b.build()
+
 class TestColorFormatter:
 
     def test_ColorFormatter(self):
@@ -0,0 +1,118 @@
+import textwrap
+import threading
+from typing import Any, Callable
+import pytest
+from spy.vm.vm import SPyVM
+
+N_THREADS = 8
+
+def run_in_threads(fn: Callable[[int], Any]) -> list[Any]:
+    """
+    Call fn(i) in N_THREADS threads, which are started all together. Return
+    the list of results, or re-raise the first exception.
+    """
+    barrier = threading.Barrier(N_THREADS)
+    results: list[Any] = [None] * N_THREADS
+    errors: list[BaseException] = []
+
+    def target(i: int) -> None:
+        barrier.wait()
+        try:
+            results[i] = fn(i)
+        except BaseException as e:
+            errors.append(e)
+
+    threads = [threading.Thread(target=target, args=(i,))
+               for i in range(N_THREADS)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    if errors:
+        raise errors[0]
+    return results
+
+
+class TestThreads:
+
+    @pytest.fixture(autouse=True)
+    def init(self, tmpdir):
+        self.tmpdir = tmpdir
+        self.vm = SPyVM()
+        self.vm.path.append(str(tmpdir))
+
+    def write(self, src: str) -> None:
+        self.tmpdir.join('test.spy').write(textwrap.dedent(src))
+
+    def test_concurrent_import(self):
+        self.write("""
+        def foo() -> i32:
+            return 42
+        """)
+        mods_w = run_in_threads(lambda i: self.vm.import_('test'))
+        assert all(w_mod is mods_w[0] for w_mod in mods_w)
+
+    def test_concurrent_calls(self):
+        self.write("""
+        @blue
+        def make_adder(k):
+            def adder(x: i32) -> i32:
+                return x + k
+            return adder
+
+        def foo(i: i32) -> i32:
+            return make_adder(1)(i) + make_adder(2)(i)
+
+        def bar(i: i32) -> str:
+            return "ab" * i + "c"
+        """)
+        vm = self.vm
+        w_mod = vm.import_('test')
+        w_foo = w_mod.getattr('foo')
+        w_bar = w_mod.getattr('bar')
+
+        def fn(i: int) -> tuple[int, str]:
+            for _ in range(20):
+                w_a = vm.call_function(w_foo, [vm.wrap(i)])
+                w_b = vm.call_function(w_bar, [vm.wrap(i)])
+            return vm.unwrap(w_a), vm.unwrap(w_b)
+
+        results = run_in_threads(fn)
+        assert results == [(2*i + 3, 'ab'*i + 'c') for i in range(N_THREADS)]
+        # each blue specialization was computed exactly once
+        w_make_adder = w_mod.getattr('make_adder')
+        assert len(vm.bluecache.data[w_make_adder]) == 2
+
+    def test_blocking_channel(self):
+        self.write("""
+        from atomic import ChannelI32, mpmc_i32, ch_send_i32, ch_recv_i32
+
+        ch: ChannelI32 = mpmc_i32(4)
+
+        def produce(n: i32) -> i32:
+            i = 0
+            while i < n:
+                ch_send_i32(ch, i)
+                i = i + 1
+            return 0
+
+        def consume(n: i32) -> i32:
+            total = 0
+            while n > 0:
+                total = total + ch_recv_i32(ch)
+                n = n - 1
+            return total
+        """)
+        vm = self.vm
+        w_mod = vm.import_('test')
+        w_produce = w_mod.getattr('produce')
+        w_consume = w_mod.getattr('consume')
+        n = 100
+
+        def fn(i: int) -> int:
+            # half of the threads produce, the other half consume
+            w_func = w_produce if i % 2 == 0 else w_consume
+            return vm.unwrap(vm.call_function(w_func, [vm.wrap(n)]))
+
+        results = run_in_threads(fn)
+        assert sum(results) == sum(range(n)) * N_THREADS // 2
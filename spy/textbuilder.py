@@ -1,29 +1,46 @@
-from typing import Optional, Iterator, Union
+from typing import Optional, Iterator, Union, TextIO
 import textwrap
 from contextlib import contextmanager
 
 class TextBuilder:
+    """
+    Build a piece of text line by line.
+
+    By default, all the lines are kept in memory and joined by .build().
+
+    If `stream` is given, the builder works in streaming mode: every line is
+    written to the stream as soon as it is complete, and only the current
+    line is kept in memory. Nested builders are not supported in streaming
+    mode, but .lineno is always accurate.
+    """
     level: int  # indentation level
     lines: list[Union[str, 'TextBuilder']]
     use_colors: bool
+    stream: Optional[TextIO]
+    n_flushed: int # number of lines already written to the stream
 
-    def __init__(self, *, use_colors: bool = False) -> None:
+    def __init__(self, *, use_colors: bool = False,
+                 stream: Optional[TextIO] = None) -> None:
         self.level = 0
         self.lines = ['']
         self.use_colors = use_colors
         self.color = ColorFormatter(use_colors)
+        self.stream = stream
+        self.n_flushed = 0
 
     @property
     def lineno(self) -> int:
         """
         XXX this is broken in presence of nested builders :(
+        (but nested builders cannot be used in streaming mode, so there it's
+        always correct)
 
         Return the number of the CURRENT line.
 
         The invariant is that if .lineno == N, then .write(), .writeline(),
         etc. will write text on line number N.
         """
-        return len(self.lines)
+        return self.n_flushed + len(self.lines)
 
     @contextmanager
     def indent(self) -> Iterator[None]:
@@ -38,6 +55,9 @@ class TextBuilder:
         The nested builder can be written independently of the outer one, and
         it will be built automatically when the outer is built.
         """
+        if self.stream is not None:
+            raise ValueError('make_nested_builder cannot be used in '
+                             'streaming mode')
         if self.lines[-1] != '':
             raise ValueError('make_nested_builder can be called only '
                              'after a newline')
@@ -60,6 +80,32 @@ class TextBuilder:
     def writeline(self, s: str = '', *, color: Optional[str] = None) -> None:
         self.write(s, color=color)
         self.lines.append('')
+        if self.stream is not None:
+            self._flush_lines()
+
+    def _flush_lines(self) -> None:
+        """
+        Write all the complete lines to the stream
+        """
+        assert self.stream is not None
+        for line in self.lines[:-1]:
+            assert isinstance(line, str)
+            self.stream.write(line)
+            self.stream.write('\n')
+        self.n_flushed += len(self.lines) - 1
+        del self.lines[:-1]
+
+    def flush(self) -> None:
+        """
+        Streaming mode only: write the current incomplete line, if any, and
+        flush the stream. Call it when you are done writing.
+        """
+        assert self.stream is not None
+        last = self.lines[-1]
+        assert isinstance(last, str)
+        self.stream.write(last)
+        self.lines[-1] = ''
+        self.stream.flush()
 
     def writeblock(self, s: str, *, color: Optional[str] = None) -> None:
         s = textwrap.dedent(s).strip()
@@ -72,6 +118,8 @@ class TextBuilder:
     wb = writeblock
 
     def build(self) -> str:
+        if self.stream is not None:
+            raise ValueError('build() cannot be used in streaming mode')
         strlines = []
         for line in self.lines:
             if isinstance(line, TextBuilder):
@@ -12,7 +12,7 @@ from spy.vm.object import W_Object, W_Type
 from spy.vm.function import W_Func, W_FuncType, W_ASTFunc, Namespace
 from spy.vm.list import W_BaseList
 from spy.vm.typechecker import TypeChecker
-from spy.vm.typeconverter import TypeConverter
+from spy.vm.typeconverter import TypeConverter, literal_int_type
 from spy.util import magic_dispatch
 if TYPE_CHECKING:
     from spy.vm.vm import SPyVM
@@ -184,6 +184,16 @@ class ASTFrame:
             for stmt in while_node.body:
                 self.exec_stmt(stmt)
 
+    def exec_stmt_ParallelFor(self, parfor: ast.ParallelFor) -> None:
+        # the interpreter runs the iterations sequentially, which is one of
+        # the valid schedulings
+        w_n = self.eval_expr(parfor.n)
+        n = self.vm.unwrap_i32(w_n)
+        for i in range(n):
+            self.store_local(parfor.target, self.vm.wrap(i))
+            for stmt in parfor.body:
+                self.exec_stmt(stmt)
+
     # ==== expressions ====
 
     def eval_expr_Constant(self, const: ast.Constant) -> W_Object:
@@ -191,6 +201,10 @@ class ASTFrame:
         # Parser.from_py_expr_Constant
         T = type(const.value)
         assert T in (int, float, bool, str, NoneType)
+        if T is int:
+            w_type = literal_int_type(const.value)
+            if w_type is not B.w_i32:
+                return w_type.pyclass(const.value)
         return self.vm.wrap(const.value)
 
     def eval_expr_FQNConst(self, const: ast.FQNConst) -> W_Object:
@@ -231,8 +245,12 @@ class ASTFrame:
     eval_expr_LtE = eval_expr_BinOp
     eval_expr_Gt = eval_expr_BinOp
     eval_expr_GtE = eval_expr_BinOp
+    eval_expr_In = eval_expr_BinOp
+    eval_expr_NotIn = eval_expr_BinOp
 
     def eval_expr_Call(self, call: ast.Call) -> W_Object:
+        if call in self.t.method_calls:
+            return self._eval_call_method(call)
         color, w_functype = self.t.check_expr(call.func)
         if call in self.t.opimpl:
             return self._eval_call_opimpl(call, color, w_functype)
@@ -247,6 +265,13 @@ class ASTFrame:
         w_res = self.vm.call_function(w_opimpl, [w_target] + args_w)
         return w_res
 
+    def _eval_call_method(self, call: ast.Call) -> W_Object:
+        w_opimpl = self.t.opimpl[call]
+        assert isinstance(call.func, ast.GetAttr)
+        w_obj = self.eval_expr(call.func.value)
+        args_w = [self.eval_expr(arg) for arg in call.args]
+        return self.vm.call_function(w_opimpl, [w_obj] + args_w)
+
     def _eval_call_func(self, call: ast.Call, color: Color,
                         w_functype: W_Type) -> W_Object:
         assert color == 'blue', 'indirect calls not supported'
@@ -274,6 +299,13 @@ class ASTFrame:
         w_res = self.vm.call_function(w_opimpl, [w_val, w_i])
         return w_res
 
+    def eval_expr_GetSlice(self, op: ast.GetSlice) -> W_Object:
+        w_opimpl = self.t.opimpl[op]
+        w_val = self.eval_expr(op.value)
+        w_start = self.eval_expr(op.start)
+        w_stop = self.eval_expr(op.stop)
+        return self.vm.call_function(w_opimpl, [w_val, w_start, w_stop])
+
     def eval_expr_GetAttr(self, op: ast.GetAttr) -> W_Object:
         # this is suboptimal, but good enough for now: ideally, we would like
         # to support two cases:
@@ -17,9 +17,12 @@ all over the place and we need to import it very early.
 
 from spy.vm.registry import ModuleRegistry
 from spy.vm.object import (W_Object, W_Type, w_DynamicType, W_Void, W_I32,
-                           W_F64, W_Bool, W_NotImplementedType)
-from spy.vm.str import W_Str
+                           W_F64, W_Bool, W_NotImplementedType, W_I8, W_U8,
+                           W_I16, W_U16, W_U32, W_I64, W_U64, W_F32)
+from spy.vm.str import W_Str, W_StrSplit
 from spy.vm.list import W_ListFactory
+from spy.vm.task import W_Spawn, W_Join
+from spy.vm.simd import W_F64x2, W_F32x4, W_I32x4
 
 
 BUILTINS = ModuleRegistry('builtins', '<builtins>')
@@ -31,9 +34,23 @@ B.add('void', W_Void._w)
 B.add('dynamic', w_DynamicType)
 B.add('i32', W_I32._w)
 B.add('f64', W_F64._w)
+B.add('i8', W_I8._w)
+B.add('u8', W_U8._w)
+B.add('i16', W_I16._w)
+B.add('u16', W_U16._w)
+B.add('u32', W_U32._w)
+B.add('i64', W_I64._w)
+B.add('u64', W_U64._w)
+B.add('f32', W_F32._w)
 B.add('bool', W_Bool._w)
 B.add('str', W_Str._w)
+B.add('StrSplit', W_StrSplit._w)
+B.add('f64x2', W_F64x2._w)
+B.add('f32x4', W_F32x4._w)
+B.add('i32x4', W_I32x4._w)
 B.add('list', W_ListFactory())
+B.add('spawn', W_Spawn())
+B.add('join', W_Join())
 B.add('None', W_Void._w_singleton)
 B.add('True', W_Bool._w_singleton_True)
 B.add('False', W_Bool._w_singleton_False)
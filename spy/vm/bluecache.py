@@ -16,6 +16,9 @@ class BlueCache:
     list of calls, and then during lookup it does a linear search.
 
     We should use a SPy dict, as soon as we have it.
+
+    lookup() can be called concurrently with record(), which must be called
+    while holding vm.lock.
     """
     vm: 'SPyVM'
     data: defaultdict[W_Func, list[ENTRY]]
@@ -29,7 +32,8 @@ class BlueCache:
         self.data[w_func].append(entry)
 
     def lookup(self, w_func: W_Func, got_args_w: ARGS_W) -> Optional[W_Object]:
-        entries = self.data[w_func]
+        # don't use self.data[w_func], which would insert a new entry
+        entries = self.data.get(w_func, [])
         for args_w, w_result in entries:
             if self.args_w_eq(args_w, got_args_w):
                 return w_result
@@ -19,7 +19,7 @@ class W_ListFactory(W_Object):
         return vm.wrap(opimpl)
 
 class W_BaseList(W_Object):
-    pass
+    w_T: W_Type  # the type of the items
 
 # XXX this should be marked as '@interp_blue' and cached automatically by the
 # VM
@@ -76,6 +76,7 @@ def make_W_List(vm_cache: Optional['SPyVM'], w_T: W_Type) -> W_Type:
                 return B.w_None
             return vm.wrap(setitem)
 
+    W_List.w_T = w_T
     W_List.__name__ = f'W_List[{T.__name__}]'
     CACHE[key] = W_List  # type: ignore
     return W_List        # type: ignore
@@ -0,0 +1,179 @@
+"""
+SPy `atomic` module.
+
+It provides atomic i32 cells and bounded channels of i32 and f64, which can
+be used to communicate between tasks and parallel loops.
+
+There are two kinds of channels: SPSC channels can be used by at most one
+sender and one receiver at a time, MPMC channels by any number of them. In C
+both are lock-free ring buffers, see spy/libspy/include/spy/atomic.h. The
+capacity is rounded up to the next power of two.
+
+ch_send and ch_recv block until there is room, resp. an item. The
+interpreter implements them with a Condition, so they work when SPy code is
+called from multiple Python threads. Note that spawn() is allowed to run the
+task inline (the interpreter always does): a spawned producer which fills a
+channel before anybody reads it blocks forever.
+"""
+
+from typing import TYPE_CHECKING
+import threading
+from collections import deque
+from spy.vm.b import B
+from spy.vm.object import spytype
+from spy.vm.w import W_Object, W_I32, W_F64, W_Void, W_Bool
+from spy.vm.registry import ModuleRegistry
+from spy.libspy import SPyPanicError
+if TYPE_CHECKING:
+    from spy.vm.vm import SPyVM
+
+ATOMIC = ModuleRegistry('atomic', '<atomic>')
+
+# protects the value of all the W_AtomicI32: the interpreter doesn't need to
+# be fast
+ATOMIC_LOCK = threading.Lock()
+
+@spytype('AtomicI32')
+class W_AtomicI32(W_Object):
+    value: int
+
+    def __init__(self, value: int) -> None:
+        self.value = value
+
+    def spy_unwrap(self, vm: 'SPyVM') -> int:
+        return self.value
+
+ATOMIC.add('AtomicI32', W_AtomicI32._w)
+
+@ATOMIC.builtin
+def atomic_i32(vm: 'SPyVM', w_value: W_I32) -> W_AtomicI32:
+    return W_AtomicI32(vm.unwrap_i32(w_value))
+
+@ATOMIC.builtin
+def atomic_load_i32(vm: 'SPyVM', w_a: W_AtomicI32) -> W_I32:
+    with ATOMIC_LOCK:
+        return vm.wrap(w_a.value)  # type: ignore
+
+@ATOMIC.builtin
+def atomic_store_i32(vm: 'SPyVM', w_a: W_AtomicI32, w_value: W_I32) -> W_Void:
+    value = vm.unwrap_i32(w_value)
+    with ATOMIC_LOCK:
+        w_a.value = value
+    return B.w_None
+
+@ATOMIC.builtin
+def atomic_cas_i32(vm: 'SPyVM', w_a: W_AtomicI32, w_expected: W_I32,
+                   w_desired: W_I32) -> W_Bool:
+    """
+    If the value is `expected`, replace it with `desired` and return True.
+    Else, return False.
+    """
+    expected = vm.unwrap_i32(w_expected)
+    desired = vm.unwrap_i32(w_desired)
+    with ATOMIC_LOCK:
+        if w_a.value == expected:
+            w_a.value = desired
+            return B.w_True
+        return B.w_False
+
+@ATOMIC.builtin
+def atomic_fetch_add_i32(vm: 'SPyVM', w_a: W_AtomicI32,
+                         w_delta: W_I32) -> W_I32:
+    """
+    Add `delta` to the value and return the old value. It wraps around on
+    overflow.
+    """
+    delta = vm.unwrap_i32(w_delta)
+    with ATOMIC_LOCK:
+        old = w_a.value
+        w_a.value = (old + delta + 2**31) % 2**32 - 2**31
+    return vm.wrap(old)  # type: ignore
+
+
+class W_Channel(W_Object):
+    capacity: int
+    items: deque[W_Object]
+    cond: threading.Condition
+
+    def __init__(self, capacity: int) -> None:
+        if capacity <= 0:
+            raise SPyPanicError('invalid channel capacity')
+        self.capacity = 1 << (capacity - 1).bit_length()
+        self.items = deque()
+        self.cond = threading.Condition()
+
+    def try_send(self, w_item: W_Object) -> bool:
+        with self.cond:
+            if len(self.items) == self.capacity:
+                return False
+            self.items.append(w_item)
+            self.cond.notify_all()
+            return True
+
+    def send(self, w_item: W_Object) -> None:
+        with self.cond:
+            self.cond.wait_for(lambda: len(self.items) < self.capacity)
+            self.items.append(w_item)
+            self.cond.notify_all()
+
+    def recv(self) -> W_Object:
+        with self.cond:
+            self.cond.wait_for(lambda: len(self.items) > 0)
+            w_item = self.items.popleft()
+            self.cond.notify_all()
+            return w_item
+
+@spytype('ChannelI32')
+class W_ChannelI32(W_Channel):
+    pass
+
+@spytype('ChannelF64')
+class W_ChannelF64(W_Channel):
+    pass
+
+ATOMIC.add('ChannelI32', W_ChannelI32._w)
+ATOMIC.add('ChannelF64', W_ChannelF64._w)
+
+# SPSC and MPMC channels differ only in C
+
+@ATOMIC.builtin
+def spsc_i32(vm: 'SPyVM', w_capacity: W_I32) -> W_ChannelI32:
+    return W_ChannelI32(vm.unwrap_i32(w_capacity))
+
+@ATOMIC.builtin
+def mpmc_i32(vm: 'SPyVM', w_capacity: W_I32) -> W_ChannelI32:
+    return W_ChannelI32(vm.unwrap_i32(w_capacity))
+
+@ATOMIC.builtin
+def ch_send_i32(vm: 'SPyVM', w_ch: W_ChannelI32, w_x: W_I32) -> W_Void:
+    w_ch.send(w_x)
+    return B.w_None
+
+@ATOMIC.builtin
+def ch_try_send_i32(vm: 'SPyVM', w_ch: W_ChannelI32, w_x: W_I32) -> W_Bool:
+    return vm.wrap(w_ch.try_send(w_x))  # type: ignore
+
+@ATOMIC.builtin
+def ch_recv_i32(vm: 'SPyVM', w_ch: W_ChannelI32) -> W_I32:
+    return w_ch.recv()  # type: ignore
+
+@ATOMIC.builtin
+def spsc_f64(vm: 'SPyVM', w_capacity: W_I32) -> W_ChannelF64:
+    return W_ChannelF64(vm.unwrap_i32(w_capacity))
+
+@ATOMIC.builtin
+def mpmc_f64(vm: 'SPyVM', w_capacity: W_I32) -> W_ChannelF64:
+    return W_ChannelF64(vm.unwrap_i32(w_capacity))
+
+@ATOMIC.builtin
+def ch_send_f64(vm: 'SPyVM', w_ch: W_ChannelF64, w_x: W_F64) -> W_Void:
+    w_ch.send(w_x)
+    return B.w_None
+
+@ATOMIC.builtin
+def ch_try_send_f64(vm: 'SPyVM', w_ch: W_ChannelF64, w_x: W_F64) -> W_Bool:
+    return vm.wrap(w_ch.try_send(w_x))  # type: ignore
+
+@ATOMIC.builtin
+def ch_recv_f64(vm: 'SPyVM', w_ch: W_ChannelF64) -> W_F64:
+    return w_ch.recv()  # type: ignore
@@ -5,7 +5,7 @@ The first half is in vm/b.py. See its docstring for more details.
 """
 
 from typing import TYPE_CHECKING, Any
-from spy.vm.object import W_I32, W_F64, W_Bool, W_Dynamic, W_Void
+from spy.vm.object import W_I32, W_I64, W_F64, W_Bool, W_Dynamic, W_Void
 from spy.vm.str import W_Str
 from spy.vm.b import BUILTINS, B
 
@@ -20,6 +20,14 @@ def abs(vm: 'SPyVM', w_x: W_I32) -> W_I32:
     res = vm.ll.call('spy_builtins$abs', x)
     return vm.wrap(res) # type: ignore
 
+@BUILTINS.builtin
+def hash(vm: 'SPyVM', w_s: W_Str) -> W_I64:
+    """
+    Hash of a str. It is computed by libspy, so it is the same in the
+    interpreter and in the compiled code.
+    """
+    return W_I64(vm.ll.call('spy_str_hash', w_s.ptr))
+
 @BUILTINS.builtin
 def print(vm: 'SPyVM', w_x: W_Dynamic) -> W_Void:
     """
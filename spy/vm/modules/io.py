@@ -0,0 +1,216 @@
+"""
+SPy `io` module.
+
+It provides buffered readers and writers over files:
+
+    r: Reader = open_reader('input.txt')
+    line = readline(r)    # includes the trailing '\\n', '' at EOF
+    n = read(r, rb, offset, size)
+    close_reader(r)
+
+    w: Writer = open_writer('output.txt')
+    write(w, 'hello\\n')
+    write_rb(w, rb, offset, size)
+    close_writer(w)
+
+Lines are decoded as utf-8 and it's a panic if they are not valid. read()
+fills the given region of the RawBuffer and returns the number of bytes
+which were read: it is less than `size` only at EOF. Writers must be closed
+(or flushed) explicitly, else the data still in the buffer is lost.
+
+A ReadBatch runs many reads concurrently, e.g. to scan thousands of files:
+
+    b: ReadBatch = read_batch()
+    id = submit_read(b, path, rb, offset, size, file_offset)
+    ...
+    id = wait_any(b)          # a completed read, -1 when there are no more
+    n = read_result(b, id)    # the number of bytes which were read
+    close_batch(b)
+
+The content of the RawBuffer is undefined until the read is complete. In C,
+the reads are submitted to the kernel in groups through io_uring, or run on
+the thread pool if it is not available, see spy/libspy/include/spy/aio.h.
+
+read_stream(stream, rb, offset, size) reads from one of the streams of the
+host, with the same semantics as read(). On the native target the streams
+are file descriptors, e.g. 0 is stdin. On wasm32 they are Python files
+owned by LibSPyHost, and the host reads directly into the linear memory.
+
+The interpreter uses Python's buffered files, and the reads of a ReadBatch
+are done by submit_read. In C, the module is available only on the native
+target, apart from read_stream, see spy/libspy/include/spy/io.h.
+"""
+
+from typing import TYPE_CHECKING, BinaryIO
+from collections import deque
+from spy.vm.b import B
+from spy.vm.object import spytype, W_I64
+from spy.vm.w import W_Object, W_I32, W_Void, W_Str
+from spy.vm.modules.rawbuffer import W_RawBuffer
+from spy.vm.registry import ModuleRegistry
+from spy.libspy import SPyPanicError, readinto_all
+if TYPE_CHECKING:
+    from spy.vm.vm import SPyVM
+
+IO = ModuleRegistry('io', '<io>')
+
+@spytype('Reader')
+class W_Reader(W_Object):
+    f: BinaryIO
+
+    def __init__(self, f: BinaryIO) -> None:
+        self.f = f
+
+@spytype('Writer')
+class W_Writer(W_Object):
+    f: BinaryIO
+
+    def __init__(self, f: BinaryIO) -> None:
+        self.f = f
+
+@spytype('ReadBatch')
+class W_ReadBatch(W_Object):
+    results: list[int]
+    completed: deque[int]
+    closed: bool
+
+    def __init__(self) -> None:
+        self.results = []
+        self.completed = deque()
+        self.closed = False
+
+IO.add('Reader', W_Reader._w)
+IO.add('Writer', W_Writer._w)
+IO.add('ReadBatch', W_ReadBatch._w)
+
+def check_region(w_rb: W_RawBuffer, offset: int, size: int) -> memoryview:
+    if offset < 0 or size < 0 or offset + size > len(w_rb.buf):
+        raise SPyPanicError('RawBuffer region out of bounds')
+    return memoryview(w_rb.buf)[offset:offset+size]
+
+def check_open(f: BinaryIO) -> None:
+    if f.closed:
+        raise SPyPanicError('I/O operation on closed file')
+
+def open_file(vm: 'SPyVM', w_path: W_Str, mode: str) -> BinaryIO:
+    path = vm.unwrap_str(w_path)
+    try:
+        return open(path, mode)  # type: ignore
+    except OSError:
+        raise SPyPanicError('cannot open file')
+
+@IO.builtin
+def open_reader(vm: 'SPyVM', w_path: W_Str) -> W_Reader:
+    return W_Reader(open_file(vm, w_path, 'rb'))
+
+@IO.builtin
+def readline(vm: 'SPyVM', w_r: W_Reader) -> W_Str:
+    check_open(w_r.f)
+    line = w_r.f.readline()
+    try:
+        s = line.decode('utf-8')
+    except UnicodeDecodeError:
+        raise SPyPanicError('invalid utf-8')
+    return vm.wrap(s)  # type: ignore
+
+@IO.builtin
+def read(vm: 'SPyVM', w_r: W_Reader, w_rb: W_RawBuffer, w_offset: W_I32,
+         w_size: W_I32) -> W_I32:
+    check_open(w_r.f)
+    region = check_region(w_rb, vm.unwrap_i32(w_offset),
+                          vm.unwrap_i32(w_size))
+    n = readinto_all(w_r.f, region)
+    return vm.wrap(n)  # type: ignore
+
+@IO.builtin
+def read_stream(vm: 'SPyVM', w_stream: W_I32, w_rb: W_RawBuffer,
+                w_offset: W_I32, w_size: W_I32) -> W_I32:
+    region = check_region(w_rb, vm.unwrap_i32(w_offset),
+                          vm.unwrap_i32(w_size))
+    f = vm.ll.libspy.get_stream(vm.unwrap_i32(w_stream))
+    if f is None:
+        raise SPyPanicError('invalid stream')
+    n = readinto_all(f, region)
+    return vm.wrap(n)  # type: ignore
+
+@IO.builtin
+def close_reader(vm: 'SPyVM', w_r: W_Reader) -> W_Void:
+    w_r.f.close()
+    return B.w_None
+
+@IO.builtin
+def open_writer(vm: 'SPyVM', w_path: W_Str) -> W_Writer:
+    return W_Writer(open_file(vm, w_path, 'wb'))
+
+@IO.builtin
+def write(vm: 'SPyVM', w_w: W_Writer, w_s: W_Str) -> W_Void:
+    check_open(w_w.f)
+    w_w.f.write(w_s.get_utf8())
+    return B.w_None
+
+@IO.builtin
+def write_rb(vm: 'SPyVM', w_w: W_Writer, w_rb: W_RawBuffer, w_offset: W_I32,
+             w_size: W_I32) -> W_Void:
+    check_open(w_w.f)
+    region = check_region(w_rb, vm.unwrap_i32(w_offset),
+                          vm.unwrap_i32(w_size))
+    w_w.f.write(region)
+    return B.w_None
+
+@IO.builtin
+def flush(vm: 'SPyVM', w_w: W_Writer) -> W_Void:
+    check_open(w_w.f)
+    w_w.f.flush()
+    return B.w_None
+
+@IO.builtin
+def close_writer(vm: 'SPyVM', w_w: W_Writer) -> W_Void:
+    w_w.f.close()
+    return B.w_None
+
+@IO.builtin
+def read_batch(vm: 'SPyVM') -> W_ReadBatch:
+    return W_ReadBatch()
+
+@IO.builtin
+def submit_read(vm: 'SPyVM', w_b: W_ReadBatch, w_path: W_Str,
+                w_rb: W_RawBuffer, w_offset: W_I32, w_size: W_I32,
+                w_file_offset: W_I64) -> W_I32:
+    if w_b.closed:
+        raise SPyPanicError('I/O operation on closed batch')
+    region = check_region(w_rb, vm.unwrap_i32(w_offset),
+                          vm.unwrap_i32(w_size))
+    file_offset = vm.unwrap(w_file_offset)
+    if file_offset < 0:
+        raise SPyPanicError('negative file offset')
+    with open_file(vm, w_path, 'rb') as f:
+        f.seek(file_offset)
+        n = readinto_all(f, region)
+    read_id = len(w_b.results)
+    w_b.results.append(n)
+    w_b.completed.append(read_id)
+    return vm.wrap(read_id)  # type: ignore
+
+@IO.builtin
+def wait_any(vm: 'SPyVM', w_b: W_ReadBatch) -> W_I32:
+    if w_b.completed:
+        return vm.wrap(w_b.completed.popleft())  # type: ignore
+    return vm.wrap(-1)  # type: ignore
+
+@IO.builtin
+def wait_all(vm: 'SPyVM', w_b: W_ReadBatch) -> W_Void:
+    return B.w_None
+
+@IO.builtin
+def read_result(vm: 'SPyVM', w_b: W_ReadBatch, w_id: W_I32) -> W_I32:
+    read_id = vm.unwrap_i32(w_id)
+    if not 0 <= read_id < len(w_b.results):
+        raise SPyPanicError('invalid read id')
+    return vm.wrap(w_b.results[read_id])  # type: ignore
+
+@IO.builtin
+def close_batch(vm: 'SPyVM', w_b: W_ReadBatch) -> W_Void:
+    w_b.results = []
+    w_b.completed.clear()
+    w_b.closed = True
+    return B.w_None
@@ -0,0 +1,94 @@
+"""
+SPy `math` module.
+
+All the functions operate on f64. In C they are static inline wrappers
+around the compiler builtins, see spy/libspy/include/spy/math.h: the
+optimizer turns them into a single instruction (sqrtsd, roundsd, f64.sqrt,
+f64.floor, etc.) instead of a function call.
+
+The interpreter uses Python's `math`. The results are the same, apart from
+the following corner cases, where we follow C instead of Python:
+
+  - sqrt() of a negative number returns nan instead of raising;
+
+  - min() and max() are defined as `a if a < b else b` (resp. `>`), which
+    is what the CPU instructions do: if one of the arguments is nan, they
+    return `b`.
+"""
+
+from typing import TYPE_CHECKING
+import math
+from fractions import Fraction
+from spy.vm.w import W_F64
+from spy.vm.registry import ModuleRegistry
+if TYPE_CHECKING:
+    from spy.vm.vm import SPyVM
+
+MATH = ModuleRegistry('math', '<math>')
+
+@MATH.builtin
+def sqrt(vm: 'SPyVM', w_x: W_F64) -> W_F64:
+    x = vm.unwrap_f64(w_x)
+    res = math.sqrt(x) if x >= 0 else math.nan
+    return vm.wrap(res)  # type: ignore
+
+@MATH.builtin
+def floor(vm: 'SPyVM', w_x: W_F64) -> W_F64:
+    x = vm.unwrap_f64(w_x)
+    res = float(math.floor(x)) if math.isfinite(x) else x
+    return vm.wrap(res)  # type: ignore
+
+@MATH.builtin
+def ceil(vm: 'SPyVM', w_x: W_F64) -> W_F64:
+    x = vm.unwrap_f64(w_x)
+    res = float(math.ceil(x)) if math.isfinite(x) else x
+    return vm.wrap(res)  # type: ignore
+
+@MATH.builtin
+def trunc(vm: 'SPyVM', w_x: W_F64) -> W_F64:
+    x = vm.unwrap_f64(w_x)
+    res = float(math.trunc(x)) if math.isfinite(x) else x
+    # keep the sign of e.g. trunc(-0.5) == -0.0
+    return vm.wrap(math.copysign(res, x))  # type: ignore
+
+@MATH.builtin
+def fabs(vm: 'SPyVM', w_x: W_F64) -> W_F64:
+    return vm.wrap(math.fabs(vm.unwrap_f64(w_x)))  # type: ignore
+
+@MATH.builtin
+def copysign(vm: 'SPyVM', w_x: W_F64, w_y: W_F64) -> W_F64:
+    res = math.copysign(vm.unwrap_f64(w_x), vm.unwrap_f64(w_y))
+    return vm.wrap(res)  # type: ignore
+
+@MATH.builtin
+def min(vm: 'SPyVM', w_a: W_F64, w_b: W_F64) -> W_F64:
+    a = vm.unwrap_f64(w_a)
+    b = vm.unwrap_f64(w_b)
+    return vm.wrap(a if a < b else b)  # type: ignore
+
+@MATH.builtin
+def max(vm: 'SPyVM', w_a: W_F64, w_b: W_F64) -> W_F64:
+    a = vm.unwrap_f64(w_a)
+    b = vm.unwrap_f64(w_b)
+    return vm.wrap(a if a > b else b)  # type: ignore
+
+@MATH.builtin
+def fma(vm: 'SPyVM', w_a: W_F64, w_b: W_F64, w_c: W_F64) -> W_F64:
+    """
+    Compute a*b + c with a single rounding.
+    """
+    a = vm.unwrap_f64(w_a)
+    b = vm.unwrap_f64(w_b)
+    c = vm.unwrap_f64(w_c)
+    if not (math.isfinite(a) and math.isfinite(b) and math.isfinite(c)):
+        # inf and nan propagate in the same way
+        return vm.wrap(a * b + c)  # type: ignore
+    exact = Fraction(a) * Fraction(b) + Fraction(c)
+    try:
+        res = float(exact)
+    except OverflowError:
+        res = math.inf if exact > 0 else -math.inf
+    if exact == 0:
+        # the sign of an exact zero follows the IEEE 754 rules
+        res = a * b + c
+    return vm.wrap(res)  # type: ignore
@@ -69,6 +69,8 @@ OP = OPERATOR
 # the folloing imports register all the various objects on OP
 from . import opimpl_i32     # side effects
 from . import opimpl_f64     # side effects
+from . import opimpl_numeric # side effects
+from . import opimpl_simd    # side effects
 from . import opimpl_str     # side effects
 from . import opimpl_dynamic # side effects
 from . import binop          # side effects
@@ -88,5 +90,7 @@ OP._from_token.update({
     '<=': OP.w_LE,
     '>':  OP.w_GT,
     '>=': OP.w_GE,
+    'in': OP.w_IN,
+    'not in': OP.w_NOT_IN,
     '[]': OP.w_GETITEM,
 })
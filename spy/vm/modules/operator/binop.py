@@ -3,6 +3,7 @@ from spy.vm.b import B
 from spy.vm.object import W_Dynamic, W_Type
 from . import OP
 from .multimethod import MultiMethodTable
+from .opimpl_numeric import ALL_NUMERIC, TOKENS, binop_type
 if TYPE_CHECKING:
     from spy.vm.vm import SPyVM
 
@@ -56,11 +57,43 @@ MM.register('>' , 'i32', 'f64', OP.w_f64_gt)
 MM.register('>=', 'f64', 'i32', OP.w_f64_ge)
 MM.register('>=', 'i32', 'f64', OP.w_f64_ge)
 
+# the other numeric types, see opimpl_numeric.py. All the combinations are
+# supported, as long as binop_type finds a suitable opimpl
+for _l in ALL_NUMERIC:
+    for _r in ALL_NUMERIC:
+        if _l in ('i32', 'f64') and _r in ('i32', 'f64'):
+            continue # already registered above
+        _t = binop_type(_l, _r)
+        if _t is None:
+            continue
+        for _name, _token in TOKENS.items():
+            MM.register(_token, _l, _r, getattr(OP, f'w_{_t}_{_name}'))
+
+# SIMD ops: they work lane-wise. Division is not supported for i32x4, since
+# there are no SIMD instructions for it
+MM.register('+',  'f64x2', 'f64x2', OP.w_f64x2_add)
+MM.register('-',  'f64x2', 'f64x2', OP.w_f64x2_sub)
+MM.register('*',  'f64x2', 'f64x2', OP.w_f64x2_mul)
+MM.register('/',  'f64x2', 'f64x2', OP.w_f64x2_div)
+MM.register('+',  'f32x4', 'f32x4', OP.w_f32x4_add)
+MM.register('-',  'f32x4', 'f32x4', OP.w_f32x4_sub)
+MM.register('*',  'f32x4', 'f32x4', OP.w_f32x4_mul)
+MM.register('/',  'f32x4', 'f32x4', OP.w_f32x4_div)
+MM.register('+',  'i32x4', 'i32x4', OP.w_i32x4_add)
+MM.register('-',  'i32x4', 'i32x4', OP.w_i32x4_sub)
+MM.register('*',  'i32x4', 'i32x4', OP.w_i32x4_mul)
+
 # str ops
 MM.register('+',  'str', 'str', OP.w_str_add)
 MM.register('*',  'str', 'i32', OP.w_str_mul)
 MM.register('==', 'str', 'str', OP.w_str_eq)
 MM.register('!=', 'str', 'str', OP.w_str_ne)
+MM.register('<',  'str', 'str', OP.w_str_lt)
+MM.register('<=', 'str', 'str', OP.w_str_le)
+MM.register('>',  'str', 'str', OP.w_str_gt)
+MM.register('>=', 'str', 'str', OP.w_str_ge)
+MM.register('in', 'str', 'str', OP.w_str_in)
+MM.register('not in', 'str', 'str', OP.w_str_not_in)
 
 # dynamic ops
 MM.register_partial('+',  'dynamic', OP.w_dynamic_add)
@@ -113,3 +146,11 @@ def GT(vm: 'SPyVM', w_ltype: W_Type, w_rtype: W_Type) -> W_Dynamic:
 @OP.builtin
 def GE(vm: 'SPyVM', w_ltype: W_Type, w_rtype: W_Type) -> W_Dynamic:
     return MM.lookup('>=', w_ltype, w_rtype)
+
+@OP.builtin
+def IN(vm: 'SPyVM', w_ltype: W_Type, w_rtype: W_Type) -> W_Dynamic:
+    return MM.lookup('in', w_ltype, w_rtype)
+
+@OP.builtin
+def NOT_IN(vm: 'SPyVM', w_ltype: W_Type, w_rtype: W_Type) -> W_Dynamic:
+    return MM.lookup('not in', w_ltype, w_rtype)
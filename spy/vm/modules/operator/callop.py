@@ -1,6 +1,7 @@
 from typing import TYPE_CHECKING
 from spy.vm.b import B
 from spy.vm.object import W_Object, W_Type, W_Dynamic
+from spy.vm.str import W_Str
 
 from . import OP
 from .binop import MM
@@ -15,3 +16,17 @@ def CALL(vm: 'SPyVM', w_type: W_Type, w_argtypes: W_Object) -> W_Dynamic:
     elif pyclass.has_meth_overriden('op_CALL'):
         return pyclass.op_CALL(vm, w_type, w_argtypes)
     return B.w_NotImplemented
+
+@OP.builtin
+def CALL_METHOD(vm: 'SPyVM', w_type: W_Type, w_attr: W_Str,
+                w_argtypes: W_Object) -> W_Dynamic:
+    """
+    Return the opimpl for `obj.attr(*args)`, or NotImplemented: in that case,
+    the call is done in two steps, i.e. GETATTR followed by CALL.
+    """
+    pyclass = w_type.pyclass
+    if w_type is B.w_dynamic:
+        return B.w_NotImplemented
+    elif pyclass.has_meth_overriden('op_CALL_METHOD'):
+        return pyclass.op_CALL_METHOD(vm, w_type, w_attr, w_argtypes)
+    return B.w_NotImplemented
@@ -15,6 +15,15 @@ def GETITEM(vm: 'SPyVM', w_type: W_Type, w_itype: W_Type) -> W_Dynamic:
 
     return B.w_NotImplemented
 
+@OP.builtin
+def GETSLICE(vm: 'SPyVM', w_type: W_Type, w_starttype: W_Type,
+             w_stoptype: W_Type) -> W_Dynamic:
+    pyclass = w_type.pyclass
+    if pyclass.has_meth_overriden('op_GETSLICE'):
+        return pyclass.op_GETSLICE(vm, w_type, w_starttype, w_stoptype)
+
+    return B.w_NotImplemented
+
 @OP.builtin
 def SETITEM(vm: 'SPyVM', w_type: W_Type, w_itype: W_Type,
             w_vtype: W_Type) -> W_Dynamic:
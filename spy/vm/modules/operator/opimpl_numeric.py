@@ -0,0 +1,123 @@
+"""
+Opimpls for the numeric types other than i32 and f64.
+
+Contrarily to opimpl_i32.py and opimpl_f64.py, here we generate them
+automatically, else we would need to write ~100 almost identical functions.
+They are registered on OP with the usual names, e.g. OP.w_u8_add.
+
+Moreover, we generate a conversion opimpl for each pair of numeric types,
+e.g. OP.w_i32_to_u8: they are used to implement calls like `u8(x)`, see
+numeric_meta_op_CALL.
+"""
+
+from typing import TYPE_CHECKING, Any, Optional, Type
+import operator
+from spy.vm.object import (W_Object, W_Type, W_Bool, W_I32, W_F64, W_I8,
+                           W_U8, W_I16, W_U16, W_U32, W_I64, W_U64, W_F32)
+from spy.vm.typeconverter import convert_numeric, is_lossless_conversion
+from . import OP
+if TYPE_CHECKING:
+    from spy.vm.vm import SPyVM
+
+SIZED_INTS: dict[str, Type[W_Object]] = {
+    'i8': W_I8,
+    'u8': W_U8,
+    'i16': W_I16,
+    'u16': W_U16,
+    'u32': W_U32,
+    'i64': W_I64,
+    'u64': W_U64,
+}
+
+ALL_NUMERIC: dict[str, Type[W_Object]] = {
+    'i32': W_I32,
+    'f64': W_F64,
+    **SIZED_INTS,
+    'f32': W_F32,
+}
+
+# integer division is floor division, as for i32. The C backend implements
+# it in spy/libspy/include/spy/numeric.h
+ARITH_OPS = {
+    'add': operator.add,
+    'sub': operator.sub,
+    'mul': operator.mul,
+    'div': operator.floordiv,
+}
+
+COMPARE_OPS = {
+    'eq': operator.eq,
+    'ne': operator.ne,
+    'lt': operator.lt,
+    'le': operator.le,
+    'gt': operator.gt,
+    'ge': operator.ge,
+}
+
+# the token of each operator, see binop.py
+TOKENS = {
+    'add': '+', 'sub': '-', 'mul': '*', 'div': '/',
+    'eq': '==', 'ne': '!=', 'lt': '<', 'le': '<=', 'gt': '>', 'ge': '>=',
+}
+
+def binop_type(l: str, r: str) -> Optional[str]:
+    """
+    Return the type of the opimpl to use for `l OP r`, if any.
+
+    i32 can be mixed with all the other types, and f64 with f32: in that case
+    we use the other type, so that e.g. `x + 1` with `x: u8` is an u8 and
+    `y * 2.0` with `y: f32` is a f32. Note that the i32 (or f64) operand is
+    converted only if it is a literal or if the conversion is lossless, see
+    TypeChecker.convert_type_maybe.
+
+    Else, if one of the two types can be losslessly converted to the other,
+    we use the latter.
+    """
+    w_l = ALL_NUMERIC[l]._w
+    w_r = ALL_NUMERIC[r]._w
+    if l == r:
+        return l
+    elif {l, r} == {'i32', 'f64'}:
+        return 'f64'
+    elif l == 'i32' or (l == 'f64' and r == 'f32'):
+        return r
+    elif r == 'i32' or (r == 'f64' and l == 'f32'):
+        return l
+    elif is_lossless_conversion(w_r, w_l):
+        return l
+    elif is_lossless_conversion(w_l, w_r):
+        return r
+    return None
+
+def _register(name: str, fn: Any, annotations: dict[str, Any]) -> None:
+    fn.__name__ = fn.__qualname__ = name
+    fn.__annotations__ = {'vm': 'SPyVM', **annotations}
+    OP.builtin(fn)
+
+def _make_binop(name: str, T: Type[W_Object], R: Type[W_Object],
+                fn: Any) -> None:
+    def opimpl(vm: 'SPyVM', w_a: Any, w_b: Any) -> Any:
+        # the constructor of T normalizes the result (i.e., it wraps
+        # integers and rounds f32)
+        res = fn(w_a.value, w_b.value)
+        if R is W_Bool:
+            return vm.wrap(res)
+        return T(res)  # type: ignore
+    _register(name, opimpl, {'w_a': T, 'w_b': T, 'return': R})
+
+def _make_conv(name: str, T: Type[W_Object], R: Type[W_Object]) -> None:
+    def opimpl(vm: 'SPyVM', w_cls: W_Type, w_x: Any) -> Any:
+        return convert_numeric(vm, w_x, R._w)
+    _register(name, opimpl, {'w_cls': W_Type, 'w_x': T, 'return': R})
+
+for _t, _T in list(SIZED_INTS.items()) + [('f32', W_F32)]:
+    for _name, _fn in ARITH_OPS.items():
+        if _T is W_F32 and _name == 'div':
+            _fn = operator.truediv
+        _make_binop(f'{_t}_{_name}', _T, _T, _fn)
+    for _name, _fn in COMPARE_OPS.items():
+        _make_binop(f'{_t}_{_name}', _T, W_Bool, _fn)
+
+for _from, _F in ALL_NUMERIC.items():
+    for _to, _T in ALL_NUMERIC.items():
+        _make_conv(f'{_from}_to_{_to}', _F, _T)
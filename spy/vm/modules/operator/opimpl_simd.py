@@ -0,0 +1,74 @@
+from typing import TYPE_CHECKING, Any
+from spy.vm.object import W_I32, W_F64
+from spy.vm.simd import W_Vector, W_F64x2, W_F32x4, W_I32x4
+from . import OP
+if TYPE_CHECKING:
+    from spy.vm.vm import SPyVM
+
+# all the SIMD opimpls work lane-wise. The constructor of the result
+# normalizes each lane, i.e. it rounds f32 and wraps i32 on overflow
+
+def _vec_op(vm: 'SPyVM', w_a: W_Vector, w_b: W_Vector, fn: Any) -> Any:
+    lanes = [fn(a, b) for a, b in zip(w_a.lanes, w_b.lanes)]
+    return type(w_a)(lanes)
+
+@OP.builtin
+def f64x2_add(vm: 'SPyVM', w_a: W_F64x2, w_b: W_F64x2) -> W_F64x2:
+    return _vec_op(vm, w_a, w_b, lambda a, b: a + b)
+
+@OP.builtin
+def f64x2_sub(vm: 'SPyVM', w_a: W_F64x2, w_b: W_F64x2) -> W_F64x2:
+    return _vec_op(vm, w_a, w_b, lambda a, b: a - b)
+
+@OP.builtin
+def f64x2_mul(vm: 'SPyVM', w_a: W_F64x2, w_b: W_F64x2) -> W_F64x2:
+    return _vec_op(vm, w_a, w_b, lambda a, b: a * b)
+
+@OP.builtin
+def f64x2_div(vm: 'SPyVM', w_a: W_F64x2, w_b: W_F64x2) -> W_F64x2:
+    return _vec_op(vm, w_a, w_b, lambda a, b: a / b)
+
+# computing a single f32 operation in double precision and rounding the
+# result gives the same result as computing it in single precision
+
+@OP.builtin
+def f32x4_add(vm: 'SPyVM', w_a: W_F32x4, w_b: W_F32x4) -> W_F32x4:
+    return _vec_op(vm, w_a, w_b, lambda a, b: a + b)
+
+@OP.builtin
+def f32x4_sub(vm: 'SPyVM', w_a: W_F32x4, w_b: W_F32x4) -> W_F32x4:
+    return _vec_op(vm, w_a, w_b, lambda a, b: a - b)
+
+@OP.builtin
+def f32x4_mul(vm: 'SPyVM', w_a: W_F32x4, w_b: W_F32x4) -> W_F32x4:
+    return _vec_op(vm, w_a, w_b, lambda a, b: a * b)
+
+@OP.builtin
+def f32x4_div(vm: 'SPyVM', w_a: W_F32x4, w_b: W_F32x4) -> W_F32x4:
+    return _vec_op(vm, w_a, w_b, lambda a, b: a / b)
+
+@OP.builtin
+def i32x4_add(vm: 'SPyVM', w_a: W_I32x4, w_b: W_I32x4) -> W_I32x4:
+    return _vec_op(vm, w_a, w_b, lambda a, b: a + b)
+
+@OP.builtin
+def i32x4_sub(vm: 'SPyVM', w_a: W_I32x4, w_b: W_I32x4) -> W_I32x4:
+    return _vec_op(vm, w_a, w_b, lambda a, b: a - b)
+
+@OP.builtin
+def i32x4_mul(vm: 'SPyVM', w_a: W_I32x4, w_b: W_I32x4) -> W_I32x4:
+    return _vec_op(vm, w_a, w_b, lambda a, b: a * b)
+
+# v[i]: see the op_GETITEM of the various W_* classes
+
+@OP.builtin
+def f64x2_getitem(vm: 'SPyVM', w_v: W_F64x2, w_i: W_I32) -> W_F64:
+    return w_v.getitem(vm, w_i)  # type: ignore
+
+@OP.builtin
+def f32x4_getitem(vm: 'SPyVM', w_v: W_F32x4, w_i: W_I32) -> W_F64:
+    return w_v.getitem(vm, w_i)  # type: ignore
+
+@OP.builtin
+def i32x4_getitem(vm: 'SPyVM', w_v: W_I32x4, w_i: W_I32) -> W_I32:
+    return w_v.getitem(vm, w_i)  # type: ignore
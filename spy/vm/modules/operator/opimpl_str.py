@@ -1,7 +1,9 @@
 from typing import TYPE_CHECKING
+import re
 from spy.vm.b import B
-from spy.vm.str import W_Str
-from spy.vm.object import W_I32, W_Bool
+from spy.vm.str import W_Str, W_StrSplit
+from spy.vm.object import W_Type, W_I32, W_I64, W_F64, W_Bool, W_Dynamic
+from spy.libspy import SPyPanicError
 from . import OP
 if TYPE_CHECKING:
     from spy.vm.vm import SPyVM
@@ -34,3 +36,143 @@ def str_ne(vm: 'SPyVM', w_a: W_Str, w_b: W_Str) -> W_Bool:
     assert isinstance(w_b, W_Str)
     res = vm.ll.call('spy_str_eq', w_a.ptr, w_b.ptr)
     return vm.wrap(bool(not res))  # type: ignore
+
+@OP.builtin
+def str_slice(vm: 'SPyVM', w_s: W_Str, w_start: W_I32, w_stop: W_I32) -> W_Str:
+    assert isinstance(w_s, W_Str)
+    ptr_c = vm.ll.call('spy_str_slice', w_s.ptr,
+                       vm.unwrap_i32(w_start), vm.unwrap_i32(w_stop))
+    return W_Str.from_ptr(vm, ptr_c)
+
+# Ordering: Python compares bytes lexicographically, with the shorter one
+# first in case of a common prefix, which is the same as spy_str_cmp.
+
+@OP.builtin
+def str_lt(vm: 'SPyVM', w_a: W_Str, w_b: W_Str) -> W_Bool:
+    return vm.wrap(w_a.get_utf8() < w_b.get_utf8())  # type: ignore
+
+@OP.builtin
+def str_le(vm: 'SPyVM', w_a: W_Str, w_b: W_Str) -> W_Bool:
+    return vm.wrap(w_a.get_utf8() <= w_b.get_utf8())  # type: ignore
+
+@OP.builtin
+def str_gt(vm: 'SPyVM', w_a: W_Str, w_b: W_Str) -> W_Bool:
+    return vm.wrap(w_a.get_utf8() > w_b.get_utf8())  # type: ignore
+
+@OP.builtin
+def str_ge(vm: 'SPyVM', w_a: W_Str, w_b: W_Str) -> W_Bool:
+    return vm.wrap(w_a.get_utf8() >= w_b.get_utf8())  # type: ignore
+
+# Substring search. The interpreter uses Python's bytes search, while in C
+# they are implemented by libspy, see spy/libspy/src/str.c. Indexes are
+# offsets in the utf-8 representation, like for str_getitem.
+
+@OP.builtin
+def str_find(vm: 'SPyVM', w_s: W_Str, w_sub: W_Str) -> W_I32:
+    res = w_s.get_utf8().find(w_sub.get_utf8())
+    return vm.wrap(res)  # type: ignore
+
+@OP.builtin
+def str_count(vm: 'SPyVM', w_s: W_Str, w_sub: W_Str) -> W_I32:
+    res = w_s.get_utf8().count(w_sub.get_utf8())
+    return vm.wrap(res)  # type: ignore
+
+@OP.builtin
+def str_startswith(vm: 'SPyVM', w_s: W_Str, w_prefix: W_Str) -> W_Bool:
+    res = w_s.get_utf8().startswith(w_prefix.get_utf8())
+    return vm.wrap(res)  # type: ignore
+
+@OP.builtin
+def str_endswith(vm: 'SPyVM', w_s: W_Str, w_suffix: W_Str) -> W_Bool:
+    res = w_s.get_utf8().endswith(w_suffix.get_utf8())
+    return vm.wrap(res)  # type: ignore
+
+@OP.builtin
+def str_in(vm: 'SPyVM', w_sub: W_Str, w_s: W_Str) -> W_Bool:
+    res = w_sub.get_utf8() in w_s.get_utf8()
+    return vm.wrap(res)  # type: ignore
+
+@OP.builtin
+def str_not_in(vm: 'SPyVM', w_sub: W_Str, w_s: W_Str) -> W_Bool:
+    res = w_sub.get_utf8() not in w_s.get_utf8()
+    return vm.wrap(res)  # type: ignore
+
+# split and join. str_join_split and the StrSplit opimpls are implemented in
+# libspy, and split() is lazy there. Here we just mirror the semantics.
+
+@OP.builtin
+def str_split(vm: 'SPyVM', w_s: W_Str, w_sep: W_Str) -> W_StrSplit:
+    if w_sep.get_length() == 0:
+        raise SPyPanicError('empty separator')
+    return W_StrSplit(w_s, w_sep)
+
+@OP.builtin
+def StrSplit_length(vm: 'SPyVM', w_sp: W_StrSplit) -> W_I32:
+    return vm.wrap(len(w_sp.get_bounds()))  # type: ignore
+
+@OP.builtin
+def StrSplit_getitem(vm: 'SPyVM', w_sp: W_StrSplit, w_i: W_I32) -> W_Str:
+    bounds = w_sp.get_bounds()
+    i = vm.unwrap_i32(w_i)
+    if i < 0:
+        i += len(bounds)
+    if i < 0 or i >= len(bounds):
+        raise SPyPanicError('split index out of bound')
+    start, stop = bounds[i]
+    ptr_c = vm.ll.call('spy_str_slice', w_sp.w_s.ptr, start, stop)
+    return W_Str.from_ptr(vm, ptr_c)
+
+@OP.builtin
+def str_join_split(vm: 'SPyVM', w_sep: W_Str, w_sp: W_StrSplit) -> W_Str:
+    s = w_sp.w_s.get_utf8()
+    pieces = [s[a:b] for a, b in w_sp.get_bounds()]
+    res = w_sep.get_utf8().join(pieces)
+    return vm.wrap(res.decode('utf-8'))  # type: ignore
+
+@OP.builtin
+def str_join(vm: 'SPyVM', w_sep: W_Str, w_items: W_Dynamic) -> W_Str:
+    # w_items is a list[str], see W_Str.op_CALL_METHOD. Lists exist only in
+    # the interpreter, so we don't need a C version
+    pieces = [w_item.get_utf8() for w_item in w_items.items_w]  # type: ignore
+    res = w_sep.get_utf8().join(pieces)
+    return vm.wrap(res.decode('utf-8'))  # type: ignore
+
+# Conversions to numbers, i.e. `i32(s)`, `i64(s)` and `f64(s)`: they are
+# found by numeric_meta_op_CALL. In C they are implemented by libspy, see
+# spy/libspy/src/strconv.c. Here we check the syntax with a regexp, since
+# Python's int() and float() accept more things, e.g. underscores, and then
+# we let them do the actual conversion.
+
+INT_RE = re.compile(rb'\s*[+-]?[0-9]+\s*')
+FLOAT_RE = re.compile(rb'''
+    \s*[+-]?
+    (
+        ([0-9]+(\.[0-9]*)?|\.[0-9]+)([eE][+-]?[0-9]+)?
+        | (?i:inf|infinity|nan)
+    )
+    \s*
+''', re.VERBOSE)
+
+def parse_int(w_s: W_Str, T: str, bits: int) -> int:
+    utf8 = w_s.get_utf8()
+    if not INT_RE.fullmatch(utf8):
+        raise SPyPanicError(f'invalid literal for {T}()')
+    res = int(utf8)
+    if not -2**(bits-1) <= res < 2**(bits-1):
+        raise SPyPanicError(f'integer out of range for {T}()')
+    return res
+
+@OP.builtin
+def str_to_i32(vm: 'SPyVM', w_cls: W_Type, w_s: W_Str) -> W_I32:
+    return W_I32(parse_int(w_s, 'i32', 32))
+
+@OP.builtin
+def str_to_i64(vm: 'SPyVM', w_cls: W_Type, w_s: W_Str) -> W_I64:
+    return W_I64(parse_int(w_s, 'i64', 64))
+
+@OP.builtin
+def str_to_f64(vm: 'SPyVM', w_cls: W_Type, w_s: W_Str) -> W_F64:
+    utf8 = w_s.get_utf8()
+    if not FLOAT_RE.fullmatch(utf8):
+        raise SPyPanicError('could not convert string to f64')
+    return W_F64(float(utf8))
@@ -2,11 +2,14 @@
 SPy `rawbuffer` module.
 """
 
-from typing import TYPE_CHECKING
+from typing import TYPE_CHECKING, Any
 import struct
 from spy.vm.b import B
 from spy.vm.object import spytype
 from spy.vm.w import W_Func, W_Type, W_Object, W_I32, W_F64, W_Void, W_Str
+from spy.vm.object import (W_I8, W_U8, W_I16, W_U16, W_U32, W_I64, W_U64,
+                           W_F32)
+from spy.vm.simd import W_F64x2, W_F32x4, W_I32x4
 from spy.vm.registry import ModuleRegistry
 if TYPE_CHECKING:
     from spy.vm.vm import SPyVM
@@ -57,3 +60,125 @@ def rb_get_f64(vm: 'SPyVM', w_rb: W_RawBuffer, w_offset: W_I32) -> W_F64:
     offset = vm.unwrap_i32(w_offset)
     val = struct.unpack_from('d', w_rb.buf, offset)[0]
     return vm.wrap(val)  # type: ignore
+
+# the other numeric types
+
+def _rb_set(vm: 'SPyVM', w_rb: W_RawBuffer, w_offset: W_I32, fmt: str,
+            w_val: W_Object) -> W_Void:
+    offset = vm.unwrap_i32(w_offset)
+    struct.pack_into(fmt, w_rb.buf, offset, vm.unwrap(w_val))
+    return B.w_None
+
+def _rb_get(vm: 'SPyVM', w_rb: W_RawBuffer, w_offset: W_I32, fmt: str) -> Any:
+    offset = vm.unwrap_i32(w_offset)
+    return struct.unpack_from(fmt, w_rb.buf, offset)[0]
+
+@RB.builtin
+def rb_set_i8(vm: 'SPyVM', w_rb: W_RawBuffer,
+              w_offset: W_I32, w_val: W_I8) -> W_Void:
+    return _rb_set(vm, w_rb, w_offset, 'b', w_val)
+
+@RB.builtin
+def rb_get_i8(vm: 'SPyVM', w_rb: W_RawBuffer, w_offset: W_I32) -> W_I8:
+    return W_I8(_rb_get(vm, w_rb, w_offset, 'b'))
+
+@RB.builtin
+def rb_set_u8(vm: 'SPyVM', w_rb: W_RawBuffer,
+              w_offset: W_I32, w_val: W_U8) -> W_Void:
+    return _rb_set(vm, w_rb, w_offset, 'B', w_val)
+
+@RB.builtin
+def rb_get_u8(vm: 'SPyVM', w_rb: W_RawBuffer, w_offset: W_I32) -> W_U8:
+    return W_U8(_rb_get(vm, w_rb, w_offset, 'B'))
+
+@RB.builtin
+def rb_set_i16(vm: 'SPyVM', w_rb: W_RawBuffer,
+               w_offset: W_I32, w_val: W_I16) -> W_Void:
+    return _rb_set(vm, w_rb, w_offset, 'h', w_val)
+
+@RB.builtin
+def rb_get_i16(vm: 'SPyVM', w_rb: W_RawBuffer, w_offset: W_I32) -> W_I16:
+    return W_I16(_rb_get(vm, w_rb, w_offset, 'h'))
+
+@RB.builtin
+def rb_set_u16(vm: 'SPyVM', w_rb: W_RawBuffer,
+               w_offset: W_I32, w_val: W_U16) -> W_Void:
+    return _rb_set(vm, w_rb, w_offset, 'H', w_val)
+
+@RB.builtin
+def rb_get_u16(vm: 'SPyVM', w_rb: W_RawBuffer, w_offset: W_I32) -> W_U16:
+    return W_U16(_rb_get(vm, w_rb, w_offset, 'H'))
+
+@RB.builtin
+def rb_set_u32(vm: 'SPyVM', w_rb: W_RawBuffer,
+               w_offset: W_I32, w_val: W_U32) -> W_Void:
+    return _rb_set(vm, w_rb, w_offset, 'I', w_val)
+
+@RB.builtin
+def rb_get_u32(vm: 'SPyVM', w_rb: W_RawBuffer, w_offset: W_I32) -> W_U32:
+    return W_U32(_rb_get(vm, w_rb, w_offset, 'I'))
+
+@RB.builtin
+def rb_set_i64(vm: 'SPyVM', w_rb: W_RawBuffer,
+               w_offset: W_I32, w_val: W_I64) -> W_Void:
+    return _rb_set(vm, w_rb, w_offset, 'q', w_val)
+
+@RB.builtin
+def rb_get_i64(vm: 'SPyVM', w_rb: W_RawBuffer, w_offset: W_I32) -> W_I64:
+    return W_I64(_rb_get(vm, w_rb, w_offset, 'q'))
+
+@RB.builtin
+def rb_set_u64(vm: 'SPyVM', w_rb: W_RawBuffer,
+               w_offset: W_I32, w_val: W_U64) -> W_Void:
+    return _rb_set(vm, w_rb, w_offset, 'Q', w_val)
+
+@RB.builtin
+def rb_get_u64(vm: 'SPyVM', w_rb: W_RawBuffer, w_offset: W_I32) -> W_U64:
+    return W_U64(_rb_get(vm, w_rb, w_offset, 'Q'))
+
+@RB.builtin
+def rb_set_f32(vm: 'SPyVM', w_rb: W_RawBuffer,
+               w_offset: W_I32, w_val: W_F32) -> W_Void:
+    return _rb_set(vm, w_rb, w_offset, 'f', w_val)
+
+@RB.builtin
+def rb_get_f32(vm: 'SPyVM', w_rb: W_RawBuffer, w_offset: W_I32) -> W_F32:
+    return W_F32(_rb_get(vm, w_rb, w_offset, 'f'))
+
+# SIMD vectors. The offset doesn't need to be aligned
+
+@RB.builtin
+def rb_set_f64x2(vm: 'SPyVM', w_rb: W_RawBuffer,
+                 w_offset: W_I32, w_val: W_F64x2) -> W_Void:
+    offset = vm.unwrap_i32(w_offset)
+    struct.pack_into('2d', w_rb.buf, offset, *w_val.lanes)
+    return B.w_None
+
+@RB.builtin
+def rb_get_f64x2(vm: 'SPyVM', w_rb: W_RawBuffer, w_offset: W_I32) -> W_F64x2:
+    offset = vm.unwrap_i32(w_offset)
+    return W_F64x2(struct.unpack_from('2d', w_rb.buf, offset))
+
+@RB.builtin
+def rb_set_f32x4(vm: 'SPyVM', w_rb: W_RawBuffer,
+                 w_offset: W_I32, w_val: W_F32x4) -> W_Void:
+    offset = vm.unwrap_i32(w_offset)
+    struct.pack_into('4f', w_rb.buf, offset, *w_val.lanes)
+    return B.w_None
+
+@RB.builtin
+def rb_get_f32x4(vm: 'SPyVM', w_rb: W_RawBuffer, w_offset: W_I32) -> W_F32x4:
+    offset = vm.unwrap_i32(w_offset)
+    return W_F32x4(struct.unpack_from('4f', w_rb.buf, offset))
+
+@RB.builtin
+def rb_set_i32x4(vm: 'SPyVM', w_rb: W_RawBuffer,
+                 w_offset: W_I32, w_val: W_I32x4) -> W_Void:
+    offset = vm.unwrap_i32(w_offset)
+    struct.pack_into('4i', w_rb.buf, offset, *w_val.lanes)
+    return B.w_None
+
+@RB.builtin
+def rb_get_i32x4(vm: 'SPyVM', w_rb: W_RawBuffer, w_offset: W_I32) -> W_I32x4:
+    offset = vm.unwrap_i32(w_offset)
+    return W_I32x4(struct.unpack_from('4i', w_rb.buf, offset))
@@ -0,0 +1,60 @@
+"""
+SPy `simd` module.
+
+The vector types f64x2, f32x4 and i32x4 are builtins, see spy/vm/simd.py.
+This module contains the functions to create them and to reduce them to a
+scalar. To load and store vectors from memory, use rb_get_f64x2 & co. from
+the `rawbuffer` module.
+"""
+
+from typing import TYPE_CHECKING
+from spy.vm.simd import W_F64x2, W_F32x4, W_I32x4
+from spy.vm.w import W_I32, W_F64
+from spy.vm.registry import ModuleRegistry
+if TYPE_CHECKING:
+    from spy.vm.vm import SPyVM
+
+SIMD = ModuleRegistry('simd', '<simd>')
+
+@SIMD.builtin
+def make_f64x2(vm: 'SPyVM', w_a: W_F64, w_b: W_F64) -> W_F64x2:
+    return W_F64x2([vm.unwrap_f64(w_a), vm.unwrap_f64(w_b)])
+
+@SIMD.builtin
+def splat_f64x2(vm: 'SPyVM', w_x: W_F64) -> W_F64x2:
+    return W_F64x2([vm.unwrap_f64(w_x)] * 2)
+
+@SIMD.builtin
+def sum_f64x2(vm: 'SPyVM', w_v: W_F64x2) -> W_F64:
+    a, b = w_v.lanes
+    return vm.wrap(a + b)  # type: ignore
+
+@SIMD.builtin
+def make_f32x4(vm: 'SPyVM', w_a: W_F64, w_b: W_F64, w_c: W_F64,
+               w_d: W_F64) -> W_F32x4:
+    return W_F32x4([vm.unwrap_f64(w) for w in (w_a, w_b, w_c, w_d)])
+
+@SIMD.builtin
+def splat_f32x4(vm: 'SPyVM', w_x: W_F64) -> W_F32x4:
+    return W_F32x4([vm.unwrap_f64(w_x)] * 4)
+
+@SIMD.builtin
+def sum_f32x4(vm: 'SPyVM', w_v: W_F32x4) -> W_F64:
+    # the sum is done in single precision, in the same order as in C
+    f32 = W_F32x4.normalize
+    a, b, c, d = w_v.lanes
+    return vm.wrap(f32(f32(a + b) + f32(c + d)))  # type: ignore
+
+@SIMD.builtin
+def make_i32x4(vm: 'SPyVM', w_a: W_I32, w_b: W_I32, w_c: W_I32,
+               w_d: W_I32) -> W_I32x4:
+    return W_I32x4([vm.unwrap_i32(w) for w in (w_a, w_b, w_c, w_d)])
+
+@SIMD.builtin
+def splat_i32x4(vm: 'SPyVM', w_x: W_I32) -> W_I32x4:
+    return W_I32x4([vm.unwrap_i32(w_x)] * 4)
+
+@SIMD.builtin
+def sum_i32x4(vm: 'SPyVM', w_v: W_I32x4) -> W_I32:
+    # wraps around on overflow
+    return vm.wrap(W_I32x4.normalize(sum(w_v.lanes)))  # type: ignore
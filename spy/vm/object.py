@@ -46,6 +46,8 @@ basically a thin wrapper around the correspindig interp-level W_* class.
 
 import fixedint
 import typing
+import struct
+import math
 from typing import TYPE_CHECKING, ClassVar, Type, Any, Annotated, Optional
 from spy.fqn import QN
 if TYPE_CHECKING:
@@ -144,6 +146,11 @@ class W_Object:
                    w_vtype: 'W_Type') -> 'W_Dynamic':
         raise NotImplementedError('this should never be called')
 
+    @staticmethod
+    def op_GETSLICE(vm: 'SPyVM', w_type: 'W_Type', w_starttype: 'W_Type',
+                    w_stoptype: 'W_Type') -> 'W_Dynamic':
+        raise NotImplementedError('this should never be called')
+
     @staticmethod
     def op_SETITEM(vm: 'SPyVM', w_type: 'W_Type', w_itype: 'W_Type',
                    w_vtype: 'W_Type') -> 'W_Dynamic':
@@ -154,6 +161,11 @@ class W_Object:
                 w_argtypes: 'W_Dynamic') -> 'W_Dynamic':
         raise NotImplementedError('this should never be called')
 
+    @staticmethod
+    def op_CALL_METHOD(vm: 'SPyVM', w_type: 'W_Type', w_attr: 'W_Str',
+                       w_argtypes: 'W_Dynamic') -> 'W_Dynamic':
+        raise NotImplementedError('this should never be called')
+
 
 class W_Type(W_Object):
     """
@@ -406,9 +418,30 @@ class W_Void(W_Object):
 W_Void._w_singleton = W_Void.__new__(W_Void)
 
 
+def numeric_meta_op_CALL(vm: 'SPyVM', w_type: W_Type,
+                         w_argtypes: W_Dynamic) -> W_Dynamic:
+    """
+    Calling a numeric type converts the argument to it, e.g. `u8(x)`. The
+    opimpls are in operator/opimpl_numeric.py.
+    """
+    from spy.vm.b import B
+    from spy.vm.modules.operator import OP
+    argtypes_w = w_argtypes.items_w  # type: ignore
+    if len(argtypes_w) != 1:
+        return B.w_NotImplemented
+    # w_type is the metatype, e.g. `Meta_u8`
+    totype = w_type.name.removeprefix('Meta_')
+    fromtype = argtypes_w[0].name
+    w_opimpl = getattr(OP, f'w_{fromtype}_to_{totype}', None)
+    if w_opimpl is None:
+        return B.w_NotImplemented
+    return w_opimpl
+
+
 @spytype('i32')
 class W_I32(W_Object):
     value: fixedint.Int32
+    meta_op_CALL = staticmethod(numeric_meta_op_CALL)
 
     def __init__(self, value: int | fixedint.Int32) -> None:
         assert type(value) in (int, fixedint.Int32)
@@ -424,6 +457,7 @@ class W_I32(W_Object):
 @spytype('f64')
 class W_F64(W_Object):
     value: float
+    meta_op_CALL = staticmethod(numeric_meta_op_CALL)
 
     def __init__(self, value: float) -> None:
         assert type(value) is float
@@ -436,6 +470,103 @@ class W_F64(W_Object):
         return self.value
 
 
+class W_SizedInt(W_Object):
+    """
+    Base class for the integer types other than i32: i8, u8, i16, u16, u32,
+    i64 and u64.
+
+    The value is always normalized to the range of the type, so that the
+    arithmetic wraps around like in C.
+    """
+    BITS: ClassVar[int]
+    SIGNED: ClassVar[bool]
+    value: int
+    meta_op_CALL = staticmethod(numeric_meta_op_CALL)
+
+    def __init__(self, value: int) -> None:
+        assert type(value) is int or isinstance(value, fixedint.FixedInt)
+        self.value = self.normalize(int(value))
+
+    @classmethod
+    def normalize(cls, value: int) -> int:
+        value &= (1 << cls.BITS) - 1
+        if cls.SIGNED and value >= 1 << (cls.BITS - 1):
+            value -= 1 << cls.BITS
+        return value
+
+    @classmethod
+    def fits(cls, value: int) -> bool:
+        return cls.normalize(value) == value
+
+    def __repr__(self) -> str:
+        return f'{self.__class__.__name__}({self.value})'
+
+    def spy_unwrap(self, vm: 'SPyVM') -> int:
+        return self.value
+
+@spytype('i8')
+class W_I8(W_SizedInt):
+    BITS = 8
+    SIGNED = True
+
+@spytype('u8')
+class W_U8(W_SizedInt):
+    BITS = 8
+    SIGNED = False
+
+@spytype('i16')
+class W_I16(W_SizedInt):
+    BITS = 16
+    SIGNED = True
+
+@spytype('u16')
+class W_U16(W_SizedInt):
+    BITS = 16
+    SIGNED = False
+
+@spytype('u32')
+class W_U32(W_SizedInt):
+    BITS = 32
+    SIGNED = False
+
+@spytype('i64')
+class W_I64(W_SizedInt):
+    BITS = 64
+    SIGNED = True
+
+@spytype('u64')
+class W_U64(W_SizedInt):
+    BITS = 64
+    SIGNED = False
+
+
+@spytype('f32')
+class W_F32(W_Object):
+    """
+    Single precision float. The value is stored as a python float, which is
+    always rounded to single precision.
+    """
+    value: float
+    meta_op_CALL = staticmethod(numeric_meta_op_CALL)
+
+    def __init__(self, value: float) -> None:
+        assert type(value) is float
+        self.value = self.normalize(value)
+
+    @staticmethod
+    def normalize(value: float) -> float:
+        try:
+            return struct.unpack('f', struct.pack('f', value))[0]
+        except OverflowError:
+            return math.copysign(math.inf, value)
+
+    def __repr__(self) -> str:
+        return f'W_F32({self.value})'
+
+    def spy_unwrap(self, vm: 'SPyVM') -> float:
+        return self.value
+
+
 @spytype('bool')
 class W_Bool(W_Object):
     value: bool
@@ -0,0 +1,98 @@
+"""
+SIMD vector types: f64x2, f32x4 and i32x4.
+
+They are value types of 128 bits, which the C backend maps to GCC/clang
+vector extensions, see spy/libspy/include/spy/simd.h. The arithmetic
+operators work lane-wise and are registered in operator/binop.py, and v[i]
+returns the i-th lane. The opimpls are in operator/opimpl_simd.py.
+
+The interpreter emulates them with a tuple of scalars. The lanes of a f32x4
+are exposed as f64: they are rounded to single precision whenever a vector
+is created.
+"""
+
+from typing import TYPE_CHECKING, Any, ClassVar
+import struct
+from spy.vm.object import W_Object, W_Type, W_Dynamic, spytype, W_I32
+from spy.libspy import SPyPanicError
+if TYPE_CHECKING:
+    from spy.vm.vm import SPyVM
+
+
+def round_f32(x: float) -> float:
+    return struct.unpack('f', struct.pack('f', x))[0]
+
+def wrap_i32(x: int) -> int:
+    return (x + 2**31) % 2**32 - 2**31
+
+
+class W_Vector(W_Object):
+    """
+    Base class for all the SIMD types. Subclasses define the number of lanes
+    and how to normalize the value of each lane.
+    """
+    N: ClassVar[int]
+    lanes: tuple[Any, ...]
+
+    def __init__(self, lanes: Any) -> None:
+        lanes = tuple(self.normalize(x) for x in lanes)
+        assert len(lanes) == self.N
+        self.lanes = lanes
+
+    def __repr__(self) -> str:
+        return f'{self.__class__.__name__}{self.lanes}'
+
+    @staticmethod
+    def normalize(x: Any) -> Any:
+        raise NotImplementedError
+
+    def spy_unwrap(self, vm: 'SPyVM') -> tuple[Any, ...]:
+        return self.lanes
+
+    def getitem(self, vm: 'SPyVM', w_i: W_I32) -> W_Object:
+        i = vm.unwrap_i32(w_i)
+        if i < 0 or i >= self.N:
+            raise SPyPanicError('vector index out of bounds')
+        return vm.wrap(self.lanes[i])
+
+
+@spytype('f64x2')
+class W_F64x2(W_Vector):
+    N = 2
+
+    @staticmethod
+    def normalize(x: Any) -> Any:
+        return float(x)
+
+    @staticmethod
+    def op_GETITEM(vm: 'SPyVM', w_type: W_Type, w_itype: W_Type) -> W_Dynamic:
+        from spy.vm.modules.operator import OP
+        return OP.w_f64x2_getitem
+
+
+@spytype('f32x4')
+class W_F32x4(W_Vector):
+    N = 4
+
+    @staticmethod
+    def normalize(x: Any) -> Any:
+        return round_f32(float(x))
+
+    @staticmethod
+    def op_GETITEM(vm: 'SPyVM', w_type: W_Type, w_itype: W_Type) -> W_Dynamic:
+        from spy.vm.modules.operator import OP
+        return OP.w_f32x4_getitem
+
+
+@spytype('i32x4')
+class W_I32x4(W_Vector):
+    N = 4
+
+    @staticmethod
+    def normalize(x: Any) -> Any:
+        return wrap_i32(int(x))
+
+    @staticmethod
+    def op_GETITEM(vm: 'SPyVM', w_type: W_Type, w_itype: W_Type) -> W_Dynamic:
+        from spy.vm.modules.operator import OP
+        return OP.w_i32x4_getitem
@@ -1,4 +1,5 @@
-from typing import TYPE_CHECKING, Any
+from typing import TYPE_CHECKING, Any, Optional
+import struct
 from spy.llwasm import LLWasmInstance
 from spy.fqn import QN
 from spy.vm.object import W_Object, W_Type, W_Dynamic, spytype, W_I32
@@ -6,6 +7,9 @@ from spy.vm.sig import spy_builtin
 if TYPE_CHECKING:
     from spy.vm.vm import SPyVM
 
+# see spy/libspy/include/spy/str.h
+SPY_STR_VALID_UTF8 = 1
+
 def ll_spy_Str_new(ll: LLWasmInstance, s: str) -> int:
     """
     Create a new spy_Str object inside the given LLWasmInstance, and fill it
@@ -13,12 +17,25 @@ def ll_spy_Str_new(ll: LLWasmInstance, s: str) -> int:
 
     Return the corresponding 'spy_Str *'
     """
+    # str.encode() raises on lone surrogates, so the result is always valid
+    # utf-8 and we can set the flag without calling spy_str_from_utf8
     utf8 = s.encode('utf-8')
     length = len(utf8)
     ptr = ll.call('spy_str_alloc', length)
-    ll.mem.write(ptr+4, utf8)
+    ll.mem.write(ll_spy_Str_utf8(ll, ptr), utf8)
+    ll.mem.write(ptr+12, struct.pack('<i', SPY_STR_VALID_UTF8))
     return ptr
 
+def ll_spy_Str_utf8(ll: LLWasmInstance, ptr: int) -> int:
+    """
+    Return the address of the utf8 data of the given 'spy_Str *'
+    """
+    return ll.mem.read_i32(ptr+4)
+
+# the methods of str: `s.find(x)` calls OP.w_str_find, etc. The opimpls are
+# in operator/opimpl_str.py. join is special, see W_Str.op_CALL_METHOD
+STR_METHODS = ('find', 'count', 'startswith', 'endswith', 'split')
+
 @spytype('str')
 class W_Str(W_Object):
     """
@@ -26,10 +43,20 @@ class W_Str(W_Object):
 
     This is basically a 'spy_Str *', i.e. a pointer to a C struct which
     resides in the linear memory of the VM:
-        typedef struct {
+        typedef struct spy_Str {
             size_t length;
-            const char utf8[];
+            const char *utf8;
+            const struct spy_Str *parent;
+            uint32_t flags;
+            uint64_t hash;
         } spy_Str;
+
+    The utf8 data is usually stored right after the header, but slices might
+    be views into the data of their parent, see spy_str_slice. The flags
+    tell whether the data is known to be valid utf-8 and whether the hash
+    has been computed.
+
+    W_Str compares and hashes by value, with the same hash as `hash(s)`.
     """
     vm: 'SPyVM'
     ptr: int
@@ -51,7 +78,8 @@ class W_Str(W_Object):
 
     def get_utf8(self) -> bytes:
         length = self.get_length()
-        ba = self.vm.ll.mem.read(self.ptr+4, length)
+        addr = ll_spy_Str_utf8(self.vm.ll, self.ptr)
+        ba = self.vm.ll.mem.read(addr, length)
         return bytes(ba)
 
     def _as_str(self) -> str:
@@ -61,9 +89,39 @@ class W_Str(W_Object):
         s = self._as_str()
         return f'W_Str({s!r})'
 
+    def __eq__(self, other: object) -> bool:
+        if not isinstance(other, W_Str):
+            return NotImplemented
+        return self.get_utf8() == other.get_utf8()
+
+    def __hash__(self) -> int:
+        return self.vm.ll.call('spy_str_hash', self.ptr)
+
     def spy_unwrap(self, vm: 'SPyVM') -> str:
         return self._as_str()
 
+    @staticmethod
+    def op_CALL_METHOD(vm: 'SPyVM', w_type: W_Type, w_attr: 'W_Str',
+                       w_argtypes: W_Dynamic) -> W_Dynamic:
+        from spy.vm.b import B
+        from spy.vm.modules.operator import OP
+        from spy.vm.list import W_BaseList
+        attr = vm.unwrap_str(w_attr)
+        if attr in STR_METHODS:
+            return getattr(OP, f'w_str_{attr}')
+        elif attr == 'join':
+            # we can join the result of split() and list[str]
+            argtypes_w = w_argtypes.items_w  # type: ignore
+            if len(argtypes_w) != 1:
+                return B.w_NotImplemented
+            w_itemstype = argtypes_w[0]
+            if w_itemstype is W_StrSplit._w:
+                return OP.w_str_join_split
+            pyclass = w_itemstype.pyclass
+            if issubclass(pyclass, W_BaseList) and pyclass.w_T is B.w_str:
+                return OP.w_str_join
+        return B.w_NotImplemented
+
     @staticmethod
     def op_GETITEM(vm: 'SPyVM', w_type: W_Type, w_vtype: W_Type) -> W_Dynamic:
         @spy_builtin(QN('operator::str_getitem'))
@@ -73,3 +131,62 @@ class W_Str(W_Object):
             ptr_c = vm.ll.call('spy_str_getitem', w_s.ptr, w_i.value)
             return W_Str.from_ptr(vm, ptr_c)
         return vm.wrap(str_getitem)
+
+    @staticmethod
+    def op_GETSLICE(vm: 'SPyVM', w_type: W_Type, w_starttype: W_Type,
+                    w_stoptype: W_Type) -> W_Dynamic:
+        from spy.vm.modules.operator import OP
+        return OP.w_str_slice
+
+
+@spytype('StrSplit')
+class W_StrSplit(W_Object):
+    """
+    The result of s.split(sep): a sequence of strings which supports
+    indexing and the length() method, see spy_StrSplit in libspy.
+
+    Like in C, the pieces are found only the first time that they are
+    needed, and each item is a slice of the original string.
+    """
+    w_s: W_Str
+    w_sep: W_Str
+    starts: Optional[list[int]]
+
+    def __init__(self, w_s: W_Str, w_sep: W_Str) -> None:
+        self.w_s = w_s
+        self.w_sep = w_sep
+        self.starts = None
+
+    def get_bounds(self) -> list[tuple[int, int]]:
+        """
+        Return the (start, stop) offsets of each piece
+        """
+        s = self.w_s.get_utf8()
+        sep = self.w_sep.get_utf8()
+        if self.starts is None:
+            starts = [0]
+            i = s.find(sep)
+            while i >= 0:
+                starts.append(i + len(sep))
+                i = s.find(sep, i + len(sep))
+            self.starts = starts
+        stops = [i - len(sep) for i in self.starts[1:]] + [len(s)]
+        return list(zip(self.starts, stops))
+
+    def spy_unwrap(self, vm: 'SPyVM') -> list[str]:
+        s = self.w_s.get_utf8()
+        return [s[a:b].decode('utf-8') for a, b in self.get_bounds()]
+
+    @staticmethod
+    def op_CALL_METHOD(vm: 'SPyVM', w_type: W_Type, w_attr: 'W_Str',
+                       w_argtypes: W_Dynamic) -> W_Dynamic:
+        from spy.vm.b import B
+        from spy.vm.modules.operator import OP
+        if vm.unwrap_str(w_attr) == 'length':
+            return OP.w_StrSplit_length
+        return B.w_NotImplemented
+
+    @staticmethod
+    def op_GETITEM(vm: 'SPyVM', w_type: W_Type, w_itype: W_Type) -> W_Dynamic:
+        from spy.vm.modules.operator import OP
+        return OP.w_StrSplit_getitem
@@ -0,0 +1,141 @@
+"""
+Support for `spawn(f, *args)` and `join(task)`.
+
+spawn() starts a call to the red function f and returns a Task[T], where T
+is the return type of f. join() waits for the task to finish and returns its
+result. Each task must be joined exactly once: in C, join() frees the task.
+
+`spawn` and `join` are generic: they are builtin objects which implement
+op_CALL, and the opimpls are specialized on the type of `f` and of the
+task. The opimpls get a FQN as soon as they are created, so that the C
+backend can recognize them and lower them to the libspy scheduler, see
+spy/libspy/include/spy/task.h.
+
+The interpreter runs each task inline, as soon as it is spawned. This is a
+valid schedule and it keeps the tests deterministic.
+"""
+
+from typing import TYPE_CHECKING, Any
+from spy.fqn import QN
+from spy.vm.object import W_Object, spytype, W_Type, W_Dynamic
+from spy.vm.function import W_FuncType, W_BuiltinFunc, FuncParam
+from spy.libspy import SPyPanicError
+if TYPE_CHECKING:
+    from spy.vm.vm import SPyVM
+
+
+class W_BaseTask(W_Object):
+    w_T: W_Type  # the type of the result
+    w_result: W_Object
+    joined: bool
+
+    def __init__(self, w_result: W_Object) -> None:
+        self.w_result = w_result
+        self.joined = False
+
+
+# XXX this should be marked as '@interp_blue' and cached automatically by the
+# VM
+CACHE: dict[Any, Any] = {}
+
+def make_W_Task(vm: 'SPyVM', w_T: W_Type) -> W_Type:
+    key = (vm, 'Task', w_T)
+    if key in CACHE:
+        return CACHE[key]
+
+    @spytype(f'Task[{w_T.name}]')
+    class W_Task(W_BaseTask):
+        pass
+
+    W_Task.w_T = w_T
+    W_Task.__name__ = f'W_Task[{w_T.name}]'
+    CACHE[key] = W_Task
+    return W_Task  # type: ignore
+
+
+def _make_opimpl(vm: 'SPyVM', key: Any, qn: QN, w_functype: W_FuncType,
+                 pyfunc: Any) -> W_BuiltinFunc:
+    with vm.lock:
+        if key in CACHE:
+            return CACHE[key]
+        w_opimpl = W_BuiltinFunc(w_functype, qn, pyfunc)
+        fqn = vm.get_FQN(qn, is_global=False)
+        vm.add_global(fqn, None, w_opimpl)
+        CACHE[key] = w_opimpl
+        return w_opimpl
+
+
+@spytype('Spawn')
+class W_Spawn(W_Object):
+
+    @staticmethod
+    def op_CALL(vm: 'SPyVM', w_type: W_Type,
+                w_argtypes: W_Dynamic) -> W_Dynamic:
+        from spy.vm.b import B
+        argtypes_w = w_argtypes.items_w  # type: ignore
+        if len(argtypes_w) == 0:
+            return B.w_NotImplemented
+        w_functype = argtypes_w[0]
+        if not isinstance(w_functype, W_FuncType) or w_functype.color != 'red':
+            return B.w_NotImplemented
+        return make_spawn_impl(vm, w_functype)
+
+def make_spawn_impl(vm: 'SPyVM', w_functype: W_FuncType) -> W_BuiltinFunc:
+    """
+    Return the opimpl for spawn(f, *args), where f is of type w_functype:
+
+        def(spawn: Spawn, func: FUNCTYPE, PARAMS...) -> Task[RESTYPE]
+    """
+    w_tasktype = vm.wrap(make_W_Task(vm, w_functype.w_restype))
+    assert isinstance(w_tasktype, W_Type)
+    key = (vm, 'spawn',
+           tuple((p.name, p.w_type) for p in w_functype.params),
+           w_functype.w_restype)
+    params = [FuncParam('spawn', W_Spawn._w),
+              FuncParam('func', w_functype)] + w_functype.params
+    w_impltype = W_FuncType(params, w_tasktype)
+    T = w_tasktype.pyclass
+
+    def spawn(vm: 'SPyVM', w_spawn: W_Spawn, w_func: W_Object,
+              *args_w: W_Object) -> W_Object:
+        w_res = vm.call_function(w_func, list(args_w))  # type: ignore
+        return T(w_res)
+
+    return _make_opimpl(vm, key, QN('builtins::spawn'), w_impltype, spawn)
+
+
+@spytype('Join')
+class W_Join(W_Object):
+
+    @staticmethod
+    def op_CALL(vm: 'SPyVM', w_type: W_Type,
+                w_argtypes: W_Dynamic) -> W_Dynamic:
+        from spy.vm.b import B
+        argtypes_w = w_argtypes.items_w  # type: ignore
+        if len(argtypes_w) != 1:
+            return B.w_NotImplemented
+        w_tasktype = argtypes_w[0]
+        if not issubclass(w_tasktype.pyclass, W_BaseTask):
+            return B.w_NotImplemented
+        return make_join_impl(vm, w_tasktype)
+
+def make_join_impl(vm: 'SPyVM', w_tasktype: W_Type) -> W_BuiltinFunc:
+    """
+    Return the opimpl for join(task):
+
+        def(join: Join, task: Task[T]) -> T
+    """
+    w_T = w_tasktype.pyclass.w_T
+    key = (vm, 'join', w_tasktype)
+    params = [FuncParam('join', W_Join._w),
+              FuncParam('task', w_tasktype)]
+    w_impltype = W_FuncType(params, w_T)
+
+    def join(vm: 'SPyVM', w_join: W_Join, w_task: W_BaseTask) -> W_Object:
+        if w_task.joined:
+            raise SPyPanicError('task already joined')
+        w_task.joined = True
+        return w_task.w_result
+
+    return _make_opimpl(vm, key, QN('builtins::join'), w_impltype, join)
+
@@ -10,7 +10,8 @@ from spy.vm.list import make_W_List, W_List__W_Type
 from spy.vm.function import W_FuncType, W_ASTFunc, W_Func
 from spy.vm.b import B
 from spy.vm.modules.operator import OP
-from spy.vm.typeconverter import TypeConverter, DynamicCast, NumericConv
+from spy.vm.typeconverter import (TypeConverter, DynamicCast, NumericConv,
+                                  can_convert_numeric, literal_int_type)
 from spy.vm.modules.types import W_TypeDef
 from spy.util import magic_dispatch
 if TYPE_CHECKING:
@@ -42,6 +43,7 @@ class TypeChecker:
     expr_types: dict[ast.Expr, tuple[Color, W_Type]]
     expr_conv: dict[ast.Expr, TypeConverter]
     opimpl: dict[ast.Node, W_Func]
+    method_calls: set[ast.Call]  # see _check_expr_call_method
     locals_types_w: dict[str, W_Type]
 
 
@@ -52,6 +54,7 @@ class TypeChecker:
         self.expr_types = {}
         self.expr_conv = {}
         self.opimpl = {}
+        self.method_calls = set()
         self.locals_types_w = {}
         self.declare_arguments()
 
@@ -130,7 +133,7 @@ class TypeChecker:
             # implicit upcast
             self.expr_conv[expr] = DynamicCast(w_exp)
             return None
-        elif w_got is B.w_i32 and w_exp is B.w_f64:
+        elif can_convert_numeric(expr, w_got, w_exp):
             # numeric conversion
             self.expr_conv[expr] = NumericConv(w_type=w_exp, w_fromtype=w_got)
             return None
@@ -203,6 +206,34 @@ class TypeChecker:
     def check_stmt_While(self, while_node: ast.While) -> None:
         self.typecheck_bool(while_node.test)
 
+    def check_stmt_ParallelFor(self, parfor: ast.ParallelFor) -> None:
+        _, w_ntype = self.check_expr(parfor.n)
+        err = self.convert_type_maybe(parfor.n, w_ntype, B.w_i32)
+        if err:
+            err.add('note', 'the argument of `parallel_range` must be `i32`',
+                    parfor.n.loc)
+            raise err
+        name = parfor.target
+        if name not in self.locals_types_w:
+            self.declare_local(name, B.w_i32)
+        w_type = self.locals_types_w[name]
+        if w_type is not B.w_i32:
+            err = SPyTypeError('mismatched types')
+            err.add('error', f'expected `i32`, got `{w_type.name}`',
+                    parfor.target_loc)
+            err.add('note', 'loop variables are `i32`', parfor.n.loc)
+            raise err
+        for name in parfor.reductions:
+            w_type = self.locals_types_w.get(name)
+            if w_type is not None and w_type not in (B.w_i32, B.w_f64):
+                sym = self.funcdef.symtable.lookup(name)
+                err = SPyTypeError(
+                    f'cannot use `{name}` as a reduction variable')
+                err.add('error', f'this is `{w_type.name}`, but only `i32` '
+                        'and `f64` are supported', sym.loc)
+                err.add('note', 'reduction in this loop', parfor.target_loc)
+                raise err
+
     def check_stmt_Assign(self, assign: ast.Assign) -> None:
         name = assign.target
         sym = self.funcdef.symtable.lookup(name)
@@ -276,7 +307,9 @@ class TypeChecker:
         T = type(const.value)
         assert T in (int, float, bool, str, NoneType)
         if T is int:
-            return 'blue', B.w_i32
+            # literals which don't fit an i32 are i64, or u64 if they
+            # don't fit an i64 either
+            return 'blue', literal_int_type(const.value)
         elif T is float:
             return 'blue', B.w_f64
         elif T is bool:
@@ -314,6 +347,8 @@ class TypeChecker:
     check_expr_LtE = check_expr_BinOp
     check_expr_Gt = check_expr_BinOp
     check_expr_GtE = check_expr_BinOp
+    check_expr_In = check_expr_BinOp
+    check_expr_NotIn = check_expr_BinOp
 
     def check_expr_GetItem(self, expr: ast.GetItem) -> tuple[Color, W_Type]:
         return self.OP_dispatch(
@@ -324,6 +359,15 @@ class TypeChecker:
             errmsg = 'cannot do `{0}`[...]'
         )
 
+    def check_expr_GetSlice(self, expr: ast.GetSlice) -> tuple[Color, W_Type]:
+        return self.OP_dispatch(
+            OP.w_GETSLICE,
+            expr,
+            [expr.value, expr.start, expr.stop],
+            dispatch = 'single',
+            errmsg = 'cannot do `{0}`[...:...]'
+        )
+
     def check_expr_GetAttr(self, expr: ast.GetAttr) -> tuple[Color, W_Type]:
         color, w_vtype = self.check_expr(expr.value)
         w_attr = self.vm.wrap(expr.attr)
@@ -431,6 +475,10 @@ class TypeChecker:
             argnodes = args)
 
     def check_expr_Call(self, call: ast.Call) -> tuple[Color, W_Type]:
+        if isinstance(call.func, ast.GetAttr):
+            res = self._check_expr_call_method(call, call.func)
+            if res is not None:
+                return res
         color, w_otype = self.check_expr(call.func)
         if w_otype is B.w_dynamic:
             # XXX: how are we supposed to know the color of the result if we
@@ -487,6 +535,34 @@ class TypeChecker:
         # more.
         return w_opimpl.w_functype.color, w_opimpl.w_functype.w_restype
 
+    def _check_expr_call_method(self, call: ast.Call, expr: ast.GetAttr
+                                ) -> Optional[tuple[Color, W_Type]]:
+        """
+        Try to typecheck `obj.meth(*args)` as a method call, by using
+        op.CALL_METHOD. If it returns NotImplemented, we return None and the
+        caller treats it as a call to the result of `obj.meth`.
+
+        The opimpl receives `obj` as the first argument: the attribute is
+        resolved statically, and `obj.meth` is never evaluated on its own.
+        """
+        _, w_otype = self.check_expr(expr.value)
+        argtypes_w = [self.check_expr(arg)[1] for arg in call.args]
+        w_attr = self.vm.wrap(expr.attr)
+        w_argtypes = W_List__W_Type(argtypes_w) # type: ignore
+        w_opimpl = self.vm.call_function(OP.w_CALL_METHOD,
+                                         [w_otype, w_attr, w_argtypes])
+        if w_opimpl is B.w_NotImplemented:
+            return None
+        self.opimpl_typecheck(w_opimpl, call, [expr.value] + call.args,
+                              [w_otype] + argtypes_w,
+                              dispatch='single',
+                              errmsg="cannot call method '%s' of type `{0}`"
+                                     % expr.attr)
+        assert isinstance(w_opimpl, W_Func)
+        self.opimpl[call] = w_opimpl
+        self.method_calls.add(call)
+        return w_opimpl.w_functype.color, w_opimpl.w_functype.w_restype
+
     def call_typecheck(self,
                        w_functype: W_FuncType,
                        argtypes_w: Sequence[W_Type],
@@ -1,6 +1,10 @@
-from typing import TYPE_CHECKING
+from typing import TYPE_CHECKING, Any, Optional
 from dataclasses import dataclass
-from spy.vm.object import W_Object, W_Type
+import math
+from spy import ast
+from spy.vm.object import (W_Object, W_Type, W_I32, W_F64, W_F32,
+                           W_SizedInt)
+from spy.libspy import SPyPanicError
 from spy.vm.b import B
 if TYPE_CHECKING:
     from spy.vm.vm import SPyVM
@@ -35,15 +39,94 @@ class DynamicCast(TypeConverter):
 @dataclass
 class NumericConv(TypeConverter):
     """
-    Convert between numeric types.
-
-    At the moment, the only supported conversion is i32->f64, and it's
-    hard-coded
+    Convert between numeric types, see can_convert_numeric.
     """
     w_fromtype: W_Type
 
     def convert(self, vm: 'SPyVM', w_obj: W_Object) -> W_Object:
-        assert self.w_type is B.w_f64
-        assert self.w_fromtype is B.w_i32
-        val = vm.unwrap_i32(w_obj)
-        return vm.wrap(float(val))
+        return convert_numeric(vm, w_obj, self.w_type)
+
+
+def int_info(w_type: W_Type) -> Optional[tuple[int, bool]]:
+    """
+    Return (BITS, SIGNED) if w_type is an integer type, else None
+    """
+    if w_type is B.w_i32:
+        return 32, True
+    pyclass = w_type.pyclass
+    if issubclass(pyclass, W_SizedInt):
+        return pyclass.BITS, pyclass.SIGNED
+    return None
+
+# number of bits of the mantissa
+FLOAT_PRECISION = {
+    'f32': 24,
+    'f64': 53,
+}
+
+def literal_int_type(value: int) -> W_Type:
+    if -2**31 <= value < 2**31:
+        return B.w_i32
+    elif -2**63 <= value < 2**63:
+        return B.w_i64
+    return B.w_u64
+
+def can_convert_numeric(expr: ast.Expr, w_got: W_Type, w_exp: W_Type) -> bool:
+    """
+    Check whether the value of expr can be implicitly converted from w_got to
+    w_exp.
+
+    Implicit conversions are allowed only if they are lossless, e.g. u8->i32
+    or i32->f64, but not i32->u32. Literals are an exception: they can be
+    converted to any integer type in which they fit, and to any float type:
+    this is needed to write e.g. `x: u8 = 42` or `y: f32 = 1.5`.
+    """
+    if isinstance(expr, ast.Constant) and type(expr.value) in (int, float):
+        exp_int = int_info(w_exp)
+        if exp_int is not None and type(expr.value) is int:
+            bits, signed = exp_int
+            lo = -(1 << (bits - 1)) if signed else 0
+            hi = (1 << (bits - 1)) if signed else (1 << bits)
+            return lo <= expr.value < hi
+        if w_exp.name in FLOAT_PRECISION:
+            return True
+    return is_lossless_conversion(w_got, w_exp)
+
+def is_lossless_conversion(w_got: W_Type, w_exp: W_Type) -> bool:
+    got_int = int_info(w_got)
+    exp_int = int_info(w_exp)
+    exp_precision = FLOAT_PRECISION.get(w_exp.name)
+    if got_int is not None and exp_int is not None:
+        got_bits, got_signed = got_int
+        exp_bits, exp_signed = exp_int
+        if got_signed == exp_signed:
+            return exp_bits >= got_bits
+        return not got_signed and exp_bits > got_bits
+    elif got_int is not None and exp_precision is not None:
+        got_bits, got_signed = got_int
+        return got_bits - got_signed <= exp_precision
+    elif w_got is B.w_f32 and w_exp is B.w_f64:
+        return True
+    return False
+
+
+def convert_numeric(vm: 'SPyVM', w_obj: W_Object,
+                    w_type: W_Type) -> W_Object:
+    """
+    Convert w_obj to the numeric type w_type, with the same semantics as a
+    C cast: integers wrap around, floats are truncated toward zero when
+    converted to integers.
+    """
+    value: Any = vm.unwrap(w_obj)
+    pyclass = w_type.pyclass
+    if pyclass is W_F64 or pyclass is W_F32:
+        return pyclass(float(value))
+    if isinstance(value, float):
+        # in C, this is undefined behavior: we panic
+        if not math.isfinite(value):
+            raise SPyPanicError('cannot convert inf or nan to an integer')
+    value = int(value)
+    if pyclass is W_I32:
+        return W_I32((value + 2**31) % 2**32 - 2**31)
+    assert issubclass(pyclass, W_SizedInt)
+    return pyclass(value)
@@ -1,4 +1,5 @@
 import py
+import threading
 from typing import Any, Optional, Iterable
 import itertools
 from dataclasses import dataclass
@@ -20,6 +21,10 @@ from spy.vm.modules.builtins import BUILTINS
 from spy.vm.modules.operator import OPERATOR
 from spy.vm.modules.types import TYPES, W_TypeDef
 from spy.vm.modules.rawbuffer import RAW_BUFFER
+from spy.vm.modules.atomic import ATOMIC
+from spy.vm.modules.simd import SIMD
+from spy.vm.modules.math import MATH
+from spy.vm.modules.io import IO
 
 class SPyVM:
     """
@@ -27,7 +32,29 @@ class SPyVM:
 
     Each instance of the VM contains an instance of libspy.wasm: all the
     non-scalar objects (e.g. strings) are stored in the WASM linear memory.
+
+    Concurrency model: multiple threads can call red functions of the same VM
+    in parallel (this is useful on free-threaded builds of CPython):
+
+      - execution state is per-call: each call gets its own ASTFrame and
+        TypeChecker, so threads don't share them
+
+      - modules and globals are read-mostly, so reading them needs no lock.
+        All the operations which create new ones (import_(), get_FQN(),
+        add_global(), redshift()) are serialized by vm.lock
+
+      - blue calls are lazily specialized and memoized: a hit in the
+        bluecache is lock-free, but a miss computes the result while holding
+        vm.lock. This way each blue call runs exactly once, and all threads
+        see the same result (e.g. the same closure)
+
+      - ll.lock serializes all the accesses to libspy.wasm: these are usually
+        short. Host functions must never take vm.lock, to avoid deadlocks
+
+    The AST and the symtables are immutable, and shared with the other VMs
+    of the process (see irgen/cache.py).
     """
+    lock: threading.RLock
     ll: libspy.LLSPyInstance
     globals_types: dict[FQN, W_Type]
     globals_w: dict[FQN, W_Object]
@@ -37,6 +64,7 @@ class SPyVM:
     bluecache: BlueCache
 
     def __init__(self) -> None:
+        self.lock = threading.RLock()
         self.ll = libspy.LLSPyInstance(libspy.LLMOD)
         self.globals_types = {}
         self.globals_w = {}
@@ -48,19 +76,28 @@ class SPyVM:
         self.make_module(OPERATOR)   # operator::
         self.make_module(TYPES)      # types::
         self.make_module(RAW_BUFFER) # rawbuffer::
+        self.make_module(ATOMIC)     # atomic::
+        self.make_module(SIMD)       # simd::
+        self.make_module(MATH)       # math::
+        self.make_module(IO)         # io::
 
     def import_(self, modname: str) -> W_Module:
         from spy.irgen.irgen import make_w_mod_from_file
-        if modname in self.modules_w:
-            return self.modules_w[modname]
-        # XXX for now we assume that we find the module as a single file in
-        # the only vm.path entry. Eventually we will need a proper import
-        # mechanism and support for packages
-        assert self.path, 'vm.path not set'
-        file_spy = py.path.local(self.path[0]).join(f'{modname}.spy')
-        w_mod = make_w_mod_from_file(self, file_spy)
-        self.modules_w[modname] = w_mod
-        return w_mod
+        w_mod = self.modules_w.get(modname)
+        if w_mod is not None:
+            return w_mod
+        with self.lock:
+            if modname in self.modules_w:
+                # another thread imported it in the meantime
+                return self.modules_w[modname]
+            # XXX for now we assume that we find the module as a single file
+            # in the only vm.path entry. Eventually we will need a proper
+            # import mechanism and support for packages
+            assert self.path, 'vm.path not set'
+            file_spy = py.path.local(self.path[0]).join(f'{modname}.spy')
+            w_mod = make_w_mod_from_file(self, file_spy)
+            self.modules_w[modname] = w_mod
+            return w_mod
 
     def redshift(self) -> None:
         """
@@ -75,11 +112,12 @@ class SPyVM:
                 if isinstance(w_func, W_ASTFunc) and should_redshift(w_func):
                     yield fqn, w_func
 
-        while True:
-            funcs = list(get_funcs())
-            if not funcs:
-                break
-            self._redshift_some(funcs)
+        with self.lock:
+            while True:
+                funcs = list(get_funcs())
+                if not funcs:
+                    break
+                self._redshift_some(funcs)
 
     def _redshift_some(self, funcs: list[tuple[FQN, W_ASTFunc]]) -> None:
         for fqn, w_func in funcs:
@@ -112,18 +150,20 @@ class SPyVM:
         For non globals (e.g., closures) the algorithm is simple: to compute
         an unique suffix, we just increment a numeric counter.
         """
-        if is_global:
-            fqn = FQN.make_global(modname=qn.modname, attr=qn.attr)
-        else:
-            # XXX this is potentially quadratic if we create tons of
-            # conflicting FQNs, but for now we don't care
-            for n in itertools.count():
-                fqn = FQN.make(modname=qn.modname, attr=qn.attr, suffix=str(n))
-                if fqn not in self.unique_fqns:
-                    break
-        assert fqn not in self.unique_fqns
-        self.unique_fqns.add(fqn)
-        return fqn
+        with self.lock:
+            if is_global:
+                fqn = FQN.make_global(modname=qn.modname, attr=qn.attr)
+            else:
+                # XXX this is potentially quadratic if we create tons of
+                # conflicting FQNs, but for now we don't care
+                for n in itertools.count():
+                    fqn = FQN.make(modname=qn.modname, attr=qn.attr,
+                                   suffix=str(n))
+                    if fqn not in self.unique_fqns:
+                        break
+            assert fqn not in self.unique_fqns
+            self.unique_fqns.add(fqn)
+            return fqn
 
     def add_global(self,
                    fqn: FQN,
@@ -131,15 +171,18 @@ class SPyVM:
                    w_value: W_Object
                    ) -> None:
         assert isinstance(fqn, FQN)
-        assert fqn.modname in self.modules_w
-        assert fqn not in self.globals_w
-        assert fqn not in self.globals_types
         if w_type is None:
             w_type = self.dynamic_type(w_value)
         else:
             assert self.isinstance(w_value, w_type)
-        self.globals_types[fqn] = w_type
-        self.globals_w[fqn] = w_value
+        with self.lock:
+            assert fqn.modname in self.modules_w
+            assert fqn not in self.globals_w
+            assert fqn not in self.globals_types
+            # globals_types must be set first: readers of globals_w expect
+            # to find the type
+            self.globals_types[fqn] = w_type
+            self.globals_w[fqn] = w_value
 
     def lookup_global_type(self, fqn: FQN) -> Optional[W_Type]:
         assert isinstance(fqn, FQN)
@@ -270,13 +313,18 @@ class SPyVM:
 
     def call_function(self, w_func: W_Func, args_w: list[W_Object]) -> W_Object:
         if w_func.color == 'blue':
-            # for blue functions, we memoize the result
+            # for blue functions, we memoize the result. See the docstring of
+            # SPyVM for the locking
             w_result = self.bluecache.lookup(w_func, args_w)
             if w_result is not None:
                 return w_result
-            w_result = self._call_func(w_func, args_w)
-            self.bluecache.record(w_func, args_w, w_result)
-            return w_result
+            with self.lock:
+                w_result = self.bluecache.lookup(w_func, args_w)
+                if w_result is not None:
+                    return w_result
+                w_result = self._call_func(w_func, args_w)
+                self.bluecache.record(w_func, args_w, w_result)
+                return w_result
         else:
             # for red functions, we just call them
             return self._call_func(w_func, args_w)